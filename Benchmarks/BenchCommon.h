@@ -0,0 +1,127 @@
+#pragma once
+
+// Shared helpers for the benchmark executables: allocation counting, timing and
+// one-record-per-line JSON/CSV output so results can be diffed between releases.
+//
+// Include from exactly one translation unit per executable: it replaces the
+// global allocation functions to count heap traffic.
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bench {
+
+inline std::atomic<std::uint64_t>& allocationCount() {
+    static std::atomic<std::uint64_t> count{0};
+    return count;
+}
+
+inline std::atomic<std::uint64_t>& allocatedBytes() {
+    static std::atomic<std::uint64_t> bytes{0};
+    return bytes;
+}
+
+struct AllocationSnapshot {
+    std::uint64_t count = 0;
+    std::uint64_t bytes = 0;
+
+    static AllocationSnapshot now() {
+        return AllocationSnapshot{allocationCount().load(std::memory_order_relaxed),
+                                  allocatedBytes().load(std::memory_order_relaxed)};
+    }
+};
+
+class Stopwatch {
+public:
+    Stopwatch() : start(std::chrono::steady_clock::now()) {}
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// One result row: ordered key/value pairs, numbers unquoted
+class Record {
+public:
+    Record& add(const std::string& key, const std::string& value) {
+        fields.emplace_back(key, "\"" + value + "\"");
+        return *this;
+    }
+
+    Record& add(const std::string& key, double value) {
+        if (std::isnan(value)) {
+            fields.emplace_back(key, "null");  // Metric doesn't apply to this row
+            return *this;
+        }
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+        fields.emplace_back(key, buffer);
+        return *this;
+    }
+
+    Record& add(const std::string& key, std::uint64_t value) {
+        fields.emplace_back(key, std::to_string(value));
+        return *this;
+    }
+
+    void printJson(std::FILE* out) const {
+        std::fputc('{', out);
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            std::fprintf(out, "%s\"%s\":%s", i > 0 ? "," : "", fields[i].first.c_str(), fields[i].second.c_str());
+        }
+        std::fputs("}\n", out);
+    }
+
+    void printCsvHeader(std::FILE* out) const {
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            std::fprintf(out, "%s%s", i > 0 ? "," : "", fields[i].first.c_str());
+        }
+        std::fputc('\n', out);
+    }
+
+    void printCsv(std::FILE* out) const {
+        for (std::size_t i = 0; i < fields.size(); ++i) {
+            std::string value = fields[i].second;
+            if (!value.empty() && value.front() == '"') {
+                value = value.substr(1, value.size() - 2);
+            } else if (value == "null") {
+                value.clear();
+            }
+            std::fprintf(out, "%s%s", i > 0 ? "," : "", value.c_str());
+        }
+        std::fputc('\n', out);
+    }
+
+private:
+    std::vector<std::pair<std::string, std::string>> fields;
+};
+
+}  // namespace bench
+
+void* operator new(std::size_t size) {
+    bench::allocationCount().fetch_add(1, std::memory_order_relaxed);
+    bench::allocatedBytes().fetch_add(size, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,211 @@
+// Combat benchmark: two armies interleaved in bands across a field, every unit
+// attacking whatever is in range. CombatSystem is timed finding targets by
+// scanning every entity and through the spatial index, then with every unit
+// firing slow projectiles (half of them explosive) so thousands are in flight,
+// then with a field of turrets that look only in the grid cells they cover.
+// Prints one record per (mode, units) with the step time, the attacks made and
+// a checksum of the damage dealt, which matches between the scan and indexed
+// modes when both pick the same targets.
+//
+//   combat_bench [--format json|csv] [--frames N] [--seed N] [--quick]
+
+#include "BenchCommon.h"
+#include "ECS/ComponentRegistry.h"
+#include "Systems/CombatSystem.h"
+#include "Systems/PhysicsSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const float STEP = 1.0f / 30.0f;
+const float UNIT_RADIUS = 16.0f;
+const float AREA_PER_UNIT = 48.0f * 48.0f;  // World grows with the armies
+const float BAND_WIDTH = 160.0f;             // Factions alternate every band
+const float ATTACK_RANGE = 120.0f;
+const float UNIT_HEALTH = 1e6f;  // Nobody dies, so every frame does the same work
+const float SHOT_SPEED = 120.0f;  // Slow enough for about a second of flight
+const float SPLASH_RADIUS = 40.0f;
+const float TURRET_SPACING = 200.0f;  // One turret per square this wide
+const float TURRET_RANGE = 150.0f;
+const float TURRET_RADIUS = 24.0f;
+
+enum class Mode { Scan, Indexed, Projectiles, Turrets };
+
+struct Options {
+    std::string format = "json";
+    int frames = 90;
+    unsigned int seed = 1;
+    bool quick = false;
+};
+
+struct Battle {
+    ComponentRegistry registry;
+    std::shared_ptr<PhysicsSystem> physics;
+    std::shared_ptr<CombatSystem> combat;
+    std::vector<std::shared_ptr<Entity>> units;
+};
+
+void makeBattle(Battle& battle, std::size_t unitCount, unsigned int seed, Mode mode) {
+    std::mt19937 rng(seed);
+    const float worldSize = std::sqrt(unitCount * AREA_PER_UNIT);
+    std::uniform_real_distribution<float> coordinate(0.0f, worldSize);
+    std::uniform_real_distribution<float> cooldown(0.0f, 1.0f);
+
+    battle.physics = battle.registry.registerSystem<PhysicsSystem>();
+    battle.combat = battle.registry.registerSystem<CombatSystem>();
+    for (std::size_t i = 0; i < unitCount; ++i) {
+        Vector2 position(coordinate(rng), coordinate(rng));
+        Faction faction = static_cast<int>(position.x / BAND_WIDTH) % 2 ? Faction::Enemy : Faction::Player;
+
+        auto entity = battle.registry.createEntity();
+        entity->addComponent(std::make_shared<TransformComponent>(position));
+        entity->addComponent(std::make_shared<ColliderComponent>(UNIT_RADIUS));
+        entity->addComponent(std::make_shared<PhysicsComponent>());
+        entity->addComponent(std::make_shared<HealthComponent>(UNIT_HEALTH));
+        entity->addComponent(std::make_shared<TeamComponent>(faction, false));
+        auto combat = std::make_shared<CombatComponent>();
+        combat->attackRange = ATTACK_RANGE;
+        combat->attackCooldownTimer = cooldown(rng);  // Attacks spread over the second
+        if (mode == Mode::Projectiles) {
+            combat->projectileSpeed = SHOT_SPEED;
+            if (i % 2) {
+                combat->damageType = DamageType::Explosive;
+                combat->splashRadius = SPLASH_RADIUS;
+            }
+        }
+        entity->addComponent(combat);
+        battle.registry.notifySystems(entity);
+        battle.units.push_back(entity);
+    }
+
+    if (mode != Mode::Turrets) {
+        return;
+    }
+    // Turrets don't move, so they have no PhysicsComponent
+    for (float y = TURRET_SPACING / 2; y < worldSize; y += TURRET_SPACING) {
+        for (float x = TURRET_SPACING / 2; x < worldSize; x += TURRET_SPACING) {
+            Faction faction = static_cast<int>(x / BAND_WIDTH) % 2 ? Faction::Enemy : Faction::Player;
+            auto turret = battle.registry.createEntity();
+            turret->addComponent(std::make_shared<TransformComponent>(Vector2(x, y)));
+            turret->addComponent(std::make_shared<ColliderComponent>(TURRET_RADIUS));
+            turret->addComponent(std::make_shared<HealthComponent>(UNIT_HEALTH));
+            turret->addComponent(std::make_shared<TeamComponent>(faction, false));
+            auto combat = std::make_shared<CombatComponent>();
+            combat->attackRange = TURRET_RANGE;
+            combat->attackCooldownTimer = cooldown(rng);
+            turret->addComponent(combat);
+            battle.registry.notifySystems(turret);
+        }
+    }
+}
+
+void report(const Options& options, const std::string& mode, std::size_t units, double seconds,
+            std::uint64_t attacks, double checksum, double inFlight, const bench::AllocationSnapshot& allocations) {
+    static bool headerPrinted = false;
+    const double frames = static_cast<double>(options.frames);
+
+    bench::Record record;
+    record.add("bench", "combat")
+          .add("mode", mode)
+          .add("units", static_cast<std::uint64_t>(units))
+          .add("frames", static_cast<std::uint64_t>(options.frames))
+          .add("step_ms_mean", seconds * 1000.0 / frames)
+          .add("attacks_per_step", attacks / frames)
+          .add("damage_checksum", checksum)
+          .add("projectiles_in_flight", inFlight)
+          .add("allocations_per_step", allocations.count / std::max(1.0, frames - 1.0));
+
+    if (options.format == "csv") {
+        if (!headerPrinted) {
+            record.printCsvHeader(stdout);
+            headerPrinted = true;
+        }
+        record.printCsv(stdout);
+    } else {
+        record.printJson(stdout);
+    }
+}
+
+void runBattle(const Options& options, std::size_t unitCount, Mode mode) {
+    Battle battle;
+    makeBattle(battle, unitCount, options.seed, mode);
+    if (mode != Mode::Scan) {
+        battle.combat->setSpatialIndex(battle.physics->getSpatialIndex());
+    }
+
+    double seconds = 0.0;
+    double inFlight = 0.0;
+    bench::AllocationSnapshot allocations;
+    for (int frame = 0; frame < options.frames; ++frame) {
+        battle.physics->update(STEP);
+
+        bench::AllocationSnapshot before = bench::AllocationSnapshot::now();
+        bench::Stopwatch stopwatch;
+        battle.combat->update(STEP);
+        seconds += stopwatch.seconds();
+        inFlight += battle.combat->getProjectiles().size();
+        if (frame > 0) {
+            // The first update builds the component cache
+            allocations.count += bench::AllocationSnapshot::now().count - before.count;
+        }
+    }
+
+    // Which unit took how much damage, weighted by position in the army; splash
+    // damage makes the attack count an estimate in projectile mode
+    std::uint64_t attacks = 0;
+    double checksum = 0.0;
+    for (std::size_t i = 0; i < battle.units.size(); ++i) {
+        double taken = UNIT_HEALTH - battle.units[i]->getComponent<HealthComponent>()->currentHealth;
+        attacks += static_cast<std::uint64_t>(std::lround(taken / CombatComponent().attackDamage));
+        checksum += taken * static_cast<double>(i % 97 + 1);
+    }
+    const char* names[] = {"scan", "indexed", "projectiles", "turrets"};
+    const char* name = names[static_cast<int>(mode)];
+    report(options, name, unitCount, seconds, attacks, checksum, inFlight / options.frames, allocations);
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--format" && hasValue) {
+            options.format = argv[++i];
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else {
+            std::cerr << "usage: combat_bench [--format json|csv] [--frames N] [--seed N] [--quick]" << std::endl;
+            return false;
+        }
+    }
+    return options.format == "json" || options.format == "csv";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<std::size_t> sizes = {1000, 5000};
+    if (!options.quick) {
+        sizes.push_back(10000);
+    }
+    for (std::size_t unitCount : sizes) {
+        runBattle(options, unitCount, Mode::Scan);
+        runBattle(options, unitCount, Mode::Indexed);
+        runBattle(options, unitCount, Mode::Projectiles);
+        runBattle(options, unitCount, Mode::Turrets);
+    }
+    return 0;
+}
@@ -0,0 +1,239 @@
+// Event bus benchmark: a frame's worth of CollisionEvents and DamageEvents is
+// published by one or more worker threads, then dispatched to a subscriber that
+// totals them. The same traffic also goes through a replica of the old bus,
+// which wrapped every event in a shared_ptr and called each subscriber as it
+// was published, and through subscribers filtered to damage to Player units and
+// collisions involving one entity. Prints one record per (mode, producers) with
+// events per second, how many events the subscribers were handed, allocations
+// per event and a checksum of what they saw.
+//
+//   event_bench [--format json|csv] [--frames N] [--events N] [--quick]
+
+#include "BenchCommon.h"
+#include "Systems/EventSystem.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct Options {
+    std::string format = "json";
+    int frames = 60;
+    std::size_t events = 100000;  // Per frame, split between collisions and damage
+    bool quick = false;
+};
+
+// What EventSystem was before the ring buffers, kept here as the baseline
+class CallbackBus {
+public:
+    struct Event {
+        virtual ~Event() = default;
+    };
+    template<typename T>
+    struct Boxed : Event {
+        explicit Boxed(const T& value) : value(value) {}
+        T value;
+    };
+    using Callback = std::function<void(const std::shared_ptr<Event>&)>;
+
+    template<typename T>
+    void subscribe(Callback callback) {
+        subscribers[std::type_index(typeid(T))].push_back(std::move(callback));
+    }
+
+    template<typename T>
+    void publish(const std::shared_ptr<Boxed<T>>& event) {
+        auto it = subscribers.find(std::type_index(typeid(T)));
+        if (it != subscribers.end()) {
+            for (auto& callback : it->second) {
+                callback(event);
+            }
+        }
+    }
+
+private:
+    std::unordered_map<std::type_index, std::vector<Callback>> subscribers;
+};
+
+const std::uint32_t WATCHED_ENTITY = 42;  // What the filtered collision subscriber follows
+
+struct Totals {
+    double damage = 0.0;
+    std::uint64_t collisions = 0;
+    std::uint64_t delivered = 0;
+
+    double checksum() const { return damage + static_cast<double>(collisions); }
+};
+
+// Event i of a frame; the same stream whatever publishes it
+CollisionEvent makeCollision(std::size_t i) {
+    return {static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(i + 1)};
+}
+
+DamageEvent makeDamage(std::size_t i) {
+    return {static_cast<std::uint32_t>(i), static_cast<float>(i % 7 + 1)};
+}
+
+// Units on alternate sides
+EventMask tagsFor(std::size_t i) {
+    return EventTags::UNIT | (i % 2 ? EventTags::ENEMY : EventTags::PLAYER);
+}
+
+void report(const Options& options, const std::string& mode, unsigned int producers, double seconds,
+            std::uint64_t events, std::uint64_t dropped, const Totals& totals,
+            const bench::AllocationSnapshot& allocations) {
+    static bool headerPrinted = false;
+
+    bench::Record record;
+    record.add("bench", "events")
+          .add("mode", mode)
+          .add("producers", static_cast<std::uint64_t>(producers))
+          .add("frames", static_cast<std::uint64_t>(options.frames))
+          .add("events", events)
+          .add("events_per_second", events / std::max(seconds, 1e-9))
+          .add("delivered", totals.delivered)
+          .add("dropped", dropped)
+          .add("checksum", totals.checksum())
+          .add("allocations_per_event", static_cast<double>(allocations.count) / std::max<std::uint64_t>(1, events));
+
+    if (options.format == "csv") {
+        if (!headerPrinted) {
+            record.printCsvHeader(stdout);
+            headerPrinted = true;
+        }
+        record.printCsv(stdout);
+    } else {
+        record.printJson(stdout);
+    }
+}
+
+void runCallbacks(const Options& options) {
+    CallbackBus bus;
+    Totals totals;
+    bus.subscribe<CollisionEvent>([&](const std::shared_ptr<CallbackBus::Event>&) {
+        ++totals.collisions;
+        ++totals.delivered;
+    });
+    bus.subscribe<DamageEvent>([&](const std::shared_ptr<CallbackBus::Event>& event) {
+        totals.damage += static_cast<CallbackBus::Boxed<DamageEvent>&>(*event).value.damage;
+        ++totals.delivered;
+    });
+
+    const std::size_t half = options.events / 2;
+    bench::AllocationSnapshot before = bench::AllocationSnapshot::now();
+    bench::Stopwatch stopwatch;
+    for (int frame = 0; frame < options.frames; ++frame) {
+        for (std::size_t i = 0; i < half; ++i) {
+            bus.publish(std::make_shared<CallbackBus::Boxed<CollisionEvent>>(makeCollision(i)));
+            bus.publish(std::make_shared<CallbackBus::Boxed<DamageEvent>>(makeDamage(i)));
+        }
+    }
+    double seconds = stopwatch.seconds();
+    bench::AllocationSnapshot allocations;
+    allocations.count = bench::AllocationSnapshot::now().count - before.count;
+
+    report(options, "callbacks", 1, seconds, half * 2 * options.frames, 0, totals, allocations);
+}
+
+void runRings(const Options& options, unsigned int producers, bool filtered) {
+    EventSystem bus;
+    Totals totals;
+    auto& collisions = bus.channel<CollisionEvent>(options.events);
+    auto& damage = bus.channel<DamageEvent>(options.events);
+    collisions.subscribe([&](const EventView<CollisionEvent>& events) {
+        totals.collisions += events.size();
+        totals.delivered += events.size();
+    }, filtered ? EventFilter::involving(WATCHED_ENTITY) : EventFilter());
+    damage.subscribe([&](const EventView<DamageEvent>& events) {
+        for (const DamageEvent& event : events) {
+            totals.damage += event.damage;
+        }
+        totals.delivered += events.size();
+    }, filtered ? EventFilter::tagged(EventTags::PLAYER) : EventFilter());
+
+    // Each worker publishes its share of the frame, one event at a time as a
+    // system would while walking its entities
+    const std::size_t half = options.events / 2;
+    auto publishShare = [&](unsigned int worker) {
+        std::size_t begin = half * worker / producers;
+        std::size_t end = half * (worker + 1) / producers;
+        for (std::size_t i = begin; i < end; ++i) {
+            collisions.publish(makeCollision(i), tagsFor(i) | tagsFor(i + 1));
+            damage.publish(makeDamage(i), tagsFor(i));
+        }
+    };
+
+    // The whole frame is timed, thread start-up included; it is small next to
+    // a frame's traffic
+    bench::AllocationSnapshot allocations;
+    double seconds = 0.0;
+    for (int frame = 0; frame < options.frames; ++frame) {
+        bench::AllocationSnapshot before = bench::AllocationSnapshot::now();
+        bench::Stopwatch stopwatch;
+        std::vector<std::thread> workers;
+        workers.reserve(producers - 1);
+        for (unsigned int worker = 1; worker < producers; ++worker) {
+            workers.emplace_back(publishShare, worker);
+        }
+        publishShare(0);
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        bus.dispatch();
+        seconds += stopwatch.seconds();
+        if (producers == 1) {
+            allocations.count += bench::AllocationSnapshot::now().count - before.count;
+        }
+    }
+
+    // Starting threads allocates, so allocations are only counted with one producer
+    std::uint64_t events = half * 2 * static_cast<std::uint64_t>(options.frames);
+    report(options, filtered ? "filtered" : "rings", producers, seconds, events,
+           collisions.getDropped() + damage.getDropped(), totals, allocations);
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--format" && hasValue) {
+            options.format = argv[++i];
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--events" && hasValue) {
+            options.events = std::max<std::size_t>(2, std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else {
+            std::cerr << "usage: event_bench [--format json|csv] [--frames N] [--events N] [--quick]" << std::endl;
+            return false;
+        }
+    }
+    return options.format == "json" || options.format == "csv";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+    if (options.quick) {
+        options.frames = std::min(options.frames, 10);
+    }
+
+    runCallbacks(options);
+    for (unsigned int producers : {1u, 2u, 4u}) {
+        runRings(options, producers, false);
+    }
+    runRings(options, 1, true);
+    return 0;
+}
@@ -0,0 +1,266 @@
+// Kernel benchmark: the per-body integration and seek math, run the old way
+// (one entity at a time through its components and Vector2 operators) and as
+// structure-of-arrays batches at every SIMD level this CPU supports. Batch
+// rows are timed both with the gather and write-back the systems do and on
+// the arrays alone. Prints one record per (kernel, mode, bodies) with the
+// time per body and the largest difference from the per-entity results.
+//
+//   kernel_bench [--format json|csv] [--frames N] [--seed N] [--quick]
+
+#include "BenchCommon.h"
+#include "ECS/Component.h"
+#include "Systems/BodyKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+const float STEP = 1.0f / 30.0f;
+
+struct Options {
+    std::string format = "json";
+    int frames = 200;
+    unsigned int seed = 1;
+    bool quick = false;
+};
+
+// Components of one body, allocated one by one as the game does
+struct Body {
+    std::shared_ptr<TransformComponent> transform;
+    std::shared_ptr<PhysicsComponent> physics;
+    std::shared_ptr<MovementComponent> movement;
+};
+
+std::vector<Body> makeBodies(std::size_t count, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> coordinate(0.0f, 4000.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    std::vector<Body> bodies(count);
+    for (Body& body : bodies) {
+        body.transform = std::make_shared<TransformComponent>(Vector2(coordinate(rng), coordinate(rng)));
+        body.physics = std::make_shared<PhysicsComponent>();
+        body.physics->velocity = Vector2(unit(rng), unit(rng)) * 80.0f;
+        body.physics->acceleration = Vector2(unit(rng), unit(rng)) * 20.0f;
+        body.movement = std::make_shared<MovementComponent>(60.0f + 40.0f * unit(rng));
+        body.movement->setTarget(Vector2(coordinate(rng), coordinate(rng)));
+    }
+    return bodies;
+}
+
+// PhysicsSystem's integration before the batch kernel
+void integrateEntity(TransformComponent& transform, PhysicsComponent& physics, float deltaTime) {
+    physics.velocity += physics.acceleration * deltaTime;
+    transform.position += physics.velocity * deltaTime;
+    physics.velocity *= std::exp(-physics.friction * deltaTime);
+}
+
+// MovementSystem's seek before the batch kernel
+Vector2 seekEntity(const TransformComponent& transform, const MovementComponent& movement, bool& arrived) {
+    Vector2 direction = movement.targetPosition - transform.position;
+    float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
+    arrived = distance <= movement.arrivalRadius;
+    if (arrived) {
+        return Vector2::zero();
+    }
+    direction.x /= distance;
+    direction.y /= distance;
+    return Vector2(direction.x * movement.moveSpeed, direction.y * movement.moveSpeed);
+}
+
+void report(const Options& options, const std::string& kernel, const std::string& mode, std::size_t bodies,
+            double seconds, int frames, double maxError) {
+    static bool headerPrinted = false;
+
+    bench::Record record;
+    record.add("bench", "kernels")
+          .add("kernel", kernel)
+          .add("mode", mode)
+          .add("bodies", static_cast<std::uint64_t>(bodies))
+          .add("frames", static_cast<std::uint64_t>(frames))
+          .add("ns_per_body", seconds * 1e9 / (static_cast<double>(frames) * bodies))
+          .add("max_error", maxError);
+
+    if (options.format == "csv") {
+        if (!headerPrinted) {
+            record.printCsvHeader(stdout);
+            headerPrinted = true;
+        }
+        record.printCsv(stdout);
+    } else {
+        record.printJson(stdout);
+    }
+}
+
+std::vector<SimdLevel> supportedLevels() {
+    std::vector<SimdLevel> levels = {SimdLevel::Scalar};
+    for (SimdLevel level : {SimdLevel::SSE2, SimdLevel::AVX2}) {
+        if (level <= getSupportedSimdLevel()) {
+            levels.push_back(level);
+        }
+    }
+    return levels;
+}
+
+void runIntegrate(const Options& options, std::size_t count) {
+    // Every run steps the same starting state; velocities are restored each
+    // frame so the bodies don't just coast to a stop
+    const std::vector<Body> reference = makeBodies(count, options.seed);
+    std::vector<Body> bodies = makeBodies(count, options.seed);
+
+    bench::Stopwatch entityWatch;
+    for (int frame = 0; frame < options.frames; ++frame) {
+        for (std::size_t i = 0; i < count; ++i) {
+            bodies[i].physics->velocity = reference[i].physics->velocity;
+            integrateEntity(*bodies[i].transform, *bodies[i].physics, STEP);
+        }
+    }
+    report(options, "integrate", "per_entity", count, entityWatch.seconds(), options.frames, 0.0);
+    std::vector<Vector2> expected(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        expected[i] = bodies[i].transform->position;
+    }
+
+    IntegrationBatch batch;
+    for (SimdLevel level : supportedLevels()) {
+        setSimdLevel(level);
+        bodies = makeBodies(count, options.seed);
+
+        // As PhysicsSystem runs it: gather, step, write back
+        bench::Stopwatch batchWatch;
+        for (int frame = 0; frame < options.frames; ++frame) {
+            batch.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                const PhysicsComponent& physics = *bodies[i].physics;
+                batch.set(i, bodies[i].transform->position, reference[i].physics->velocity, physics.acceleration,
+                          std::exp(-physics.friction * STEP));
+            }
+            batch.integrate(STEP);
+            for (std::size_t i = 0; i < count; ++i) {
+                bodies[i].transform->position = Vector2(batch.x[i], batch.y[i]);
+                bodies[i].physics->velocity = Vector2(batch.velocityX[i], batch.velocityY[i]);
+            }
+        }
+        double batchSeconds = batchWatch.seconds();
+
+        double maxError = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            maxError = std::max(maxError, static_cast<double>(bodies[i].transform->position.distance(expected[i])));
+        }
+        report(options, "integrate", std::string("batch_") + getSimdLevelName(level), count, batchSeconds,
+               options.frames, maxError);
+
+        // The kernel alone, on arrays already in place
+        std::vector<float> velocityX = batch.velocityX;
+        std::vector<float> velocityY = batch.velocityY;
+        bench::Stopwatch kernelWatch;
+        for (int frame = 0; frame < options.frames; ++frame) {
+            std::copy(velocityX.begin(), velocityX.end(), batch.velocityX.begin());
+            std::copy(velocityY.begin(), velocityY.end(), batch.velocityY.begin());
+            batch.integrate(STEP);
+        }
+        report(options, "integrate", std::string("kernel_") + getSimdLevelName(level), count,
+               kernelWatch.seconds(), options.frames, std::nan(""));
+    }
+    setSimdLevel(getSupportedSimdLevel());
+}
+
+void runSeek(const Options& options, std::size_t count) {
+    const std::vector<Body> bodies = makeBodies(count, options.seed);
+
+    std::vector<Vector2> expected(count);
+    std::vector<std::uint8_t> expectedArrived(count);
+    bench::Stopwatch entityWatch;
+    for (int frame = 0; frame < options.frames; ++frame) {
+        for (std::size_t i = 0; i < count; ++i) {
+            bool arrived = false;
+            expected[i] = seekEntity(*bodies[i].transform, *bodies[i].movement, arrived);
+            expectedArrived[i] = arrived ? 1 : 0;
+        }
+    }
+    report(options, "seek", "per_entity", count, entityWatch.seconds(), options.frames, 0.0);
+
+    SeekBatch batch;
+    for (SimdLevel level : supportedLevels()) {
+        setSimdLevel(level);
+
+        // As MovementSystem runs it: gather, solve, read back
+        std::vector<Vector2> velocities(count);
+        bench::Stopwatch batchWatch;
+        for (int frame = 0; frame < options.frames; ++frame) {
+            batch.resize(count);
+            for (std::size_t i = 0; i < count; ++i) {
+                const Body& body = bodies[i];
+                batch.set(i, body.transform->position, body.movement->targetPosition, body.movement->moveSpeed,
+                          body.movement->arrivalRadius);
+            }
+            batch.solve();
+            for (std::size_t i = 0; i < count; ++i) {
+                velocities[i] = Vector2(batch.velocityX[i], batch.velocityY[i]);
+            }
+        }
+        double batchSeconds = batchWatch.seconds();
+
+        double maxError = 0.0;
+        for (std::size_t i = 0; i < count; ++i) {
+            maxError = std::max(maxError, static_cast<double>(velocities[i].distance(expected[i])));
+            if (batch.arrived[i] != expectedArrived[i]) {
+                maxError = std::max(maxError, 1.0);
+            }
+        }
+        report(options, "seek", std::string("batch_") + getSimdLevelName(level), count, batchSeconds,
+               options.frames, maxError);
+
+        bench::Stopwatch kernelWatch;
+        for (int frame = 0; frame < options.frames; ++frame) {
+            batch.solve();
+        }
+        report(options, "seek", std::string("kernel_") + getSimdLevelName(level), count, kernelWatch.seconds(),
+               options.frames, std::nan(""));
+    }
+    setSimdLevel(getSupportedSimdLevel());
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--format" && hasValue) {
+            options.format = argv[++i];
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else {
+            std::cerr << "usage: kernel_bench [--format json|csv] [--frames N] [--seed N] [--quick]" << std::endl;
+            return false;
+        }
+    }
+    return options.format == "json" || options.format == "csv";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<std::size_t> sizes = {1000, 10000};
+    if (!options.quick) {
+        sizes.push_back(100000);
+    }
+    for (std::size_t count : sizes) {
+        runIntegrate(options, count);
+        runSeek(options, count);
+    }
+    return 0;
+}
@@ -0,0 +1,615 @@
+// Pathfinding benchmark: runs a fixed, seeded query set through every search
+// mode on a corpus of maps and prints one machine-readable record per
+// (map, mode) pair. The wave_* modes send the starts in groups to shared goals
+// to measure batched findPaths against one A* per unit.
+//
+//   pathfinding_bench [--format json|csv] [--queries N] [--seed N] [--quick] [--map file.txt]...
+//
+// ASCII maps: '#' obstacle, '.' open, '=' road, ',' rough, '~' mud.
+
+#include "BenchCommon.h"
+#include "Pathfinding/Pathfinder.h"
+#include "Pathfinding/DStarLite.h"
+#include "Pathfinding/PathSmoother.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const float CELL_SIZE = 32.0f;
+const float NO_PATH = std::numeric_limits<float>::infinity();
+const std::size_t WAVE_SIZE = 50;
+
+struct BenchMap {
+    std::string name;
+    int width = 0;
+    int height = 0;
+    std::vector<std::uint8_t> blocked;
+    std::vector<std::pair<GridRect, TerrainType>> terrain;
+
+    NavGrid buildGrid() const {
+        NavGrid grid(width, height, CELL_SIZE);
+        grid.assignBlocked(blocked);
+        for (const auto& [area, type] : terrain) {
+            grid.fillTerrain(area, type);
+        }
+        return grid;
+    }
+
+    void buildPathfinder(Pathfinder& pathfinder) const {
+        pathfinder.setObstacles(blocked);
+        for (const auto& [area, type] : terrain) {
+            pathfinder.setTerrain(Vector2(area.minX * CELL_SIZE, area.minY * CELL_SIZE),
+                                  Vector2(area.maxX * CELL_SIZE + 1.0f, area.maxY * CELL_SIZE + 1.0f), type);
+        }
+    }
+};
+
+struct Query {
+    int startCell = 0;
+    int goalCell = 0;
+    float optimalCost = 0.0f;
+};
+
+struct ModeResult {
+    std::uint64_t queries = 0;
+    double seconds = 0.0;
+    std::uint64_t nodesExpanded = 0;
+    double costRatioSum = 0.0;
+    double costRatioMax = 0.0;
+    std::uint64_t costSamples = 0;
+    double lengthRatioSum = 0.0;
+    std::uint64_t lengthSamples = 0;
+    std::uint64_t failures = 0;
+    std::uint64_t waypoints = 0;
+    bench::AllocationSnapshot allocations;
+    double cacheHitRate = std::numeric_limits<double>::quiet_NaN();
+
+    void addCost(float cost, float optimal) {
+        if (cost == NO_PATH) {
+            ++failures;
+            return;
+        }
+        double ratio = optimal > 0.0f ? cost / optimal : 1.0;
+        costRatioSum += ratio;
+        costRatioMax = std::max(costRatioMax, ratio);
+        ++costSamples;
+    }
+};
+
+struct Options {
+    std::string format = "json";
+    int queries = 200;
+    unsigned int seed = 1;
+    bool quick = false;
+    std::vector<std::string> mapFiles;
+};
+
+// Cell-graph reference cost (entering a cell costs its terrain), same model as A*
+float dijkstraCost(const NavGrid& grid, int startCell, int goalCell, MovementClass movementClass) {
+    const int width = grid.getWidth();
+    std::vector<float> cost(static_cast<std::size_t>(width) * grid.getHeight(), NO_PATH);
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+    cost[startCell] = 0.0f;
+    open.push({0.0f, startCell});
+
+    const int dx[] = {0, 1, 0, -1};
+    const int dy[] = {-1, 0, 1, 0};
+    while (!open.empty()) {
+        auto [current, cell] = open.top();
+        open.pop();
+        if (current > cost[cell]) continue;
+        if (cell == goalCell) return current;
+
+        for (int i = 0; i < 4; ++i) {
+            int x = cell % width + dx[i];
+            int y = cell / width + dy[i];
+            if (!grid.isInBounds(x, y)) continue;
+            int neighbor = y * width + x;
+            if (!grid.isPassable(neighbor, movementClass)) continue;
+            float next = current + grid.getStepCost(neighbor, movementClass);
+            if (next < cost[neighbor]) {
+                cost[neighbor] = next;
+                open.push({next, neighbor});
+            }
+        }
+    }
+    return NO_PATH;
+}
+
+Vector2 cellCenter(const NavGrid& grid, int cell) {
+    return grid.cellToWorld(cell % grid.getWidth(), cell / grid.getWidth());
+}
+
+float polylineLength(Vector2 start, const std::vector<Vector2>& waypoints) {
+    float length = 0.0f;
+    for (const auto& waypoint : waypoints) {
+        length += start.distance(waypoint);
+        start = waypoint;
+    }
+    return length;
+}
+
+// --- Map corpus ---------------------------------------------------------------
+
+BenchMap makeOpenMap(int size) {
+    BenchMap map;
+    map.name = "open";
+    map.width = map.height = size;
+    map.blocked.assign(static_cast<std::size_t>(size) * size, 0);
+    return map;
+}
+
+// Recursive backtracker on odd cells, then a few walls knocked out for loops
+BenchMap makeMazeMap(int size, unsigned int seed) {
+    size |= 1;
+    BenchMap map;
+    map.name = "maze";
+    map.width = map.height = size;
+    map.blocked.assign(static_cast<std::size_t>(size) * size, 1);
+
+    std::mt19937 rng(seed);
+    std::vector<int> stack = {1 * size + 1};
+    map.blocked[stack.back()] = 0;
+    const int dx[] = {0, 2, 0, -2};
+    const int dy[] = {-2, 0, 2, 0};
+    while (!stack.empty()) {
+        int cell = stack.back();
+        int x = cell % size, y = cell / size;
+        int options[4], count = 0;
+        for (int i = 0; i < 4; ++i) {
+            int nx = x + dx[i], ny = y + dy[i];
+            if (nx > 0 && ny > 0 && nx < size - 1 && ny < size - 1 && map.blocked[ny * size + nx]) {
+                options[count++] = i;
+            }
+        }
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int dir = options[rng() % count];
+        map.blocked[(y + dy[dir] / 2) * size + (x + dx[dir] / 2)] = 0;
+        map.blocked[(y + dy[dir]) * size + (x + dx[dir])] = 0;
+        stack.push_back((y + dy[dir]) * size + (x + dx[dir]));
+    }
+
+    for (int i = 0; i < size * size / 40; ++i) {
+        int x = 1 + static_cast<int>(rng() % (size - 2));
+        int y = 1 + static_cast<int>(rng() % (size - 2));
+        map.blocked[y * size + x] = 0;
+    }
+    return map;
+}
+
+// Square rooms with two-cell doors in every wall, roads along some corridors
+BenchMap makeRoomsMap(int size, int roomSize, unsigned int seed) {
+    BenchMap map;
+    map.name = "rooms";
+    map.width = map.height = size;
+    map.blocked.assign(static_cast<std::size_t>(size) * size, 0);
+
+    std::mt19937 rng(seed);
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            if (x % roomSize == 0 || y % roomSize == 0) {
+                map.blocked[y * size + x] = 1;
+            }
+        }
+    }
+    for (int room = 0; room < size; room += roomSize) {
+        for (int wall = roomSize; wall < size; wall += roomSize) {
+            int door = room + 1 + static_cast<int>(rng() % (roomSize - 2));
+            for (int d = door; d < std::min(door + 2, size); ++d) {
+                map.blocked[d * size + wall] = 0;  // Vertical wall
+                map.blocked[wall * size + d] = 0;  // Horizontal wall
+            }
+        }
+    }
+    for (int room = roomSize / 2; room < size; room += roomSize * 3) {
+        map.terrain.push_back({GridRect{1, room, size - 2, room}, TerrainType::Road});
+    }
+    return map;
+}
+
+// GameManager::setupLevel layout (1200x800 window, 32px cells) tiled scale x scale times
+BenchMap makeLevelMap(int scale) {
+    struct Blocker { float x, y, radius; };
+    const Blocker blockers[] = {
+        {130.0f, 120.0f, 32.0f}, {1060.0f, 680.0f, 32.0f},                           // Bases
+        {400.0f, 400.0f, 32.0f}, {800.0f, 300.0f, 32.0f}, {620.0f, 560.0f, 32.0f},  // Mines
+        {520.0f, 240.0f, 25.2f}, {560.0f, 280.0f, 25.2f}, {600.0f, 320.0f, 25.2f},  // Obstacles
+        {640.0f, 360.0f, 25.2f}, {700.0f, 500.0f, 25.2f}, {740.0f, 540.0f, 25.2f},
+        {980.0f, 720.0f, 32.0f}, {270.0f, 90.0f, 32.0f},                             // Turrets
+    };
+    const GridRect mud[] = {
+        {13, 3, 20, 6},    // Water at (420, 120) 250x100
+        {23, 14, 29, 17},  // Water at (760, 470) 180x90
+    };
+    const int tileWidth = 1200 / 32;
+    const int tileHeight = 800 / 32;
+
+    BenchMap map;
+    map.name = "level_x" + std::to_string(scale);
+    map.width = tileWidth * scale;
+    map.height = tileHeight * scale;
+    map.blocked.assign(static_cast<std::size_t>(map.width) * map.height, 0);
+
+    for (int tileY = 0; tileY < scale; ++tileY) {
+        for (int tileX = 0; tileX < scale; ++tileX) {
+            int offsetX = tileX * tileWidth;
+            int offsetY = tileY * tileHeight;
+            // Same rasterisation as Engine::rebuildPathGrid
+            for (const auto& blocker : blockers) {
+                int minX = std::max(0, static_cast<int>((blocker.x - blocker.radius) / CELL_SIZE));
+                int maxX = std::min(tileWidth - 1, static_cast<int>((blocker.x + blocker.radius) / CELL_SIZE));
+                int minY = std::max(0, static_cast<int>((blocker.y - blocker.radius) / CELL_SIZE));
+                int maxY = std::min(tileHeight - 1, static_cast<int>((blocker.y + blocker.radius) / CELL_SIZE));
+                for (int y = minY; y <= maxY; ++y) {
+                    for (int x = minX; x <= maxX; ++x) {
+                        map.blocked[(offsetY + y) * map.width + offsetX + x] = 1;
+                    }
+                }
+            }
+            for (const auto& area : mud) {
+                map.terrain.push_back({GridRect{area.minX + offsetX, area.minY + offsetY,
+                                                area.maxX + offsetX, area.maxY + offsetY},
+                                       TerrainType::Mud});
+            }
+        }
+    }
+    return map;
+}
+
+bool loadAsciiMap(const std::string& path, BenchMap& map) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::vector<std::string> lines;
+    for (std::string line; std::getline(file, line); ) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) lines.push_back(line);
+    }
+    if (lines.empty()) {
+        return false;
+    }
+
+    map.name = path.substr(path.find_last_of("/\\") + 1);
+    map.height = static_cast<int>(lines.size());
+    map.width = 0;
+    for (const auto& line : lines) {
+        map.width = std::max(map.width, static_cast<int>(line.size()));
+    }
+    map.blocked.assign(static_cast<std::size_t>(map.width) * map.height, 0);
+    for (int y = 0; y < map.height; ++y) {
+        for (int x = 0; x < static_cast<int>(lines[y].size()); ++x) {
+            char c = lines[y][x];
+            if (c == '#') {
+                map.blocked[y * map.width + x] = 1;
+            } else if (c == '=' || c == ',' || c == '~') {
+                TerrainType type = c == '=' ? TerrainType::Road : (c == ',' ? TerrainType::Rough : TerrainType::Mud);
+                map.terrain.push_back({GridRect{x, y, x, y}, type});
+            }
+        }
+    }
+    return true;
+}
+
+// Reachable Infantry start/goal pairs with their optimal cost, identical for every mode
+std::vector<Query> makeQueries(const NavGrid& grid, int count, unsigned int seed) {
+    std::vector<int> open;
+    const int cellCount = grid.getWidth() * grid.getHeight();
+    for (int cell = 0; cell < cellCount; ++cell) {
+        if (grid.isPassable(cell, MovementClass::Infantry)) open.push_back(cell);
+    }
+
+    std::vector<Query> queries;
+    if (open.size() < 2) {
+        return queries;
+    }
+
+    std::mt19937 rng(seed);
+    for (int attempts = 0; static_cast<int>(queries.size()) < count && attempts < count * 10; ++attempts) {
+        Query query;
+        query.startCell = open[rng() % open.size()];
+        query.goalCell = open[rng() % open.size()];
+        if (query.startCell == query.goalCell) continue;
+        query.optimalCost = dijkstraCost(grid, query.startCell, query.goalCell, MovementClass::Infantry);
+        if (query.optimalCost == NO_PATH) continue;
+        queries.push_back(query);
+    }
+    return queries;
+}
+
+// The same starts sent in waves of WAVE_SIZE units, each wave to one goal
+std::vector<Query> makeWaveQueries(const NavGrid& grid, const std::vector<Query>& queries) {
+    std::vector<Query> waves;
+    for (std::size_t first = 0; first < queries.size(); first += WAVE_SIZE) {
+        int goalCell = queries[first].goalCell;
+        for (std::size_t i = first; i < std::min(queries.size(), first + WAVE_SIZE); ++i) {
+            Query query{queries[i].startCell, goalCell, 0.0f};
+            query.optimalCost = dijkstraCost(grid, query.startCell, goalCell, MovementClass::Infantry);
+            if (query.optimalCost != NO_PATH) {
+                waves.push_back(query);
+            }
+        }
+    }
+    return waves;
+}
+
+// --- Search modes ---------------------------------------------------------------
+
+ModeResult runAStar(const NavGrid& grid, const std::vector<Query>& queries) {
+    ModeResult result;
+    bench::AllocationSnapshot before = bench::AllocationSnapshot::now();
+    bench::Stopwatch timer;
+    for (const auto& query : queries) {
+        SearchStats stats;
+        Vector2 start = cellCenter(grid, query.startCell);
+        auto path = Pathfinder::findPath(grid, start, cellCenter(grid, query.goalCell),
+                                         MovementClass::Infantry, &stats);
+        result.nodesExpanded += stats.nodesExpanded;
+        result.waypoints += path.size();
+        result.addCost(stats.found ? stats.pathCost : NO_PATH, query.optimalCost);
+        if (stats.found) {
+            result.lengthRatioSum += polylineLength(start, path) / (query.optimalCost * CELL_SIZE);
+            ++result.lengthSamples;
+        }
+    }
+    result.seconds = timer.seconds();
+    bench::AllocationSnapshot after = bench::AllocationSnapshot::now();
+    result.allocations = {after.count - before.count, after.bytes - before.bytes};
+    result.queries = queries.size();
+    return result;
+}
+
+// All queries in one findPaths call, into buffers allocated before the clock starts
+ModeResult runBatched(const NavGrid& grid, const std::vector<Query>& queries, std::size_t threadCount) {
+    std::vector<PathRequest> requests;
+    for (const auto& query : queries) {
+        requests.push_back({cellCenter(grid, query.startCell), cellCenter(grid, query.goalCell),
+                            MovementClass::Infantry});
+    }
+    std::vector<std::vector<Vector2>> results(queries.size());
+    std::vector<SearchStats> stats(queries.size());
+
+    ModeResult result;
+    bench::AllocationSnapshot before = bench::AllocationSnapshot::now();
+    bench::Stopwatch timer;
+    Pathfinder::findPaths(grid, requests.data(), requests.size(), results.data(), threadCount, stats.data());
+    result.seconds = timer.seconds();
+    bench::AllocationSnapshot after = bench::AllocationSnapshot::now();
+    result.allocations = {after.count - before.count, after.bytes - before.bytes};
+
+    for (std::size_t i = 0; i < queries.size(); ++i) {
+        result.nodesExpanded += stats[i].nodesExpanded;
+        result.waypoints += results[i].size();
+        result.addCost(stats[i].found ? stats[i].pathCost : NO_PATH, queries[i].optimalCost);
+        if (stats[i].found) {
+            result.lengthRatioSum +=
+                polylineLength(requests[i].start, results[i]) / (queries[i].optimalCost * CELL_SIZE);
+            ++result.lengthSamples;
+        }
+    }
+    result.queries = queries.size();
+    return result;
+}
+
+// Every query twice through the live Pathfinder; the second pass is served by the route cache
+ModeResult runAStarCached(const BenchMap& map, const std::vector<Query>& queries) {
+    Pathfinder pathfinder(map.width, map.height, CELL_SIZE);
+    map.buildPathfinder(pathfinder);
+    pathfinder.getPathCache().setCapacity(queries.size() + 1);
+    pathfinder.getPathCache().resetStats();
+    const NavGrid& grid = pathfinder.getGrid();
+
+    ModeResult result;
+    bench::AllocationSnapshot before = bench::AllocationSnapshot::now();
+    bench::Stopwatch timer;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const auto& query : queries) {
+            auto path = pathfinder.findPath(cellCenter(grid, query.startCell), cellCenter(grid, query.goalCell));
+            result.waypoints += path.size();
+        }
+    }
+    result.seconds = timer.seconds();
+    bench::AllocationSnapshot after = bench::AllocationSnapshot::now();
+    result.allocations = {after.count - before.count, after.bytes - before.bytes};
+    result.queries = queries.size() * 2;
+    result.cacheHitRate = pathfinder.getCacheStats().hitRate();
+    return result;
+}
+
+// Turn the planner's cell path into waypoints the way RouteRepairer does
+void addPlannerPath(const NavGrid& grid, const DStarLite& planner, std::vector<int>& cells, ModeResult& result) {
+    if (!planner.extractPath(grid, cells)) {
+        return;
+    }
+    PathSmoother::stringPull(grid, cells, MovementClass::Infantry);
+    result.waypoints += cells.size() > 1 ? cells.size() - 1 : 1;
+}
+
+ModeResult runDStarLite(const NavGrid& grid, const std::vector<Query>& queries) {
+    ModeResult result;
+    std::vector<int> cells;
+    bench::AllocationSnapshot before = bench::AllocationSnapshot::now();
+    bench::Stopwatch timer;
+    for (const auto& query : queries) {
+        DStarLite planner(query.goalCell, MovementClass::Infantry);
+        planner.initialize(grid, query.startCell);
+        result.nodesExpanded += planner.getExpandedCount();
+        result.addCost(planner.getPathCost(), query.optimalCost);
+        addPlannerPath(grid, planner, cells, result);
+    }
+    result.seconds = timer.seconds();
+    bench::AllocationSnapshot after = bench::AllocationSnapshot::now();
+    result.allocations = {after.count - before.count, after.bytes - before.bytes};
+    result.queries = queries.size();
+    return result;
+}
+
+// Plan, drop a 3x3 block on the middle of the route, then time only the repair
+ModeResult runDStarLiteRepair(const BenchMap& map, const std::vector<Query>& queries) {
+    NavGrid grid = map.buildGrid();
+    std::vector<std::uint8_t> edited;
+    std::vector<int> cells;
+    ModeResult result;
+
+    for (const auto& query : queries) {
+        DStarLite planner(query.goalCell, MovementClass::Infantry);
+        planner.initialize(grid, query.startCell);
+        if (!planner.extractPath(grid, cells) || cells.size() < 8) {
+            continue;
+        }
+
+        int middle = cells[cells.size() / 2];
+        edited = map.blocked;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int x = middle % map.width + dx, y = middle / map.width + dy;
+                int cell = y * map.width + x;
+                if (grid.isInBounds(x, y) && cell != query.startCell && cell != query.goalCell) {
+                    edited[cell] = 1;
+                }
+            }
+        }
+        grid.assignBlocked(edited);
+        GridRect region = grid.getLastChangedRegion();
+        float optimal = dijkstraCost(grid, query.startCell, query.goalCell, MovementClass::Infantry);
+
+        std::uint64_t expandedBefore = planner.getExpandedCount();
+        bench::AllocationSnapshot before = bench::AllocationSnapshot::now();
+        bench::Stopwatch timer;
+        planner.notifyChanged(grid, region);
+        bool reachable = planner.computeShortestPath(grid);
+        addPlannerPath(grid, planner, cells, result);
+        result.seconds += timer.seconds();
+        bench::AllocationSnapshot after = bench::AllocationSnapshot::now();
+        result.allocations.count += after.count - before.count;
+        result.allocations.bytes += after.bytes - before.bytes;
+
+        result.nodesExpanded += planner.getExpandedCount() - expandedBefore;
+        if (optimal != NO_PATH) {
+            result.addCost(planner.getPathCost(), optimal);
+        } else if (reachable) {
+            ++result.failures;  // The block cut the map but the planner still claims a route
+        }
+        ++result.queries;
+
+        grid.assignBlocked(map.blocked);
+    }
+    return result;
+}
+
+// --- Output ---------------------------------------------------------------------
+
+void report(const Options& options, const BenchMap& map, const std::string& mode, const ModeResult& result) {
+    static bool headerPrinted = false;
+    const double queries = static_cast<double>(std::max<std::uint64_t>(1, result.queries));
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    bench::Record record;
+    record.add("bench", "pathfinding")
+          .add("map", map.name)
+          .add("width", static_cast<std::uint64_t>(map.width))
+          .add("height", static_cast<std::uint64_t>(map.height))
+          .add("mode", mode)
+          .add("queries", result.queries)
+          .add("seconds", result.seconds)
+          .add("queries_per_sec", result.seconds > 0.0 ? result.queries / result.seconds : 0.0)
+          .add("nodes_expanded_per_query", result.nodesExpanded / queries)
+          .add("cost_ratio_mean", result.costSamples ? result.costRatioSum / result.costSamples : nan)
+          .add("cost_ratio_max", result.costSamples ? result.costRatioMax : nan)
+          .add("length_ratio_mean", result.lengthSamples ? result.lengthRatioSum / result.lengthSamples : nan)
+          .add("failures", result.failures)
+          .add("waypoints_per_query", result.waypoints / queries)
+          .add("allocations_per_query", result.allocations.count / queries)
+          .add("allocated_bytes_per_query", result.allocations.bytes / queries)
+          .add("cache_hit_rate", result.cacheHitRate);
+
+    if (options.format == "csv") {
+        if (!headerPrinted) {
+            record.printCsvHeader(stdout);
+            headerPrinted = true;
+        }
+        record.printCsv(stdout);
+    } else {
+        record.printJson(stdout);
+    }
+    std::fflush(stdout);
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--format" && hasValue) {
+            options.format = argv[++i];
+        } else if (arg == "--queries" && hasValue) {
+            options.queries = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--map" && hasValue) {
+            options.mapFiles.push_back(argv[++i]);
+        } else {
+            std::cerr << "usage: pathfinding_bench [--format json|csv] [--queries N] [--seed N] [--quick] "
+                         "[--map file.txt]..." << std::endl;
+            return false;
+        }
+    }
+    return options.format == "json" || options.format == "csv";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    const int size = options.quick ? 64 : 256;
+    std::vector<BenchMap> corpus;
+    corpus.push_back(makeOpenMap(size));
+    corpus.push_back(makeMazeMap(size - 1, options.seed));
+    corpus.push_back(makeRoomsMap(size, 16, options.seed));
+    corpus.push_back(makeLevelMap(options.quick ? 2 : 6));
+    for (const auto& path : options.mapFiles) {
+        BenchMap map;
+        if (!loadAsciiMap(path, map)) {
+            std::cerr << "could not load map " << path << std::endl;
+            return 1;
+        }
+        corpus.push_back(std::move(map));
+    }
+
+    for (std::size_t i = 0; i < corpus.size(); ++i) {
+        const BenchMap& map = corpus[i];
+        NavGrid grid = map.buildGrid();
+        std::vector<Query> queries = makeQueries(grid, options.queries, options.seed + static_cast<unsigned int>(i));
+
+        report(options, map, "astar", runAStar(grid, queries));
+        report(options, map, "astar_cached", runAStarCached(map, queries));
+        report(options, map, "dstar_lite", runDStarLite(grid, queries));
+        report(options, map, "dstar_lite_repair", runDStarLiteRepair(map, queries));
+
+        std::vector<Query> waves = makeWaveQueries(grid, queries);
+        report(options, map, "wave_astar", runAStar(grid, waves));
+        report(options, map, "wave_batched", runBatched(grid, waves, 1));
+        report(options, map, "wave_batched_mt", runBatched(grid, waves, std::thread::hardware_concurrency()));
+    }
+    return 0;
+}
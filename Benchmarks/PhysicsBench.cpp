@@ -0,0 +1,330 @@
+// Physics benchmark: crowds of units converging on rally points among static
+// blockers, stepped through PhysicsSystem, then an army crossing a wall through
+// one gap with and without ORCA avoidance. Prints one record per run with the
+// step time, the overlap left at the end and, for the crossing, how many units
+// arrived or gave up on their orders.
+//
+//   physics_bench [--format json|csv] [--frames N] [--seed N] [--quick]
+
+#include "BenchCommon.h"
+#include "ECS/ComponentRegistry.h"
+#include "Systems/MovementSystem.h"
+#include "Systems/PhysicsSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const float STEP = 1.0f / 60.0f;
+const float UNIT_RADIUS = 16.0f;
+const float BLOCKER_RADIUS = 20.0f;
+const float UNIT_SPEED = 80.0f;
+const float AREA_PER_UNIT = 64.0f * 64.0f;  // World grows with the crowd
+const int RALLY_POINTS = 8;
+const int UNITS_PER_BLOCKER = 50;
+const float CHOKE_WORLD_WIDTH = 2400.0f;
+const float CHOKE_WORLD_HEIGHT = 1600.0f;
+const float CHOKE_SECONDS = 150.0f;  // Long enough for the whole army to queue through
+const float GOAL_TOLERANCE = 48.0f;
+
+struct Options {
+    std::string format = "json";
+    int frames = 300;
+    unsigned int seed = 1;
+    bool quick = false;
+};
+
+struct Crowd {
+    ComponentRegistry registry;
+    std::shared_ptr<PhysicsSystem> physics;
+    std::vector<std::shared_ptr<Entity>> units;
+    std::vector<Vector2> rallyPoints;
+    std::vector<int> rallyOf;
+    std::size_t blockers = 0;
+    float worldSize = 0.0f;
+};
+
+std::shared_ptr<Entity> spawn(Crowd& crowd, Vector2 position, float radius, bool dynamic) {
+    auto entity = crowd.registry.createEntity();
+    entity->addComponent(std::make_shared<TransformComponent>(position));
+    entity->addComponent(std::make_shared<ColliderComponent>(radius));
+    if (dynamic) {
+        entity->addComponent(std::make_shared<PhysicsComponent>());
+    } else {
+        entity->addComponent(std::make_shared<RoleComponent>(EntityRole::Obstacle));
+    }
+    crowd.registry.notifySystems(entity);
+    return entity;
+}
+
+void makeCrowd(Crowd& crowd, std::size_t unitCount, unsigned int seed) {
+    std::mt19937 rng(seed);
+    crowd.physics = crowd.registry.registerSystem<PhysicsSystem>();
+    crowd.worldSize = std::sqrt(unitCount * AREA_PER_UNIT);
+    std::uniform_real_distribution<float> coordinate(0.0f, crowd.worldSize);
+
+    for (int i = 0; i < RALLY_POINTS; ++i) {
+        crowd.rallyPoints.emplace_back(coordinate(rng), coordinate(rng));
+    }
+    for (std::size_t i = 0; i < unitCount / UNITS_PER_BLOCKER; ++i) {
+        spawn(crowd, Vector2(coordinate(rng), coordinate(rng)), BLOCKER_RADIUS, false);
+        ++crowd.blockers;
+    }
+    for (std::size_t i = 0; i < unitCount; ++i) {
+        crowd.units.push_back(spawn(crowd, Vector2(coordinate(rng), coordinate(rng)), UNIT_RADIUS, true));
+        crowd.rallyOf.push_back(static_cast<int>(rng() % RALLY_POINTS));
+    }
+}
+
+// What MovementSystem does each frame: head for the target at full speed
+void steer(Crowd& crowd) {
+    for (std::size_t i = 0; i < crowd.units.size(); ++i) {
+        auto transform = crowd.units[i]->getComponent<TransformComponent>();
+        auto physics = crowd.units[i]->getComponent<PhysicsComponent>();
+        Vector2 toRally = crowd.rallyPoints[crowd.rallyOf[i]] - transform->position;
+        float distance = toRally.magnitude();
+        physics->velocity = distance > UNIT_RADIUS ? toRally * (UNIT_SPEED / distance) : Vector2::zero();
+    }
+}
+
+struct Overlap {
+    double unitMean = 0.0;
+    double unitMax = 0.0;
+    double blockerMax = 0.0;
+};
+
+// Overlap left between colliders at their current positions
+Overlap measureOverlap(Crowd& crowd) {
+    SpatialIndex index;
+    std::vector<bool> dynamic;
+    for (const auto& entity : crowd.physics->getEntities()) {
+        index.add(entity, entity->getComponent<TransformComponent>()->position,
+                  entity->getComponent<ColliderComponent>()->radius);
+        dynamic.push_back(entity->hasComponent<PhysicsComponent>());
+    }
+    index.build();
+
+    Overlap overlap;
+    std::uint64_t unitPairs = 0;
+    index.forEachOverlappingPair([&](std::size_t a, std::size_t b) {
+        double depth = index.getRadius(a) + index.getRadius(b) - index.getPosition(a).distance(index.getPosition(b));
+        int units = dynamic[index.getSourceIndex(a)] + dynamic[index.getSourceIndex(b)];
+        if (units == 2) {
+            overlap.unitMean += depth;
+            overlap.unitMax = std::max(overlap.unitMax, depth);
+            ++unitPairs;
+        } else if (units == 1) {
+            overlap.blockerMax = std::max(overlap.blockerMax, depth);
+        }
+    });
+    overlap.unitMean = unitPairs ? overlap.unitMean / unitPairs : 0.0;
+    return overlap;
+}
+
+struct RunResult {
+    std::string scenario;
+    std::string mode;
+    std::size_t units = 0;
+    std::size_t blockers = 0;
+    float worldSize = 0.0f;
+    int frames = 0;
+    double seconds = 0.0;
+    double worstStep = 0.0;
+    std::uint64_t contacts = 0;
+    Overlap overlap;
+    bench::AllocationSnapshot allocations;
+    double arrivedFraction = std::numeric_limits<double>::quiet_NaN();
+    double gaveUp = std::numeric_limits<double>::quiet_NaN();
+    double secondsTo90 = std::numeric_limits<double>::quiet_NaN();
+};
+
+void report(const Options& options, const RunResult& result) {
+    static bool headerPrinted = false;
+    const double frames = static_cast<double>(result.frames);
+
+    bench::Record record;
+    record.add("bench", "physics")
+          .add("scenario", result.scenario)
+          .add("mode", result.mode)
+          .add("units", static_cast<std::uint64_t>(result.units))
+          .add("blockers", static_cast<std::uint64_t>(result.blockers))
+          .add("world_size", static_cast<double>(result.worldSize))
+          .add("frames", static_cast<std::uint64_t>(result.frames))
+          .add("step_ms_mean", result.seconds * 1000.0 / frames)
+          .add("step_ms_max", result.worstStep * 1000.0)
+          .add("contacts_per_step", result.contacts / frames)
+          .add("unit_overlap_mean", result.overlap.unitMean)
+          .add("unit_overlap_max", result.overlap.unitMax)
+          .add("blocker_overlap_max", result.overlap.blockerMax)
+          .add("allocations_per_step", result.allocations.count / frames)
+          .add("arrived_fraction", result.arrivedFraction)
+          .add("gave_up", result.gaveUp)
+          .add("seconds_to_90_percent", result.secondsTo90);
+
+    if (options.format == "csv") {
+        if (!headerPrinted) {
+            record.printCsvHeader(stdout);
+            headerPrinted = true;
+        }
+        record.printCsv(stdout);
+    } else {
+        record.printJson(stdout);
+    }
+}
+
+void runCrowd(const Options& options, std::size_t unitCount) {
+    Crowd crowd;
+    makeCrowd(crowd, unitCount, options.seed);
+
+    RunResult result;
+    result.scenario = "crowd";
+    result.mode = "physics";
+    result.units = unitCount;
+    result.blockers = crowd.blockers;
+    result.worldSize = crowd.worldSize;
+    result.frames = options.frames;
+    bench::AllocationSnapshot before = bench::AllocationSnapshot::now();
+    for (int frame = 0; frame < options.frames; ++frame) {
+        steer(crowd);
+        bench::Stopwatch stopwatch;
+        crowd.physics->update(STEP);
+        double elapsed = stopwatch.seconds();
+        result.seconds += elapsed;
+        result.worstStep = std::max(result.worstStep, elapsed);
+        result.contacts += crowd.physics->getContacts().size();
+    }
+    bench::AllocationSnapshot after = bench::AllocationSnapshot::now();
+    result.allocations.count = after.count - before.count;
+    result.overlap = measureOverlap(crowd);
+    report(options, result);
+}
+
+// An army crossing a wall through one gap, steering with or without avoidance
+void runChokepoint(const Options& options, std::size_t unitCount, bool avoidance) {
+    Crowd crowd;
+    crowd.physics = crowd.registry.registerSystem<PhysicsSystem>();
+    auto movement = crowd.registry.registerSystem<MovementSystem>();
+    if (avoidance) {
+        movement->setSpatialIndex(crowd.physics->getSpatialIndex());
+        movement->setWorkerThreads(std::thread::hardware_concurrency());
+    }
+
+    // Wall of blockers down the middle with a gap four units wide
+    const float wallX = CHOKE_WORLD_WIDTH * 0.5f;
+    const float gapHalf = UNIT_RADIUS * 4.0f;
+    const float height = CHOKE_WORLD_HEIGHT;
+    for (float y = BLOCKER_RADIUS; y < height; y += BLOCKER_RADIUS * 1.6f) {
+        if (std::fabs(y - height * 0.5f) < gapHalf + BLOCKER_RADIUS) continue;
+        spawn(crowd, Vector2(wallX, y), BLOCKER_RADIUS, false);
+        ++crowd.blockers;
+    }
+
+    // Army packed on the left; each unit's goal is its mirror image on the right
+    std::mt19937 rng(options.seed);
+    std::uniform_real_distribution<float> spreadX(UNIT_RADIUS, wallX - 4.0f * UNIT_RADIUS);
+    std::uniform_real_distribution<float> spreadY(UNIT_RADIUS, height - UNIT_RADIUS);
+    std::vector<Vector2> goals;
+    for (std::size_t i = 0; i < unitCount; ++i) {
+        Vector2 start(spreadX(rng), spreadY(rng));
+        Vector2 goal(CHOKE_WORLD_WIDTH - start.x, start.y);
+        auto unit = spawn(crowd, start, UNIT_RADIUS, true);
+        auto move = std::make_shared<MovementComponent>(UNIT_SPEED);
+        auto path = std::make_shared<PathComponent>();
+        path->waypoints = {Vector2(wallX - gapHalf, height * 0.5f), Vector2(wallX + gapHalf, height * 0.5f), goal};
+        unit->addComponent(move);
+        unit->addComponent(path);
+        crowd.registry.notifySystems(unit);
+        crowd.units.push_back(unit);
+        goals.push_back(goal);
+    }
+
+    RunResult result;
+    result.scenario = "chokepoint";
+    result.mode = avoidance ? "orca" : "direct";
+    result.units = unitCount;
+    result.blockers = crowd.blockers;
+    result.worldSize = CHOKE_WORLD_WIDTH;
+    result.frames = static_cast<int>(CHOKE_SECONDS / STEP);
+
+    // A unit's outcome is settled the first time it drops its orders: at the goal
+    // it arrived, anywhere else it gave up and would have asked for a new path
+    enum class Outcome { Pending, Arrived, GaveUp };
+    std::vector<Outcome> outcomes(unitCount, Outcome::Pending);
+    std::size_t arrived = 0;
+    std::size_t gaveUp = 0;
+    bench::AllocationSnapshot before = bench::AllocationSnapshot::now();
+    for (int frame = 0; frame < result.frames; ++frame) {
+        bench::Stopwatch stopwatch;
+        // Physics then movement, with units that woke or slept moved in between
+        crowd.registry.update(STEP);
+        double elapsed = stopwatch.seconds();
+        result.seconds += elapsed;
+        result.worstStep = std::max(result.worstStep, elapsed);
+        result.contacts += crowd.physics->getContacts().size();
+
+        for (std::size_t i = 0; i < unitCount; ++i) {
+            if (outcomes[i] != Outcome::Pending || crowd.units[i]->getComponent<MovementComponent>()->hasTarget) continue;
+
+            bool atGoal = crowd.units[i]->getComponent<TransformComponent>()->position.distance(goals[i]) <= GOAL_TOLERANCE;
+            outcomes[i] = atGoal ? Outcome::Arrived : Outcome::GaveUp;
+            ++(atGoal ? arrived : gaveUp);
+        }
+        if (std::isnan(result.secondsTo90) && arrived * 10 >= unitCount * 9) {
+            result.secondsTo90 = (frame + 1) * STEP;
+        }
+    }
+    bench::AllocationSnapshot after = bench::AllocationSnapshot::now();
+    result.allocations.count = after.count - before.count;
+    result.overlap = measureOverlap(crowd);
+    result.arrivedFraction = static_cast<double>(arrived) / unitCount;
+    result.gaveUp = static_cast<double>(gaveUp);
+    report(options, result);
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--format" && hasValue) {
+            options.format = argv[++i];
+        } else if (arg == "--frames" && hasValue) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else {
+            std::cerr << "usage: physics_bench [--format json|csv] [--frames N] [--seed N] [--quick]" << std::endl;
+            return false;
+        }
+    }
+    return options.format == "json" || options.format == "csv";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    std::vector<std::size_t> crowdSizes = {1000, 5000};
+    if (!options.quick) {
+        crowdSizes.push_back(10000);
+    }
+    for (std::size_t unitCount : crowdSizes) {
+        runCrowd(options, unitCount);
+    }
+
+    std::size_t armySize = options.quick ? 200 : 400;
+    runChokepoint(options, armySize, false);
+    runChokepoint(options, armySize, true);
+    return 0;
+}
@@ -1,8 +1,14 @@
 #include "AISystem.h"
+#include "../Pathfinding/PathService.h"
+#include "../Systems/CombatSystem.h"
 #include <limits>
 #include <cstdint>
 
 namespace {
+// Inside enemy turret range units retreat at this multiple of their usual
+// health threshold, since the turret outlasts them
+const float TURRET_RETREAT_FACTOR = 2.0f;
+
 class NullState final : public State {
 public:
     explicit NullState(AIState type) : type(type) {}
@@ -52,6 +58,31 @@ void AISystem::setRequiredComponents() {
     require<TransformComponent>();
 }
 
+void AISystem::setPathService(std::shared_ptr<PathService> service) {
+    pathService = std::move(service);
+}
+
+void AISystem::setCombatSystem(std::shared_ptr<CombatSystem> combat) {
+    combatSystem = std::move(combat);
+}
+
+void AISystem::moveTo(const std::shared_ptr<Entity>& entity, Vector2 target) {
+    if (pathService) {
+        pathService->requestMove(entity, target);
+        return;
+    }
+
+    auto movement = entity->getComponent<MovementComponent>();
+    auto path = entity->getComponent<PathComponent>();
+    if (movement) {
+        movement->setTarget(target);
+    }
+    if (path) {
+        path->waypoints = {target};
+        path->currentIndex = 0;
+    }
+}
+
 void AISystem::updateBlackboards() {
     for (const auto& entity : entities) {
         if (!entity || !entity->isActive() || entity->isDestroyed()) {
@@ -74,6 +105,14 @@ void AISystem::updateBlackboards() {
             ai->blackboard.health = health->currentHealth;
             ai->blackboard.set("healthRatio", health->maxHealth > 0.0f ? health->currentHealth / health->maxHealth : 0.0f);
         }
+
+        // Enemy turrets in range of this spot, from the cells they cover
+        int turretThreats = 0;
+        if (combatSystem) {
+            combatSystem->findThreats(transform->position, team->faction, threats);
+            turretThreats = static_cast<int>(threats.size());
+        }
+        ai->blackboard.set("turretThreats", turretThreats);
         
         // Update sensory information
         updateSensory(entity);
@@ -107,7 +146,11 @@ void AISystem::updateAIDecisions() {
         std::string desiredAction = ai->blackboard.get<std::string>("desiredAction");
         if (desiredAction.empty()) {
             float healthRatio = ai->blackboard.get<float>("healthRatio");
-            if (healthRatio > 0.0f && healthRatio < aiConfig->retreatHealthThreshold && ai->blackboard.has("baseEntityId")) {
+            float retreatThreshold = aiConfig->retreatHealthThreshold;
+            if (ai->blackboard.get<int>("turretThreats") > 0) {
+                retreatThreshold *= TURRET_RETREAT_FACTOR;
+            }
+            if (healthRatio > 0.0f && healthRatio < retreatThreshold && ai->blackboard.has("baseEntityId")) {
                 desiredAction = "retreat";
             } else if (role->role == EntityRole::Worker) {
                 desiredAction = ai->blackboard.resourceSpotted ? "gather" : "patrol";
@@ -121,6 +164,7 @@ void AISystem::updateAIDecisions() {
             command->type = CommandType::Attack;
             command->targetEntityId = enemyId;
             command->targetPosition = ai->blackboard.enemyPosition;
+            // Chasing a moving target: steer at it directly rather than pathing every frame
             movement->setTarget(ai->blackboard.enemyPosition);
             if (path) {
                 path->waypoints = {ai->blackboard.enemyPosition};
@@ -134,11 +178,7 @@ void AISystem::updateAIDecisions() {
             if (ai->blackboard.has("resourcePosition")) {
                 Vector2 resourcePos = ai->blackboard.get<Vector2>("resourcePosition");
                 command->targetPosition = resourcePos;
-                movement->setTarget(resourcePos);
-                if (path) {
-                    path->waypoints = {resourcePos};
-                    path->currentIndex = 0;
-                }
+                moveTo(entity, resourcePos);
             }
             ai->stateMachine->changeState(AIState::Gather);
         } else if (desiredAction == "retreat") {
@@ -147,11 +187,7 @@ void AISystem::updateAIDecisions() {
             command->targetEntityId = baseId;
             if (ai->blackboard.has("basePosition")) {
                 Vector2 basePos = ai->blackboard.get<Vector2>("basePosition");
-                movement->setTarget(basePos);
-                if (path) {
-                    path->waypoints = {basePos};
-                    path->currentIndex = 0;
-                }
+                moveTo(entity, basePos);
             }
             ai->stateMachine->changeState(AIState::Flee);
         } else {
@@ -171,11 +207,7 @@ void AISystem::updateAIDecisions() {
                 command->type = CommandType::Defend;
                 command->targetPosition = target;
                 command->defendPosition = target;
-                movement->setTarget(target);
-                if (path) {
-                    path->waypoints = {target};
-                    path->currentIndex = 0;
-                }
+                moveTo(entity, target);
             }
 
             ai->stateMachine->changeState(AIState::Move);
@@ -200,9 +232,10 @@ void AISystem::updateSensory(std::shared_ptr<Entity> entity) {
     ai->blackboard.set("resourceEntityId", static_cast<std::uint32_t>(0));
     ai->blackboard.set("baseEntityId", static_cast<std::uint32_t>(0));
     
-    float bestEnemyDistance = aiConfig->engagementRange;
-    float bestResourceDistance = std::numeric_limits<float>::max();
-    float bestBaseDistance = std::numeric_limits<float>::max();
+    // Compared squared, so no candidate needs a square root
+    float bestEnemyDistanceSq = aiConfig->engagementRange * aiConfig->engagementRange;
+    float bestResourceDistanceSq = std::numeric_limits<float>::max();
+    float bestBaseDistanceSq = std::numeric_limits<float>::max();
 
     for (const auto& candidate : entities) {
         if (!candidate || candidate->getId() == entity->getId() || !candidate->isActive() || candidate->isDestroyed()) {
@@ -216,11 +249,11 @@ void AISystem::updateSensory(std::shared_ptr<Entity> entity) {
             continue;
         }
 
-        float distance = transform->position.distance(candidateTransform->position);
+        float distanceSq = transform->position.distanceSquared(candidateTransform->position);
 
         if (candidateTeam->faction != team->faction && candidateTeam->faction != Faction::Neutral) {
-            if (distance < bestEnemyDistance) {
-                bestEnemyDistance = distance;
+            if (distanceSq < bestEnemyDistanceSq) {
+                bestEnemyDistanceSq = distanceSq;
                 ai->blackboard.enemySpotted = true;
                 ai->blackboard.enemyPosition = candidateTransform->position;
                 ai->blackboard.set("enemyEntityId", candidate->getId());
@@ -229,8 +262,8 @@ void AISystem::updateSensory(std::shared_ptr<Entity> entity) {
 
         if (candidateRole->role == EntityRole::ResourceMine) {
             auto node = candidate->getComponent<ResourceNodeComponent>();
-            if (node && node->amountRemaining > 0.0f && distance < bestResourceDistance) {
-                bestResourceDistance = distance;
+            if (node && node->amountRemaining > 0.0f && distanceSq < bestResourceDistanceSq) {
+                bestResourceDistanceSq = distanceSq;
                 ai->blackboard.resourceSpotted = true;
                 ai->blackboard.set("resourceEntityId", candidate->getId());
                 ai->blackboard.set("resourcePosition", candidateTransform->position);
@@ -238,8 +271,8 @@ void AISystem::updateSensory(std::shared_ptr<Entity> entity) {
         }
 
         if (candidateRole->role == EntityRole::Base && candidateTeam->faction == team->faction) {
-            if (distance < bestBaseDistance) {
-                bestBaseDistance = distance;
+            if (distanceSq < bestBaseDistanceSq) {
+                bestBaseDistanceSq = distanceSq;
                 ai->blackboard.set("baseEntityId", candidate->getId());
                 ai->blackboard.set("basePosition", candidateTransform->position);
             }
@@ -16,15 +16,29 @@ struct AIComponent : public Component {
                     behaviorTree(std::make_shared<BehaviorTree>()) {}
 };
 
+class PathService;
+class CombatSystem;
+
 class AISystem : public System {
 public:
     void update(float deltaTime) override;
     void setRequiredComponents() override;
+
+    // Patrol, gather and retreat moves are routed through the path service when set
+    void setPathService(std::shared_ptr<PathService> service);
+
+    // Lets units see which enemy turrets cover them, and pull back sooner there
+    void setCombatSystem(std::shared_ptr<CombatSystem> combat);
     
     // Decision making
     void updateAIDecisions();
     void updateBlackboards();
 
 private:
+    std::shared_ptr<PathService> pathService;
+    std::shared_ptr<CombatSystem> combatSystem;
+    std::vector<std::shared_ptr<Entity>> threats;  // Scratch for turret lookups
+
+    void moveTo(const std::shared_ptr<Entity>& entity, Vector2 target);
     void updateSensory(std::shared_ptr<Entity> entity);  // Check what AI sees
 };
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// 2D grid stored as 32x32-cell chunks. Chunks that were never written share one
+// read-only chunk holding the fill value, so large empty regions cost a pointer
+// each. Copies share chunks and a chunk is duplicated only when one side writes
+// to it, which keeps snapshots of big grids cheap. Copy and write on one thread;
+// read-only copies may be handed to others.
+template <typename T>
+class ChunkedGrid {
+public:
+    static constexpr int CHUNK_SHIFT = 5;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+    static constexpr int CHUNK_CELLS = CHUNK_SIZE * CHUNK_SIZE;
+
+    ChunkedGrid() : ChunkedGrid(0, 0) {}
+
+    ChunkedGrid(int width, int height, const T& fill = T())
+        : width(width), height(height),
+          chunksX((width + CHUNK_SIZE - 1) >> CHUNK_SHIFT),
+          chunksY((height + CHUNK_SIZE - 1) >> CHUNK_SHIFT),
+          fillChunk(std::make_shared<Chunk>()) {
+        std::fill(std::begin(fillChunk->cells), std::end(fillChunk->cells), fill);
+        chunks.assign(static_cast<std::size_t>(chunksX) * chunksY, fillChunk);
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    int getChunksX() const { return chunksX; }
+    int getChunksY() const { return chunksY; }
+    const T& getFill() const { return fillChunk->cells[0]; }
+
+    bool isInBounds(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < height;
+    }
+
+    const T& get(int x, int y) const {
+        return chunks[chunkIndex(x, y)]->cells[localIndex(x, y)];
+    }
+
+    // Writable cell; allocates the chunk or unshares it from copies of the grid
+    T& at(int x, int y) {
+        std::shared_ptr<Chunk>& chunk = chunks[chunkIndex(x, y)];
+        if (chunk.use_count() > 1) {
+            chunk = std::make_shared<Chunk>(*chunk);
+        }
+        return chunk->cells[localIndex(x, y)];
+    }
+
+    bool isChunkAllocated(int chunkX, int chunkY) const {
+        return chunks[static_cast<std::size_t>(chunkY) * chunksX + chunkX] != fillChunk;
+    }
+
+    std::size_t getAllocatedChunkCount() const {
+        return static_cast<std::size_t>(
+            std::count_if(chunks.begin(), chunks.end(), [this](const auto& chunk) { return chunk != fillChunk; }));
+    }
+
+    // Every cell back to the fill value
+    void reset() {
+        std::fill(chunks.begin(), chunks.end(), fillChunk);
+    }
+
+private:
+    struct Chunk {
+        T cells[CHUNK_CELLS];
+    };
+
+    std::size_t chunkIndex(int x, int y) const {
+        return static_cast<std::size_t>(y >> CHUNK_SHIFT) * chunksX + (x >> CHUNK_SHIFT);
+    }
+
+    static int localIndex(int x, int y) {
+        return ((y & (CHUNK_SIZE - 1)) << CHUNK_SHIFT) | (x & (CHUNK_SIZE - 1));
+    }
+
+    int width;
+    int height;
+    int chunksX;
+    int chunksY;
+    std::shared_ptr<Chunk> fillChunk;
+    std::vector<std::shared_ptr<Chunk>> chunks;
+};
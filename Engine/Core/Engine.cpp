@@ -1,21 +1,51 @@
 #include "Engine.h"
+#include "WorldChecksum.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <thread>
+
+namespace {
+const float NAV_CELL_SIZE = 32.0f;
+const int MAX_WORLD_CELLS = 4096;
+const float CAMERA_PAN_SPEED = 900.0f;  // Pixels per second
+const float PICK_SLACK = 8.0f;  // Movement since the spatial index was built
+}  // namespace
+
+Engine::Engine(int windowWidth, int windowHeight, const std::string& title)
+    : Engine(windowWidth, windowHeight, title, static_cast<float>(windowWidth), static_cast<float>(windowHeight)) {}
+
+Engine::Engine(int windowWidth, int windowHeight, const std::string& title, float worldWidth, float worldHeight)
+    : Engine(EngineConfig{windowWidth, windowHeight, title, worldWidth, worldHeight, false}) {}
+
+Engine::Engine(const EngineConfig& config)
+    : deterministic(config.deterministic), tickLength(config.tickLength) {
+    float worldWidth = config.worldWidth > 0.0f ? config.worldWidth : static_cast<float>(config.windowWidth);
+    float worldHeight = config.worldHeight > 0.0f ? config.worldHeight : static_cast<float>(config.windowHeight);
+
+    if (!config.headless) {
+        window = std::make_unique<sf::RenderWindow>(
+            sf::VideoMode(config.windowWidth, config.windowHeight), config.title);
+        // The simulation steps at its own rate; rendering just follows the display
+        window->setVerticalSyncEnabled(true);
+        camera = window->getDefaultView();
+    }
 
-Engine::Engine(int windowWidth, int windowHeight, const std::string& title) {
-    // Create window
-    window = std::make_unique<sf::RenderWindow>(
-        sf::VideoMode(windowWidth, windowHeight), title);
-    window->setFramerateLimit(60);
+    // The nav grid covers the world, not the screen
+    int gridWidth = std::max(1, std::min(MAX_WORLD_CELLS, static_cast<int>(std::ceil(worldWidth / NAV_CELL_SIZE))));
+    int gridHeight = std::max(1, std::min(MAX_WORLD_CELLS, static_cast<int>(std::ceil(worldHeight / NAV_CELL_SIZE))));
+    worldSize = Vector2(std::min(worldWidth, gridWidth * NAV_CELL_SIZE),
+                        std::min(worldHeight, gridHeight * NAV_CELL_SIZE));
     
     // Initialize registry
     registry = std::make_shared<ComponentRegistry>();
     
-    // Initialize systems
+    // Initialize systems; with nothing to draw to there is no render system
     inputSystem = std::make_shared<InputSystem>();
-    renderSystem = registry->registerSystem<RenderSystem>();
+    if (window) {
+        renderSystem = registry->registerSystem<RenderSystem>();
+    }
     physicsSystem = registry->registerSystem<PhysicsSystem>();
     resourceSystem = registry->registerSystem<ResourceSystem>();
     combatSystem = registry->registerSystem<CombatSystem>();
@@ -23,37 +53,72 @@ Engine::Engine(int windowWidth, int windowHeight, const std::string& title) {
     movementSystem = registry->registerSystem<MovementSystem>();
     aiSystem = registry->registerSystem<AISystem>();
     
-    // Event system (standalone)
+    // Proximity queries share the index physics builds
+    spatialIndex = std::make_shared<SpatialIndex>();
+    physicsSystem->setSpatialIndex(spatialIndex);
+    selectionSystem->setSpatialIndex(spatialIndex);
+    movementSystem->setSpatialIndex(spatialIndex);
+    combatSystem->setSpatialIndex(spatialIndex);
+    
+    // Systems publish into the event bus; it is dispatched once per step
     eventSystem = std::make_shared<EventSystem>();
+    physicsSystem->setEventSystem(eventSystem);
+    combatSystem->setEventSystem(eventSystem);
+
+    // Anything can be clicked, enemies and buildings included, so every death
+    // may leave the selection; one sweep covers the step's deaths
+    eventSystem->subscribe<EntityDestroyedEvent>([this](const EventView<EntityDestroyedEvent>&) {
+        selectionSystem->removeDestroyed();
+    });
     
     // Pathfinding
-    pathfinder = std::make_shared<Pathfinder>(
-        windowWidth / 32, windowHeight / 32, 32.0f);
+    pathfinder = std::make_shared<Pathfinder>(gridWidth, gridHeight, NAV_CELL_SIZE);
+    unsigned int hardwareThreads = std::max(2u, std::thread::hardware_concurrency());
+    pathService = std::make_shared<PathService>(pathfinder, std::min(4u, hardwareThreads - 1));
+    movementSystem->setWorkerThreads(std::min(4u, hardwareThreads));
+    movementSystem->setPathfinder(pathfinder);
     
+    pathService->setDeterministic(deterministic);
+
+    resourceSystem->setPathService(pathService);
+    aiSystem->setPathService(pathService);
+    aiSystem->setCombatSystem(combatSystem);
+    
+    // Reset clock
+    clock.restart();
+
+    if (config.headless) {
+        return;
+    }
+
     // Connect render system to window
     renderSystem->setRenderTarget(window.get());
+    renderSystem->setWorldSize(worldSize);
     renderSystem->setSelectionSystem(selectionSystem);
     renderSystem->setResourceSystem(resourceSystem);
-    
-    // Reset clock
-    clock.restart();
+    renderSystem->setCombatSystem(combatSystem);
 
     // Sound system (procedural — works without audio files)
     soundSystem = std::make_shared<SoundSystem>();
+    soundSystem->listen(*eventSystem);
 }
 
 Engine::~Engine() {
+    stopRecording();
     if (window) {
         window->close();
     }
 }
 
 bool Engine::isRunning() const {
-    return window && window->isOpen();
+    // A headless engine runs until its caller stops stepping it
+    return !window || window->isOpen();
 }
 
 void Engine::pollEvents() {
-    inputSystem->update(0.0f);
+    if (!window) {
+        return;
+    }
 
     sf::Event event;
     while (window->pollEvent(event)) {
@@ -71,14 +136,15 @@ void Engine::pollEvents() {
 
         if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Left) {
             Vector2 releasePos(static_cast<float>(event.mouseButton.x), static_cast<float>(event.mouseButton.y));
+            Vector2 worldRelease = screenToWorld(releasePos);
             bool additive = sf::Keyboard::isKeyPressed(sf::Keyboard::LShift) ||
                             sf::Keyboard::isKeyPressed(sf::Keyboard::RShift);
 
             float dragDistance = leftDragStart.distance(releasePos);
             if (dragDistance > 12.0f) {
-                selectionSystem->handleBoxSelection(leftDragStart, releasePos, additive);
+                selectionSystem->handleBoxSelection(screenToWorld(leftDragStart), worldRelease, additive);
             } else {
-                selectionSystem->handleSelection(releasePos, true, additive);
+                selectionSystem->handleSelection(worldRelease, true, additive);
             }
 
             leftDragInProgress = false;
@@ -87,7 +153,8 @@ void Engine::pollEvents() {
         }
 
         if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Right) {
-            Vector2 clickPos(static_cast<float>(event.mouseButton.x), static_cast<float>(event.mouseButton.y));
+            Vector2 clickPos = screenToWorld(
+                Vector2(static_cast<float>(event.mouseButton.x), static_cast<float>(event.mouseButton.y)));
             auto clickedEntity = getEntityAtPoint(clickPos);
 
             auto selectedEntities = selectionSystem->getSelectedEntities();
@@ -98,64 +165,46 @@ void Engine::pollEvents() {
                 }
             }
 
-            bool defendCommand = sf::Keyboard::isKeyPressed(sf::Keyboard::LShift) ||
-                                 sf::Keyboard::isKeyPressed(sf::Keyboard::RShift);
+            // The order goes out as a command; which of the selection it moves
+            // is decided now, what each unit does with it when it is applied
+            PlayerCommand order;
+            order.kind = PlayerCommand::Kind::Order;
+            order.position = clickPos;
+            order.defend = sf::Keyboard::isKeyPressed(sf::Keyboard::LShift) ||
+                           sf::Keyboard::isKeyPressed(sf::Keyboard::RShift);
+            bool hostileClicked = false;
+            bool mineClicked = false;
+            if (clickedEntity && !clickedEntity->isDestroyed()) {
+                order.targetEntityId = clickedEntity->getId();
+                auto clickedTeam = clickedEntity->getComponent<TeamComponent>();
+                auto clickedRole = clickedEntity->getComponent<RoleComponent>();
+                hostileClicked = clickedTeam && clickedTeam->faction != Faction::Player &&
+                                 clickedTeam->faction != Faction::Neutral;
+                mineClicked = clickedRole && clickedRole->role == EntityRole::ResourceMine;
+            }
 
+            bool anyAttack = false;
+            bool anyGather = false;
             for (const auto& selected : selectedEntities) {
                 if (!selected || selected->isDestroyed()) {
                     continue;
                 }
-
                 auto selectedTeam = selected->getComponent<TeamComponent>();
-                auto selectedRole = selected->getComponent<RoleComponent>();
-                auto selectedCommand = selected->getComponent<CommandComponent>();
-                if (!selectedTeam || !selectedCommand || !selectedRole) {
-                    continue;
-                }
-                if (selectedTeam->faction != Faction::Player) {
+                if (!selectedTeam || selectedTeam->faction != Faction::Player ||
+                    !selected->hasComponent<CommandComponent>() || !selected->hasComponent<RoleComponent>()) {
                     continue;
                 }
-
-                bool issued = false;
-                if (clickedEntity && !clickedEntity->isDestroyed()) {
-                    auto clickedTeam = clickedEntity->getComponent<TeamComponent>();
-                    auto clickedRole = clickedEntity->getComponent<RoleComponent>();
-                    auto clickedTransform = clickedEntity->getComponent<TransformComponent>();
-
-                    if (clickedTeam && clickedTransform && clickedTeam->faction != Faction::Player &&
-                        clickedTeam->faction != Faction::Neutral && selected->hasComponent<CombatComponent>()) {
-                        selectedCommand->type = CommandType::Attack;
-                        selectedCommand->targetEntityId = clickedEntity->getId();
-                        selectedCommand->targetPosition = clickedTransform->position;
-                        assignPathToEntity(selected, clickedTransform->position);
-                        issued = true;
-                    } else if (clickedRole && clickedRole->role == EntityRole::ResourceMine &&
-                               selected->hasComponent<ResourceCollectorComponent>()) {
-                        selectedCommand->type = CommandType::Gather;
-                        selectedCommand->targetEntityId = clickedEntity->getId();
-                        selectedCommand->targetPosition = clickedTransform->position;
-                        assignPathToEntity(selected, clickedTransform->position);
-                        issued = true;
-                    }
-                }
-
-                if (!issued && selectedRole->role != EntityRole::Base && selectedRole->role != EntityRole::Turret) {
-                    selectedCommand->type = defendCommand ? CommandType::Defend : CommandType::Move;
-                    selectedCommand->targetEntityId = 0;
-                    selectedCommand->targetPosition = clickPos;
-                    selectedCommand->defendPosition = clickPos;
-                    assignPathToEntity(selected, clickPos);
-                }
+                order.units.push_back(selected->getId());
+                anyAttack = anyAttack || (hostileClicked && selected->hasComponent<CombatComponent>());
+                anyGather = anyGather || (mineClicked && selected->hasComponent<ResourceCollectorComponent>());
             }
+            if (order.units.empty()) {
+                continue;
+            }
+            submitCommand(std::move(order));
+
             // Play command sound
-            if (soundSystem && !selectedEntities.empty()) {
-                bool anyAttack = false;
-                bool anyGather = false;
-                for (auto& e : selectedEntities) {
-                    auto cmd = e->getComponent<CommandComponent>();
-                    if (cmd && cmd->type == CommandType::Attack) { anyAttack = true; break; }
-                    if (cmd && cmd->type == CommandType::Gather) { anyGather = true; }
-                }
+            if (soundSystem) {
                 if (anyAttack) soundSystem->playAttack();
                 else if (anyGather) soundSystem->playGather();
                 else          soundSystem->playMove();
@@ -164,19 +213,183 @@ void Engine::pollEvents() {
     }
 }
 
+void Engine::submitCommand(PlayerCommand command) {
+    if (playingBack) {
+        return;
+    }
+    pendingCommands.push_back(std::move(command));
+}
+
+void Engine::setCommandHandler(std::function<void(const PlayerCommand&)> handler) {
+    commandHandler = std::move(handler);
+}
+
+bool Engine::startRecording(const std::string& path, ReplayHeader header) {
+    if (!deterministic) {
+        std::cerr << "Replay: only a deterministic engine can record" << std::endl;
+        return false;
+    }
+
+    header.tickLength = tickLength;
+    auto writer = std::make_unique<ReplayWriter>();
+    if (!writer->open(path, header)) {
+        std::cerr << "Replay: cannot write " << path << std::endl;
+        return false;
+    }
+    stopRecording();
+    recorder = std::move(writer);
+    return true;
+}
+
+void Engine::stopRecording() {
+    if (recorder) {
+        recorder->close(static_cast<std::uint32_t>(tick));
+        recorder.reset();
+    }
+}
+
+void Engine::startPlayback(const Replay& replay) {
+    deterministic = true;
+    tickLength = replay.getHeader().tickLength;
+    pathService->setDeterministic(true);
+
+    playingBack = true;
+    pendingCommands.clear();
+    scheduledCommands = replay.getCommands();
+    nextScheduled = 0;
+    expectedCheckpoints = replay.getCheckpoints();
+    nextCheckpoint = 0;
+    playbackMismatchTick = 0;
+}
+
+void Engine::applyCommands() {
+    if (playingBack) {
+        while (nextScheduled < scheduledCommands.size() && scheduledCommands[nextScheduled].tick <= tick) {
+            pendingCommands.push_back(std::move(scheduledCommands[nextScheduled++]));
+        }
+    }
+
+    for (auto& command : pendingCommands) {
+        command.tick = static_cast<std::uint32_t>(tick);
+        if (recorder) {
+            recorder->writeCommand(command);
+        }
+
+        if (command.kind == PlayerCommand::Kind::Order) {
+            applyOrder(command);
+        } else if (commandHandler) {
+            commandHandler(command);
+        }
+    }
+    pendingCommands.clear();
+}
+
+void Engine::applyOrder(const PlayerCommand& order) {
+    auto clickedEntity = order.targetEntityId ? registry->getEntity(order.targetEntityId) : nullptr;
+
+    for (EntityID id : order.units) {
+        auto selected = registry->getEntity(id);
+        if (!selected || selected->isDestroyed()) {
+            continue;
+        }
+
+        auto selectedTeam = selected->getComponent<TeamComponent>();
+        auto selectedRole = selected->getComponent<RoleComponent>();
+        auto selectedCommand = selected->getComponent<CommandComponent>();
+        if (!selectedTeam || !selectedCommand || !selectedRole) {
+            continue;
+        }
+        if (selectedTeam->faction != Faction::Player) {
+            continue;
+        }
+
+        bool issued = false;
+        if (clickedEntity && !clickedEntity->isDestroyed()) {
+            auto clickedTeam = clickedEntity->getComponent<TeamComponent>();
+            auto clickedRole = clickedEntity->getComponent<RoleComponent>();
+            auto clickedTransform = clickedEntity->getComponent<TransformComponent>();
+
+            if (clickedTeam && clickedTransform && clickedTeam->faction != Faction::Player &&
+                clickedTeam->faction != Faction::Neutral && selected->hasComponent<CombatComponent>()) {
+                selectedCommand->type = CommandType::Attack;
+                selectedCommand->targetEntityId = clickedEntity->getId();
+                selectedCommand->targetPosition = clickedTransform->position;
+                assignPathToEntity(selected, clickedTransform->position);
+                issued = true;
+            } else if (clickedRole && clickedTransform && clickedRole->role == EntityRole::ResourceMine &&
+                       selected->hasComponent<ResourceCollectorComponent>()) {
+                selectedCommand->type = CommandType::Gather;
+                selectedCommand->targetEntityId = clickedEntity->getId();
+                selectedCommand->targetPosition = clickedTransform->position;
+                assignPathToEntity(selected, clickedTransform->position);
+                issued = true;
+            }
+        }
+
+        if (!issued && selectedRole->role != EntityRole::Base && selectedRole->role != EntityRole::Turret) {
+            selectedCommand->type = order.defend ? CommandType::Defend : CommandType::Move;
+            selectedCommand->targetEntityId = 0;
+            selectedCommand->targetPosition = order.position;
+            selectedCommand->defendPosition = order.position;
+            assignPathToEntity(selected, order.position);
+        }
+    }
+}
+
+void Engine::checkReplay() {
+    if (recorder && tick % ReplayWriter::CHECKPOINT_INTERVAL == 0) {
+        recorder->writeCheckpoint(static_cast<std::uint32_t>(tick), checksum);
+    }
+
+    while (playingBack && nextCheckpoint < expectedCheckpoints.size() &&
+           expectedCheckpoints[nextCheckpoint].tick <= tick) {
+        const ReplayCheckpoint& expected = expectedCheckpoints[nextCheckpoint++];
+        if (expected.tick == tick && expected.checksum != checksum && playbackMismatchTick == 0) {
+            playbackMismatchTick = tick;
+        }
+    }
+}
+
 void Engine::update(float deltaTime) {
+    if (deterministic) {
+        deltaTime = tickLength;
+    }
+    applyCommands();
+
     rebuildPathGrid();
+    pathService->update(*registry);
 
     // Update all systems
     registry->update(deltaTime);
+
+    // Sync point: listeners see the step's events while the entities they
+    // name are still around
+    eventSystem->dispatch();
     registry->cleanup();
+
+    // Clicks polled since the last step have now been seen by it
+    inputSystem->update(deltaTime);
+
+    ++tick;
+    if (deterministic) {
+        checksum = computeWorldChecksum(*registry, combatSystem->getProjectiles(), *resourceSystem);
+        checkReplay();
+    }
 }
 
-void Engine::render() {
+void Engine::render(float frameTime, float interpolation) {
+    if (!window) {
+        return;
+    }
+
+    // The camera pans per frame so scrolling stays smooth between steps
+    updateCamera(frameTime);
+
     window->clear(sf::Color(40, 40, 40));  // Dark gray background
     
-    // Render all entities
-    renderSystem->render();
+    // Render all entities; the HUD leaves the default (screen) view active
+    window->setView(camera);
+    renderSystem->render(frameTime, interpolation);
 
     if (leftDragInProgress) {
         Vector2 mouse = inputSystem->getMousePosition();
@@ -200,16 +413,47 @@ float Engine::getDeltaTime() const {
     return deltaTime;
 }
 
+Vector2 Engine::screenToWorld(Vector2 screen) const {
+    if (!window) {
+        return screen;
+    }
+
+    sf::Vector2f world = window->mapPixelToCoords(
+        sf::Vector2i(static_cast<int>(screen.x), static_cast<int>(screen.y)), camera);
+    return Vector2(world.x, world.y);
+}
+
+void Engine::updateCamera(float deltaTime) {
+    if (!window->hasFocus()) {
+        return;
+    }
+
+    Vector2 pan;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left))  pan.x -= 1.0f;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) pan.x += 1.0f;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up))    pan.y -= 1.0f;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down))  pan.y += 1.0f;
+
+    sf::Vector2f center = camera.getCenter() + sf::Vector2f(pan.x, pan.y) * (CAMERA_PAN_SPEED * deltaTime);
+
+    // Keep the view inside the world; a world smaller than the window stays centered
+    sf::Vector2f half = camera.getSize() * 0.5f;
+    auto clampAxis = [](float value, float halfView, float worldExtent) {
+        return worldExtent > halfView * 2.0f ? std::max(halfView, std::min(worldExtent - halfView, value))
+                                             : worldExtent * 0.5f;
+    };
+    camera.setCenter(clampAxis(center.x, half.x, worldSize.x), clampAxis(center.y, half.y, worldSize.y));
+}
+
 void Engine::rebuildPathGrid() {
     if (!pathfinder) {
         return;
     }
 
-    pathfinder->clearGrid();
-
-    constexpr float cellSize = 32.0f;
+    const float cellSize = pathfinder->getCellSize();
     int gridWidth = pathfinder->getGridWidth();
     int gridHeight = pathfinder->getGridHeight();
+    obstacleScratch.clear();
 
     for (const auto& [id, entity] : registry->getEntities()) {
         if (!entity || !entity->isActive() || entity->isDestroyed()) {
@@ -241,64 +485,46 @@ void Engine::rebuildPathGrid() {
                 float dx = centerX - transform->position.x;
                 float dy = centerY - transform->position.y;
                 if ((dx * dx + dy * dy) <= (collider->radius * collider->radius)) {
-                    pathfinder->setObstacle(x, y, true);
+                    obstacleScratch.push_back(y * gridWidth + x);
                 }
             }
         }
     }
+
+    // Sparse list, so the cost follows the number of obstacles rather than the map size.
+    // Only bumps the grid version (and invalidates snapshots) when something moved.
+    std::sort(obstacleScratch.begin(), obstacleScratch.end());
+    obstacleScratch.erase(std::unique(obstacleScratch.begin(), obstacleScratch.end()), obstacleScratch.end());
+    pathfinder->setObstacleCells(obstacleScratch);
 }
 
 std::shared_ptr<Entity> Engine::getEntityAtPoint(Vector2 point) const {
     std::shared_ptr<Entity> clicked = nullptr;
-    float bestDistance = std::numeric_limits<float>::max();
+    float bestDistanceSq = std::numeric_limits<float>::max();
 
-    for (const auto& [id, entity] : registry->getEntities()) {
-        if (!entity || !entity->isActive() || entity->isDestroyed()) {
-            continue;
+    // Every pickable entity has a collider, so the index holds all candidates
+    spatialIndex->forEachOverlapping(point, PICK_SLACK, [&](std::size_t item) {
+        const auto& entity = spatialIndex->getEntity(item);
+        if (!entity->isActive() || entity->isDestroyed()) {
+            return;
         }
 
         auto transform = entity->getComponent<TransformComponent>();
-        if (!transform) {
-            continue;
-        }
-
-        float radius = 18.0f;
         auto collider = entity->getComponent<ColliderComponent>();
-        auto render = entity->getComponent<RenderComponent>();
-        if (collider) {
-            radius = collider->radius;
-        } else if (render) {
-            radius = std::max(render->width, render->height) * 0.5f;
-        }
-
-        float d = transform->position.distance(point);
-        if (d <= radius && d < bestDistance) {
+        float d = transform->position.distanceSquared(point);
+        if (d <= collider->radius * collider->radius && d < bestDistanceSq) {
             clicked = entity;
-            bestDistance = d;
+            bestDistanceSq = d;
         }
-    }
+    });
 
     return clicked;
 }
 
 void Engine::assignPathToEntity(const std::shared_ptr<Entity>& entity, Vector2 target) {
-    if (!entity || !pathfinder) {
-        return;
-    }
-
-    auto transform = entity->getComponent<TransformComponent>();
-    auto movement = entity->getComponent<MovementComponent>();
-    auto path = entity->getComponent<PathComponent>();
-    if (!transform || !movement || !path) {
+    if (!entity || !pathService) {
         return;
     }
 
-    auto waypoints = pathfinder->findPath(transform->position, target);
-    if (waypoints.empty()) {
-        waypoints.push_back(target);
-    }
-
-    path->waypoints = waypoints;
-    path->currentIndex = 0;
-    movement->setTarget(path->waypoints.front());
+    pathService->requestMove(entity, target, PathPriority::High);
 }
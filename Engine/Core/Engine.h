@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <SFML/Graphics.hpp>
 #include "../ECS/ComponentRegistry.h"
@@ -13,14 +15,40 @@
 #include "../Systems/MovementSystem.h"
 #include "../AI/AISystem.h"
 #include "../Pathfinding/Pathfinder.h"
+#include "../Pathfinding/PathService.h"
 #include "../Systems/SoundSystem.h"
+#include "Replay.h"
+
+// How an Engine is set up. A headless engine runs the registry and every
+// gameplay system but opens no window, audio device or font, so it works on
+// machines without a display; update() is all there is to call on it.
+//
+// A deterministic engine steps exactly tickLength per update whatever it is
+// passed, waits for its path searches so results land on a fixed tick, and
+// checksums the world after every tick. Two deterministic engines given the
+// same level and the same inputs on the same ticks stay bit-identical.
+struct EngineConfig {
+    int windowWidth = 1200;
+    int windowHeight = 800;
+    std::string title = "AI Strategy Game";
+    float worldWidth = 0.0f;   // 0 for the window's size
+    float worldHeight = 0.0f;
+    bool headless = false;
+    bool deterministic = false;
+    float tickLength = 1.0f / 30.0f;  // Deterministic mode only
+};
 
 class Engine {
 public:
+    explicit Engine(const EngineConfig& config);
     Engine(int windowWidth, int windowHeight, const std::string& title);
+
+    // World of worldWidth x worldHeight pixels, independent of the window; the arrow
+    // keys pan the camera over it. Clamped to 4096 x 4096 nav cells.
+    Engine(int windowWidth, int windowHeight, const std::string& title, float worldWidth, float worldHeight);
     ~Engine();
     
-    // Core systems
+    // Core systems. Headless engines have no render or sound system.
     std::shared_ptr<ComponentRegistry> getRegistry() { return registry; }
     std::shared_ptr<InputSystem> getInputSystem() { return inputSystem; }
     std::shared_ptr<RenderSystem> getRenderSystem() { return renderSystem; }
@@ -32,25 +60,67 @@ public:
     std::shared_ptr<MovementSystem> getMovementSystem() { return movementSystem; }
     std::shared_ptr<AISystem> getAISystem() { return aiSystem; }
     std::shared_ptr<Pathfinder> getPathfinder() { return pathfinder; }
+    std::shared_ptr<PathService> getPathService() { return pathService; }
+    std::shared_ptr<SpatialIndex> getSpatialIndex() { return spatialIndex; }
     std::shared_ptr<SoundSystem> getSoundSystem() { return soundSystem; }
     
-    // Window management
+    // Window management; there is no window when headless
+    bool isHeadless() const { return !window; }
     sf::RenderWindow* getWindow() { return window.get(); }
+    Vector2 getWorldSize() const { return worldSize; }
+
+    // Window pixel -> world position under the camera
+    Vector2 screenToWorld(Vector2 screen) const;
     bool isRunning() const;
     void pollEvents();
     
-    // Game loop
+    // Game loop: update() advances the simulation one fixed step; render() runs once
+    // per displayed frame, interpolation (0..1) of the way into the next step
     void update(float deltaTime);
-    void render();
+    void render(float frameTime, float interpolation);
     
     float getDeltaTime() const;
 
+    // Lockstep: ticks stepped so far and the world checksum after the last one
+    // (0 until the first tick, and always 0 when not deterministic)
+    bool isDeterministic() const { return deterministic; }
+    std::uint64_t getTick() const { return tick; }
+    std::uint64_t getChecksum() const { return checksum; }
+
+    // Player input as commands: queued here, stamped with the coming tick and
+    // carried out at the start of the next update, so a recording plays back
+    // on exactly the ticks it was given. Unit orders the engine carries out
+    // itself; production and building go to the handler. Live commands are
+    // dropped while a replay plays.
+    void submitCommand(PlayerCommand command);
+    void setCommandHandler(std::function<void(const PlayerCommand&)> handler);
+
+    // Record every command from now on to path, with a checksum each second.
+    // Only a deterministic engine can record; false if it isn't or the file
+    // can't be written.
+    bool startRecording(const std::string& path, ReplayHeader header);
+    void stopRecording();
+    bool isRecording() const { return recorder != nullptr; }
+
+    // Feed a recording's commands in on their ticks instead of live input and
+    // check the world against its checkpoints. Start on a freshly set up level.
+    void startPlayback(const Replay& replay);
+    bool isPlayingBack() const { return playingBack; }
+    // First checkpoint tick where the world differed from the recording, 0 if none yet
+    std::uint64_t getPlaybackMismatchTick() const { return playbackMismatchTick; }
+
 private:
     void rebuildPathGrid();
+    void updateCamera(float deltaTime);
     std::shared_ptr<Entity> getEntityAtPoint(Vector2 point) const;
+    void applyCommands();
+    void applyOrder(const PlayerCommand& order);
+    void checkReplay();
     void assignPathToEntity(const std::shared_ptr<Entity>& entity, Vector2 target);
 
     std::unique_ptr<sf::RenderWindow> window;
+    Vector2 worldSize;
+    sf::View camera;
     
     // ECS
     std::shared_ptr<ComponentRegistry> registry;
@@ -66,16 +136,39 @@ private:
     std::shared_ptr<MovementSystem> movementSystem;
     std::shared_ptr<AISystem> aiSystem;
 
+    // Every collider, rebuilt by the physics system each update
+    std::shared_ptr<SpatialIndex> spatialIndex;
+
     // AI & Pathfinding
     std::shared_ptr<Pathfinder> pathfinder;
+    std::shared_ptr<PathService> pathService;
 
     std::shared_ptr<SoundSystem> soundSystem;
     
     // Timing
     sf::Clock clock;
     float deltaTime = 0.0f;
+    bool deterministic = false;
+    float tickLength = 0.0f;
+    std::uint64_t tick = 0;
+    std::uint64_t checksum = 0;
+
+    // Commands: live ones wait in pendingCommands for the next update; a
+    // replay's are taken from scheduledCommands in tick order
+    std::vector<PlayerCommand> pendingCommands;
+    std::function<void(const PlayerCommand&)> commandHandler;
+    std::unique_ptr<ReplayWriter> recorder;
+    bool playingBack = false;
+    std::vector<PlayerCommand> scheduledCommands;
+    std::size_t nextScheduled = 0;
+    std::vector<ReplayCheckpoint> expectedCheckpoints;
+    std::size_t nextCheckpoint = 0;
+    std::uint64_t playbackMismatchTick = 0;
 
     // Input interaction state
     bool leftDragInProgress = false;
-    Vector2 leftDragStart;
+    Vector2 leftDragStart;  // Window pixels
+
+    // Scratch list of obstacle cells rebuilt every frame
+    std::vector<int> obstacleScratch;
 };
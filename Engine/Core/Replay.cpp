@@ -0,0 +1,246 @@
+#include "Replay.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+namespace {
+const char MAGIC[4] = {'A', 'I', 'S', 'R'};
+const std::uint8_t VERSION = 1;
+const std::uint8_t FLAG_PLAYER_AI = 1;
+const std::uint8_t FLAG_DEFEND = 1;
+
+// Record types; commands are their Kind plus one
+const std::uint8_t RECORD_ORDER = 1;
+const std::uint8_t RECORD_PRODUCE = 2;
+const std::uint8_t RECORD_BUILD = 3;
+const std::uint8_t RECORD_CHECKPOINT = 4;
+const std::uint8_t RECORD_END = 5;
+
+// Bounds-checked cursor over a loaded file; any read past the end fails the rest
+struct ByteReader {
+    const std::vector<std::uint8_t>& bytes;
+    std::size_t offset = 0;
+    bool ok = true;
+
+    bool atEnd() const { return offset >= bytes.size(); }
+
+    std::uint8_t byte() {
+        if (offset >= bytes.size()) {
+            ok = false;
+            return 0;
+        }
+        return bytes[offset++];
+    }
+
+    std::uint64_t varint() {
+        std::uint64_t value = 0;
+        for (int shift = 0; shift < 64 && ok; shift += 7) {
+            std::uint8_t next = byte();
+            value |= static_cast<std::uint64_t>(next & 0x7f) << shift;
+            if (!(next & 0x80)) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    std::uint64_t fixed(int size) {
+        std::uint64_t value = 0;
+        for (int i = 0; i < size; ++i) {
+            value |= static_cast<std::uint64_t>(byte()) << (i * 8);
+        }
+        return value;
+    }
+
+    float real() {
+        std::uint32_t bits = static_cast<std::uint32_t>(fixed(4));
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+};
+}  // namespace
+
+ReplayWriter::~ReplayWriter() {
+    close(lastTick);
+}
+
+bool ReplayWriter::open(const std::string& path, const ReplayHeader& header) {
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+
+    out.write(MAGIC, sizeof(MAGIC));
+    out.put(static_cast<char>(VERSION));
+    writeFloat(header.tickLength);
+    out.put(static_cast<char>(header.playerAIControlled ? FLAG_PLAYER_AI : 0));
+    lastTick = 0;
+    return static_cast<bool>(out);
+}
+
+void ReplayWriter::writeCommand(const PlayerCommand& command) {
+    if (!out.is_open()) {
+        return;
+    }
+
+    writeRecord(static_cast<std::uint8_t>(command.kind) + 1, command.tick);
+    if (command.kind == PlayerCommand::Kind::Order) {
+        out.put(static_cast<char>(command.defend ? FLAG_DEFEND : 0));
+        writeVarint(command.targetEntityId);
+        writeFloat(command.position.x);
+        writeFloat(command.position.y);
+        writeVarint(command.units.size());
+        for (EntityID id : command.units) {
+            writeVarint(id);
+        }
+    } else {
+        out.put(static_cast<char>(command.role));
+        writeFloat(command.position.x);
+        writeFloat(command.position.y);
+    }
+}
+
+void ReplayWriter::writeCheckpoint(std::uint32_t tick, std::uint64_t checksum) {
+    if (!out.is_open()) {
+        return;
+    }
+
+    writeRecord(RECORD_CHECKPOINT, tick);
+    for (int i = 0; i < 8; ++i) {
+        out.put(static_cast<char>((checksum >> (i * 8)) & 0xff));
+    }
+    // A session that crashes keeps everything up to its last second
+    out.flush();
+}
+
+void ReplayWriter::close(std::uint32_t finalTick) {
+    if (!out.is_open()) {
+        return;
+    }
+
+    writeRecord(RECORD_END, std::max(finalTick, lastTick));
+    out.close();
+}
+
+void ReplayWriter::writeRecord(std::uint8_t type, std::uint32_t tick) {
+    out.put(static_cast<char>(type));
+    writeVarint(tick - lastTick);
+    lastTick = tick;
+}
+
+void ReplayWriter::writeVarint(std::uint64_t value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+void ReplayWriter::writeFloat(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 4; ++i) {
+        out.put(static_cast<char>((bits >> (i * 8)) & 0xff));
+    }
+}
+
+bool Replay::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Replay: cannot open " << path << std::endl;
+        return false;
+    }
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    ByteReader reader{bytes};
+    char magic[4];
+    for (char& c : magic) {
+        c = static_cast<char>(reader.byte());
+    }
+    std::uint8_t version = reader.byte();
+    if (!reader.ok || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION) {
+        std::cerr << "Replay: " << path << " is not a version " << int(VERSION) << " replay" << std::endl;
+        return false;
+    }
+
+    header.tickLength = reader.real();
+    header.playerAIControlled = (reader.byte() & FLAG_PLAYER_AI) != 0;
+    commands.clear();
+    checkpoints.clear();
+    length = 0;
+
+    std::uint32_t tick = 0;
+    bool ended = false;
+    while (reader.ok && !reader.atEnd() && !ended) {
+        std::uint8_t type = reader.byte();
+        tick += static_cast<std::uint32_t>(reader.varint());
+
+        switch (type) {
+            case RECORD_ORDER: {
+                PlayerCommand command;
+                command.tick = tick;
+                command.defend = (reader.byte() & FLAG_DEFEND) != 0;
+                command.targetEntityId = static_cast<EntityID>(reader.varint());
+                command.position.x = reader.real();
+                command.position.y = reader.real();
+                std::uint64_t count = reader.varint();
+                // Each id takes at least a byte, which bounds a corrupt count
+                if (count > bytes.size() - std::min(bytes.size(), reader.offset)) {
+                    reader.ok = false;
+                    break;
+                }
+                command.units.reserve(static_cast<std::size_t>(count));
+                for (std::uint64_t i = 0; i < count; ++i) {
+                    command.units.push_back(static_cast<EntityID>(reader.varint()));
+                }
+                if (reader.ok) {
+                    commands.push_back(std::move(command));
+                }
+                break;
+            }
+            case RECORD_PRODUCE:
+            case RECORD_BUILD: {
+                PlayerCommand command;
+                command.kind = static_cast<PlayerCommand::Kind>(type - 1);
+                command.tick = tick;
+                command.role = static_cast<EntityRole>(reader.byte());
+                command.position.x = reader.real();
+                command.position.y = reader.real();
+                if (reader.ok) {
+                    commands.push_back(std::move(command));
+                }
+                break;
+            }
+            case RECORD_CHECKPOINT: {
+                std::uint64_t checksum = reader.fixed(8);
+                if (reader.ok) {
+                    checkpoints.push_back({tick, checksum});
+                }
+                break;
+            }
+            case RECORD_END:
+                ended = true;
+                break;
+            default:
+                reader.ok = false;
+                break;
+        }
+        if (reader.ok) {
+            length = tick;
+        }
+    }
+
+    // Running out of bytes mid-record is a session that never closed its
+    // file; everything before the cut still plays
+    if (!reader.ok && reader.offset < bytes.size()) {
+        std::cerr << "Replay: " << path << " is corrupt after tick " << length << std::endl;
+        return false;
+    }
+    if (!ended) {
+        std::cerr << "Replay: " << path << " was cut off; playing its first " << length << " ticks" << std::endl;
+    }
+    return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "../ECS/Component.h"
+
+// What the player asked for, as data that can be stored and played back. Orders
+// name their units by id rather than through the selection, so replaying one
+// needs no selection state.
+struct PlayerCommand {
+    enum class Kind : std::uint8_t {
+        Order,    // Units act on targetEntityId if set, else go to (or defend) position
+        Produce,  // A unit of role comes out of the player's base at position
+        Build     // A building of role goes up at position
+    };
+
+    Kind kind = Kind::Order;
+    std::uint32_t tick = 0;  // Applied just before this tick is stepped
+    EntityRole role = EntityRole::Unknown;  // Produce and Build
+    bool defend = false;                    // Order: hold the position instead of moving on
+    EntityID targetEntityId = 0;            // Order: what was clicked, 0 for open ground
+    Vector2 position;
+    std::vector<EntityID> units;            // Order: in selection order
+};
+
+// World checksum expected after a tick
+struct ReplayCheckpoint {
+    std::uint32_t tick = 0;
+    std::uint64_t checksum = 0;
+};
+
+// How the session was set up; the level itself is the game's fixed one
+struct ReplayHeader {
+    float tickLength = 1.0f / 30.0f;
+    bool playerAIControlled = false;
+};
+
+// Streams a session to disk as it is played: the header, then every command
+// and a checkpoint every CHECKPOINT_INTERVAL ticks. Ticks are stored as the
+// gap since the previous record and ids as varints, so a long session of
+// clicks stays a few kilobytes. Little-endian whatever the machine.
+class ReplayWriter {
+public:
+    static const std::uint32_t CHECKPOINT_INTERVAL = 30;
+
+    ReplayWriter() = default;
+    ~ReplayWriter();
+
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    // False when the file can't be created
+    bool open(const std::string& path, const ReplayHeader& header);
+    bool isOpen() const { return out.is_open(); }
+
+    void writeCommand(const PlayerCommand& command);
+    void writeCheckpoint(std::uint32_t tick, std::uint64_t checksum);
+
+    // Marks the session's length; further writes are ignored
+    void close(std::uint32_t finalTick);
+
+private:
+    std::ofstream out;
+    std::uint32_t lastTick = 0;
+
+    void writeRecord(std::uint8_t type, std::uint32_t tick);
+    void writeVarint(std::uint64_t value);
+    void writeFloat(float value);
+};
+
+// A recorded session loaded whole for playback
+class Replay {
+public:
+    // False, with the reason on std::cerr, when the file is missing or malformed
+    bool load(const std::string& path);
+
+    const ReplayHeader& getHeader() const { return header; }
+    const std::vector<PlayerCommand>& getCommands() const { return commands; }
+    const std::vector<ReplayCheckpoint>& getCheckpoints() const { return checkpoints; }
+
+    // Ticks the session ran for; the last command or checkpoint if it wasn't closed cleanly
+    std::uint32_t getLength() const { return length; }
+
+private:
+    ReplayHeader header;
+    std::vector<PlayerCommand> commands;
+    std::vector<ReplayCheckpoint> checkpoints;
+    std::uint32_t length = 0;
+};
@@ -0,0 +1,61 @@
+#include "WorldChecksum.h"
+#include "../ECS/ComponentRegistry.h"
+#include "../ECS/Component.h"
+#include "../Systems/CombatSystem.h"
+#include "../Systems/ResourceSystem.h"
+
+std::uint64_t computeWorldChecksum(const ComponentRegistry& registry, const Projectiles& projectiles,
+                                   const ResourceSystem& resources) {
+    WorldChecksum checksum;
+
+    for (const auto& [id, entity] : registry.getEntities()) {
+        if (!entity || entity->isDestroyed()) {
+            continue;
+        }
+        checksum.add(static_cast<std::uint64_t>(id));
+        checksum.add(static_cast<std::uint64_t>(entity->isActive()));
+        checksum.add(static_cast<std::uint64_t>(entity->isAwake()));
+
+        if (auto transform = entity->getComponent<TransformComponent>()) {
+            checksum.add(transform->position);
+            checksum.add(transform->rotation);
+        }
+        if (auto physics = entity->getComponent<PhysicsComponent>()) {
+            checksum.add(physics->velocity);
+        }
+        if (auto health = entity->getComponent<HealthComponent>()) {
+            checksum.add(health->currentHealth);
+        }
+        if (auto team = entity->getComponent<TeamComponent>()) {
+            checksum.add(static_cast<std::uint64_t>(team->faction));
+        }
+        if (auto movement = entity->getComponent<MovementComponent>()) {
+            checksum.add(static_cast<std::uint64_t>(movement->hasTarget));
+            checksum.add(movement->targetPosition);
+        }
+        if (auto path = entity->getComponent<PathComponent>()) {
+            checksum.add(static_cast<std::uint64_t>(path->waypoints.size()));
+            checksum.add(static_cast<std::uint64_t>(path->currentIndex));
+        }
+        if (auto command = entity->getComponent<CommandComponent>()) {
+            checksum.add(static_cast<std::uint64_t>(command->type));
+            checksum.add(static_cast<std::uint64_t>(command->targetEntityId));
+        }
+        if (auto combat = entity->getComponent<CombatComponent>()) {
+            checksum.add(combat->attackCooldownTimer);
+            checksum.add(static_cast<std::uint64_t>(combat->currentTarget));
+        }
+        if (auto collector = entity->getComponent<ResourceCollectorComponent>()) {
+            checksum.add(collector->carryAmount);
+        }
+        if (auto node = entity->getComponent<ResourceNodeComponent>()) {
+            checksum.add(node->amountRemaining);
+        }
+    }
+
+    projectiles.addToChecksum(checksum);
+    for (Faction faction : {Faction::Neutral, Faction::Player, Faction::Enemy}) {
+        checksum.add(resources.getResource(faction, "Gold"));
+    }
+    return checksum.value();
+}
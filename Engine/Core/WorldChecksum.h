@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include "../Math/Vector2.h"
+
+class ComponentRegistry;
+class Projectiles;
+class ResourceSystem;
+
+// 64-bit FNV-1a over the simulation state. Floats are hashed by their bits, so
+// two worlds only match when every value is identical, not merely close.
+class WorldChecksum {
+public:
+    void add(std::uint64_t value) {
+        for (int i = 0; i < 8; ++i) {
+            hash = (hash ^ ((value >> (i * 8)) & 0xff)) * PRIME;
+        }
+    }
+
+    void add(float value) {
+        std::uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        add(static_cast<std::uint64_t>(bits));
+    }
+
+    void add(Vector2 value) {
+        add(value.x);
+        add(value.y);
+    }
+
+    std::uint64_t value() const { return hash; }
+
+private:
+    static constexpr std::uint64_t PRIME = 1099511628211ull;
+    std::uint64_t hash = 14695981039346656037ull;
+};
+
+// What lockstep peers compare each tick: every entity in id order with the
+// components gameplay changes, then the shots and burns in flight and each
+// faction's gold. Render-only state (interpolation, selection, fog) is left
+// out so it can't cause a mismatch.
+std::uint64_t computeWorldChecksum(const ComponentRegistry& registry, const Projectiles& projectiles,
+                                   const ResourceSystem& resources);
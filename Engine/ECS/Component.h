@@ -6,11 +6,20 @@
 #include <utility>
 #include <unordered_map>
 #include "../Math/Vector2.h"
+#include "../Pathfinding/MovementClass.h"
+#include "Entity.h"
 
 class Component {
 public:
     virtual ~Component() = default;
     virtual void update(float deltaTime) {}
+
+    // Entity the component was added to
+    Entity* getOwner() const { return owner; }
+
+private:
+    friend class Entity;
+    Entity* owner = nullptr;
 };
 
 enum class Faction {
@@ -45,11 +54,12 @@ enum class CommandType {
 
 struct TransformComponent : public Component {
     Vector2 position;
+    Vector2 previousPosition;  // At the start of the last simulation step, for render interpolation
     Vector2 scale = Vector2(1.0f, 1.0f);
     float rotation = 0.0f;
     
     TransformComponent() = default;
-    TransformComponent(Vector2 pos) : position(pos) {}
+    TransformComponent(Vector2 pos) : position(pos), previousPosition(pos) {}
 };
 
 // ===== PHYSICS COMPONENT =====
@@ -57,7 +67,7 @@ struct PhysicsComponent : public Component {
     Vector2 velocity;
     Vector2 acceleration;
     float mass = 1.0f;
-    float friction = 0.1f;
+    float friction = 6.0f;  // Velocity decay rate per second; about 0.25% is left after one second
     
     PhysicsComponent() = default;
 };
@@ -153,7 +163,9 @@ struct MovementComponent : public Component {
     bool hasTarget = false;
     float moveSpeed = 100.0f;  // pixels per second
     float arrivalRadius = 5.0f;  // Distance to consider "arrived"
+    MovementClass movementClass = MovementClass::Infantry;  // Which nav layer paths are planned on
     float stuckTimer = 0.0f;
+    float restTimer = 0.0f;  // Seconds idle and still; the unit sleeps once it is long enough
     Vector2 lastPosition;
     bool hasLastPosition = false;
     
@@ -163,6 +175,10 @@ struct MovementComponent : public Component {
     void setTarget(Vector2 target) {
         targetPosition = target;
         hasTarget = true;
+        restTimer = 0.0f;
+        if (Entity* entity = getOwner()) {
+            entity->wake();
+        }
     }
     
     void clearTarget() {
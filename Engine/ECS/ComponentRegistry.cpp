@@ -6,7 +6,8 @@ ComponentRegistry::ComponentRegistry() {
 
 std::shared_ptr<Entity> ComponentRegistry::createEntity() {
     auto entity = std::make_shared<Entity>(nextEntityId++);
-    entities[entity->getId()] = entity;
+    entity->setActivityQueue(activityChanges);
+    entities.emplace_hint(entities.end(), entity->getId(), entity);  // Ids only grow
     notifySystems(entity);
     return entity;
 }
@@ -28,10 +29,29 @@ std::shared_ptr<Entity> ComponentRegistry::getEntity(EntityID id) {
 
 void ComponentRegistry::update(float deltaTime) {
     for (auto& system : systems) {
+        // Earlier systems may have woken entities this one steps
+        applyActivityChanges();
         system->update(deltaTime);
     }
 }
 
+void ComponentRegistry::applyActivityChanges() {
+    if (activityChanges->empty()) {
+        return;
+    }
+
+    // Swapped out first: a system reacting here could queue more changes
+    pendingActivity.swap(*activityChanges);
+    for (EntityID id : pendingActivity) {
+        auto it = entities.find(id);
+        if (it == entities.end()) continue;
+        for (auto& system : systems) {
+            system->updateActivity(it->second);
+        }
+    }
+    pendingActivity.clear();
+}
+
 void ComponentRegistry::cleanup() {
     for (auto it = entities.begin(); it != entities.end(); ) {
         if (it->second->isDestroyed()) {
@@ -46,7 +66,7 @@ void ComponentRegistry::cleanup() {
     }
 }
 
-const std::unordered_map<EntityID, std::shared_ptr<Entity>>& ComponentRegistry::getEntities() const {
+const std::map<EntityID, std::shared_ptr<Entity>>& ComponentRegistry::getEntities() const {
     return entities;
 }
 
@@ -1,8 +1,8 @@
 #pragma once
 
+#include <map>
 #include <memory>
 #include <vector>
-#include <unordered_map>
 #include "Entity.h"
 #include "System.h"
 
@@ -34,12 +34,16 @@ public:
     
     // Update all systems
     void update(float deltaTime);
+
+    // Moves entities that woke or fell asleep into or out of the systems'
+    // awake lists; update() does this before each system runs
+    void applyActivityChanges();
     
     // Clean up destroyed entities
     void cleanup();
     
-    // Get all entities
-    const std::unordered_map<EntityID, std::shared_ptr<Entity>>& getEntities() const;
+    // Get all entities, in id (so creation) order on every platform
+    const std::map<EntityID, std::shared_ptr<Entity>>& getEntities() const;
     
     size_t getEntityCount() const;
     
@@ -48,6 +52,8 @@ public:
 
 private:
     EntityID nextEntityId = 1;
-    std::unordered_map<EntityID, std::shared_ptr<Entity>> entities;
+    std::map<EntityID, std::shared_ptr<Entity>> entities;
     std::vector<std::shared_ptr<System>> systems;
+    std::shared_ptr<std::vector<EntityID>> activityChanges = std::make_shared<std::vector<EntityID>>();
+    std::vector<EntityID> pendingActivity;
 };
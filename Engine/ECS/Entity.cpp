@@ -8,6 +8,7 @@ EntityID Entity::getId() const {
 }
 
 void Entity::addComponent(std::shared_ptr<Component> component) {
+    component->owner = this;
     components[std::type_index(typeid(*component))] = component;
 }
 
@@ -34,3 +35,19 @@ void Entity::destroy() {
 bool Entity::isDestroyed() const {
     return destroyed;
 }
+
+void Entity::wake() {
+    if (awake) return;
+    awake = true;
+    if (activityQueue) activityQueue->push_back(id);
+}
+
+void Entity::sleep() {
+    if (!awake) return;
+    awake = false;
+    if (activityQueue) activityQueue->push_back(id);
+}
+
+void Entity::setActivityQueue(std::shared_ptr<std::vector<EntityID>> queue) {
+    activityQueue = std::move(queue);
+}
@@ -43,9 +43,20 @@ public:
     void destroy();
     bool isDestroyed() const;
 
+    // Sleeping entities drop out of the systems that only step awake ones;
+    // giving them work (a target, damage, a shove) wakes them
+    bool isAwake() const { return awake; }
+    void wake();
+    void sleep();
+
+    // Where wake() and sleep() report a change; set by the registry
+    void setActivityQueue(std::shared_ptr<std::vector<EntityID>> queue);
+
 private:
     EntityID id;
     bool active = true;
     bool destroyed = false;
+    bool awake = true;
+    std::shared_ptr<std::vector<EntityID>> activityQueue;
     std::unordered_map<std::type_index, std::shared_ptr<Component>> components;
 };
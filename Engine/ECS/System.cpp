@@ -17,6 +17,9 @@ bool System::entityMatches(const std::shared_ptr<Entity>& entity) const {
 }
 
 void System::registerEntity(const std::shared_ptr<Entity>& entity) {
+    // Re-registration follows a component change, which cached data must see too
+    ++membershipVersion;
+
     // Check if already registered
     for (const auto& existing : entities) {
         if (existing->getId() == entity->getId()) {
@@ -24,6 +27,9 @@ void System::registerEntity(const std::shared_ptr<Entity>& entity) {
         }
     }
     entities.push_back(entity);
+    if (entity->isAwake()) {
+        addAwake(entity);
+    }
 }
 
 void System::unregisterEntity(EntityID entityId) {
@@ -31,7 +37,47 @@ void System::unregisterEntity(EntityID entityId) {
         [entityId](const std::shared_ptr<Entity>& e) { return e->getId() == entityId; });
     if (it != entities.end()) {
         entities.erase(it);
+        removeAwake(entityId);
+        ++membershipVersion;
+    }
+}
+
+void System::updateActivity(const std::shared_ptr<Entity>& entity) {
+    // Entities join the system only through registerEntity, so matching stands in for membership
+    if (!tracksActivity || !entityMatches(entity)) {
+        return;
+    }
+    if (entity->isAwake()) {
+        addAwake(entity);
+    } else {
+        removeAwake(entity->getId());
+    }
+}
+
+void System::addAwake(const std::shared_ptr<Entity>& entity) {
+    if (!tracksActivity || awakeSlots.count(entity->getId())) {
+        return;
+    }
+    awakeSlots[entity->getId()] = awakeEntities.size();
+    awakeEntities.push_back(entity);
+    ++activityVersion;
+}
+
+void System::removeAwake(EntityID entityId) {
+    auto it = awakeSlots.find(entityId);
+    if (it == awakeSlots.end()) {
+        return;
+    }
+
+    // Swap with the last entry so removal is O(1)
+    const std::size_t slot = it->second;
+    awakeSlots.erase(it);
+    if (slot + 1 != awakeEntities.size()) {
+        awakeEntities[slot] = std::move(awakeEntities.back());
+        awakeSlots[awakeEntities[slot]->getId()] = slot;
     }
+    awakeEntities.pop_back();
+    ++activityVersion;
 }
 
 const std::vector<std::shared_ptr<Entity>>& System::getEntities() const {
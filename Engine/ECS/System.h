@@ -3,8 +3,10 @@
 #include <vector>
 #include <memory>
 #include <typeindex>
+#include <unordered_map>
 #include <unordered_set>
 #include <algorithm>
+#include <cstdint>
 #include "Entity.h"
 
 class System {
@@ -28,13 +30,33 @@ public:
     // Get all matching entities
     const std::vector<std::shared_ptr<Entity>>& getEntities() const;
 
+    // Keeps the awake list in step after the entity woke or fell asleep
+    void updateActivity(const std::shared_ptr<Entity>& entity);
+
 protected:
     std::unordered_set<std::type_index> requiredComponents;
     std::vector<std::shared_ptr<Entity>> entities;
+
+    // Bumped when an entity joins, leaves or is re-registered; lets systems cache per-entity data
+    std::uint64_t membershipVersion = 0;
+    
+    // Matching entities that are awake, in no particular order; kept only for
+    // systems that call trackActivity() from setRequiredComponents()
+    std::vector<std::shared_ptr<Entity>> awakeEntities;
+    std::uint64_t activityVersion = 0;  // Bumped when an entity joins or leaves awakeEntities
     
     // Helper to add required component type
     template<typename T>
     void require() {
         requiredComponents.insert(std::type_index(typeid(T)));
     }
+
+    void trackActivity() { tracksActivity = true; }
+
+private:
+    bool tracksActivity = false;
+    std::unordered_map<EntityID, std::size_t> awakeSlots;  // Index of each entry in awakeEntities
+
+    void addAwake(const std::shared_ptr<Entity>& entity);
+    void removeAwake(EntityID entityId);
 };
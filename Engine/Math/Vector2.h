@@ -2,41 +2,77 @@
 
 #include <cmath>
 
+// Header-only so every call inlines across the Engine library boundary;
+// everything that doesn't need a square root is constexpr
 class Vector2 {
 public:
     float x, y;
 
-    Vector2();
-    Vector2(float x, float y);
+    constexpr Vector2() : x(0.0f), y(0.0f) {}
+    constexpr Vector2(float x, float y) : x(x), y(y) {}
 
     // Operators
-    Vector2 operator+(const Vector2& other) const;
-    Vector2 operator-(const Vector2& other) const;
-    Vector2 operator*(float scalar) const;
-    Vector2 operator/(float scalar) const;
+    constexpr Vector2 operator+(const Vector2& other) const { return Vector2(x + other.x, y + other.y); }
+    constexpr Vector2 operator-(const Vector2& other) const { return Vector2(x - other.x, y - other.y); }
+    constexpr Vector2 operator*(float scalar) const { return Vector2(x * scalar, y * scalar); }
+    constexpr Vector2 operator/(float scalar) const { return Vector2(x / scalar, y / scalar); }
 
-    Vector2& operator+=(const Vector2& other);
-    Vector2& operator-=(const Vector2& other);
-    Vector2& operator*=(float scalar);
-    Vector2& operator/=(float scalar);
+    constexpr Vector2& operator+=(const Vector2& other) {
+        x += other.x;
+        y += other.y;
+        return *this;
+    }
 
-    bool operator==(const Vector2& other) const;
+    constexpr Vector2& operator-=(const Vector2& other) {
+        x -= other.x;
+        y -= other.y;
+        return *this;
+    }
+
+    constexpr Vector2& operator*=(float scalar) {
+        x *= scalar;
+        y *= scalar;
+        return *this;
+    }
+
+    constexpr Vector2& operator/=(float scalar) {
+        x /= scalar;
+        y /= scalar;
+        return *this;
+    }
+
+    constexpr bool operator==(const Vector2& other) const { return x == other.x && y == other.y; }
 
     // Utility functions
-    float magnitude() const;
-    float magnitudeSquared() const;
-    Vector2 normalized() const;
-    float distance(const Vector2& other) const;
-    float dot(const Vector2& other) const;
+    float magnitude() const { return std::sqrt(x * x + y * y); }
+    constexpr float magnitudeSquared() const { return x * x + y * y; }
+
+    Vector2 normalized() const {
+        float mag = magnitude();
+        if (mag == 0.0f) return Vector2::zero();
+        return *this / mag;
+    }
+
+    float distance(const Vector2& other) const { return (*this - other).magnitude(); }
+    constexpr float distanceSquared(const Vector2& other) const { return (*this - other).magnitudeSquared(); }
+
+    // Range test without the square root
+    constexpr bool isWithin(const Vector2& other, float range) const {
+        return distanceSquared(other) <= range * range;
+    }
+
+    constexpr float dot(const Vector2& other) const { return x * other.x + y * other.y; }
 
     // Static functions
-    static Vector2 zero();
-    static Vector2 one();
-    static Vector2 up();
-    static Vector2 down();
-    static Vector2 left();
-    static Vector2 right();
+    static constexpr Vector2 zero() { return Vector2(0.0f, 0.0f); }
+    static constexpr Vector2 one() { return Vector2(1.0f, 1.0f); }
+    static constexpr Vector2 up() { return Vector2(0.0f, -1.0f); }
+    static constexpr Vector2 down() { return Vector2(0.0f, 1.0f); }
+    static constexpr Vector2 left() { return Vector2(-1.0f, 0.0f); }
+    static constexpr Vector2 right() { return Vector2(1.0f, 0.0f); }
 
     // For grid-based pathfinding (Manhattan distance)
-    int manhattanDistance(const Vector2& other) const;
+    int manhattanDistance(const Vector2& other) const {
+        return static_cast<int>(std::abs(x - other.x) + std::abs(y - other.y));
+    }
 };
@@ -2,35 +2,74 @@
 
 #include <cmath>
 
+// Header-only like Vector2
 class Vector3 {
 public:
     float x, y, z;
 
-    Vector3();
-    Vector3(float x, float y, float z);
+    constexpr Vector3() : x(0.0f), y(0.0f), z(0.0f) {}
+    constexpr Vector3(float x, float y, float z) : x(x), y(y), z(z) {}
 
     // Operators
-    Vector3 operator+(const Vector3& other) const;
-    Vector3 operator-(const Vector3& other) const;
-    Vector3 operator*(float scalar) const;
-    Vector3 operator/(float scalar) const;
+    constexpr Vector3 operator+(const Vector3& other) const { return Vector3(x + other.x, y + other.y, z + other.z); }
+    constexpr Vector3 operator-(const Vector3& other) const { return Vector3(x - other.x, y - other.y, z - other.z); }
+    constexpr Vector3 operator*(float scalar) const { return Vector3(x * scalar, y * scalar, z * scalar); }
+    constexpr Vector3 operator/(float scalar) const { return Vector3(x / scalar, y / scalar, z / scalar); }
 
-    Vector3& operator+=(const Vector3& other);
-    Vector3& operator-=(const Vector3& other);
-    Vector3& operator*=(float scalar);
-    Vector3& operator/=(float scalar);
+    constexpr Vector3& operator+=(const Vector3& other) {
+        x += other.x;
+        y += other.y;
+        z += other.z;
+        return *this;
+    }
 
-    bool operator==(const Vector3& other) const;
+    constexpr Vector3& operator-=(const Vector3& other) {
+        x -= other.x;
+        y -= other.y;
+        z -= other.z;
+        return *this;
+    }
+
+    constexpr Vector3& operator*=(float scalar) {
+        x *= scalar;
+        y *= scalar;
+        z *= scalar;
+        return *this;
+    }
+
+    constexpr Vector3& operator/=(float scalar) {
+        x /= scalar;
+        y /= scalar;
+        z /= scalar;
+        return *this;
+    }
+
+    constexpr bool operator==(const Vector3& other) const { return x == other.x && y == other.y && z == other.z; }
 
     // Utility functions
-    float magnitude() const;
-    float magnitudeSquared() const;
-    Vector3 normalized() const;
-    float distance(const Vector3& other) const;
-    float dot(const Vector3& other) const;
-    Vector3 cross(const Vector3& other) const;
+    float magnitude() const { return std::sqrt(x * x + y * y + z * z); }
+    constexpr float magnitudeSquared() const { return x * x + y * y + z * z; }
+
+    Vector3 normalized() const {
+        float mag = magnitude();
+        if (mag == 0.0f) return Vector3::zero();
+        return *this / mag;
+    }
+
+    float distance(const Vector3& other) const { return (*this - other).magnitude(); }
+    constexpr float distanceSquared(const Vector3& other) const { return (*this - other).magnitudeSquared(); }
+
+    constexpr bool isWithin(const Vector3& other, float range) const {
+        return distanceSquared(other) <= range * range;
+    }
+
+    constexpr float dot(const Vector3& other) const { return x * other.x + y * other.y + z * other.z; }
+
+    constexpr Vector3 cross(const Vector3& other) const {
+        return Vector3(y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x);
+    }
 
     // Static functions
-    static Vector3 zero();
-    static Vector3 one();
+    static constexpr Vector3 zero() { return Vector3(0.0f, 0.0f, 0.0f); }
+    static constexpr Vector3 one() { return Vector3(1.0f, 1.0f, 1.0f); }
 };
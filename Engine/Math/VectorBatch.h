@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "Vector2.h"
+
+// N points held as separate x and y lanes. Each operation is a plain loop over
+// aligned arrays, which the compiler turns into one SIMD instruction per
+// register: Vec2x4 fills an SSE register, Vec2x8 an AVX one.
+template <std::size_t N>
+struct Vec2Batch {
+    static constexpr std::size_t LANES = N;
+
+    alignas(sizeof(float) * N) float x[N] = {};
+    alignas(sizeof(float) * N) float y[N] = {};
+
+    static constexpr Vec2Batch broadcast(Vector2 v) {
+        Vec2Batch result;
+        for (std::size_t i = 0; i < N; ++i) {
+            result.x[i] = v.x;
+            result.y[i] = v.y;
+        }
+        return result;
+    }
+
+    // N points from structure-of-arrays storage
+    static constexpr Vec2Batch load(const float* xs, const float* ys) {
+        Vec2Batch result;
+        for (std::size_t i = 0; i < N; ++i) {
+            result.x[i] = xs[i];
+            result.y[i] = ys[i];
+        }
+        return result;
+    }
+
+    constexpr Vector2 get(std::size_t lane) const { return Vector2(x[lane], y[lane]); }
+
+    constexpr void set(std::size_t lane, Vector2 v) {
+        x[lane] = v.x;
+        y[lane] = v.y;
+    }
+
+    constexpr Vec2Batch operator+(const Vec2Batch& other) const {
+        Vec2Batch result;
+        for (std::size_t i = 0; i < N; ++i) {
+            result.x[i] = x[i] + other.x[i];
+            result.y[i] = y[i] + other.y[i];
+        }
+        return result;
+    }
+
+    constexpr Vec2Batch operator-(const Vec2Batch& other) const {
+        Vec2Batch result;
+        for (std::size_t i = 0; i < N; ++i) {
+            result.x[i] = x[i] - other.x[i];
+            result.y[i] = y[i] - other.y[i];
+        }
+        return result;
+    }
+
+    constexpr Vec2Batch operator*(float scalar) const {
+        Vec2Batch result;
+        for (std::size_t i = 0; i < N; ++i) {
+            result.x[i] = x[i] * scalar;
+            result.y[i] = y[i] * scalar;
+        }
+        return result;
+    }
+
+    constexpr void dot(const Vec2Batch& other, float (&out)[N]) const {
+        for (std::size_t i = 0; i < N; ++i) {
+            out[i] = x[i] * other.x[i] + y[i] * other.y[i];
+        }
+    }
+
+    constexpr void distanceSquared(Vector2 point, float (&out)[N]) const {
+        for (std::size_t i = 0; i < N; ++i) {
+            float dx = x[i] - point.x;
+            float dy = y[i] - point.y;
+            out[i] = dx * dx + dy * dy;
+        }
+    }
+
+    // Bit i set when lane i lies within range of point
+    constexpr std::uint32_t maskWithin(Vector2 point, float range) const {
+        float distances[N] = {};
+        distanceSquared(point, distances);
+        const float rangeSq = range * range;
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < N; ++i) {
+            mask |= static_cast<std::uint32_t>(distances[i] <= rangeSq) << i;
+        }
+        return mask;
+    }
+};
+
+using Vec2x4 = Vec2Batch<4>;
+using Vec2x8 = Vec2Batch<8>;
@@ -0,0 +1,240 @@
+#include "DStarLite.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const std::int64_t INFINITE_COST = std::numeric_limits<std::int64_t>::max() / 4;
+const float COST_SCALE = 1024.0f;  // Fixed-point units per unit of terrain cost
+const int NEIGHBOR_DX[] = {0, 1, 0, -1};
+const int NEIGHBOR_DY[] = {-1, 0, 1, 0};
+}  // namespace
+
+DStarLite::DStarLite(int goalCell, MovementClass movementClass)
+    : goalCell(goalCell), movementClass(movementClass) {}
+
+bool DStarLite::initialize(const NavGrid& grid, int start) {
+    nodes.clear();
+    open = decltype(open)();
+    explored = GridRect();
+    keyModifier = 0;
+    heuristicScale = grid.getMinStepCost(movementClass);
+    heuristicStep = static_cast<Cost>(std::floor(heuristicScale * COST_SCALE));
+    startCell = lastStartCell = start;
+    explored.include(start % grid.getWidth(), start / grid.getWidth());
+
+    Node& goal = getNode(grid, goalCell);
+    goal.rhs = 0;
+    push(grid, goalCell, goal);
+
+    return computeShortestPath(grid);
+}
+
+void DStarLite::moveStart(const NavGrid& grid, int start) {
+    if (start == startCell) {
+        return;
+    }
+
+    // Keys already queued were computed against the old start; shift new ones instead of re-keying
+    keyModifier += heuristic(grid, lastStartCell, start);
+    startCell = lastStartCell = start;
+    explored.include(start % grid.getWidth(), start / grid.getWidth());
+}
+
+void DStarLite::notifyChanged(const NavGrid& grid, const GridRect& region) {
+    const int width = grid.getWidth();
+    for (int y = std::max(0, region.minY); y <= std::min(grid.getHeight() - 1, region.maxY); ++y) {
+        for (int x = std::max(0, region.minX); x <= std::min(width - 1, region.maxX); ++x) {
+            // Only edges into the cell changed; they matter only if the search has reached it
+            if (nodes.find(y * width + x) == nodes.end()) continue;
+
+            for (int i = 0; i < 4; ++i) {
+                int nx = x + NEIGHBOR_DX[i];
+                int ny = y + NEIGHBOR_DY[i];
+                if (grid.isInBounds(nx, ny)) {
+                    updateVertex(grid, ny * width + nx);
+                }
+            }
+        }
+    }
+}
+
+bool DStarLite::computeShortestPath(const NavGrid& grid) {
+    const int width = grid.getWidth();
+    QueueEntry top;
+    while (peekTop(top)) {
+        if (!(top.key < calculateKey(grid, startCell)) && getRhs(startCell) <= getG(startCell)) {
+            break;
+        }
+        open.pop();
+
+        Node& node = nodes[top.cell];
+        Key newKey = calculateKey(grid, top.cell);
+        if (top.key < newKey) {
+            // Stale key from before the start moved
+            node.key = newKey;
+            open.push({newKey, top.cell});
+            continue;
+        }
+
+        ++expanded;
+        if (node.g > node.rhs) {
+            node.g = node.rhs;
+            node.open = false;
+        } else {
+            node.g = INFINITE_COST;
+            updateVertex(grid, top.cell);
+        }
+
+        int x = top.cell % width;
+        int y = top.cell / width;
+        for (int i = 0; i < 4; ++i) {
+            int nx = x + NEIGHBOR_DX[i];
+            int ny = y + NEIGHBOR_DY[i];
+            if (grid.isInBounds(nx, ny)) {
+                updateVertex(grid, ny * width + nx);
+            }
+        }
+    }
+
+    // The start itself may stay overconsistent; its rhs is already the settled cost
+    return getRhs(startCell) < INFINITE_COST;
+}
+
+bool DStarLite::extractPath(const NavGrid& grid, std::vector<int>& cells) const {
+    cells.clear();
+    if (getRhs(startCell) == INFINITE_COST) {
+        return false;
+    }
+
+    const int width = grid.getWidth();
+    int cell = startCell;
+    cells.push_back(cell);
+    for (std::size_t steps = 0; cell != goalCell; ++steps) {
+        if (steps > nodes.size()) {
+            return false;  // Values are inconsistent; never loop forever
+        }
+
+        int x = cell % width;
+        int y = cell / width;
+        int best = -1;
+        Cost bestCost = INFINITE_COST;
+        for (int i = 0; i < 4; ++i) {
+            int nx = x + NEIGHBOR_DX[i];
+            int ny = y + NEIGHBOR_DY[i];
+            if (!grid.isInBounds(nx, ny)) continue;
+
+            int neighbor = ny * width + nx;
+            if (!grid.isPassable(nx, ny, movementClass)) continue;
+
+            Cost cost = getStepCost(grid, nx, ny) + getG(neighbor);
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = neighbor;
+            }
+        }
+        if (best < 0) {
+            return false;
+        }
+
+        cell = best;
+        cells.push_back(cell);
+    }
+    return true;
+}
+
+float DStarLite::getPathCost() const {
+    Cost cost = getRhs(startCell);
+    return cost >= INFINITE_COST ? std::numeric_limits<float>::infinity() : static_cast<float>(cost) / COST_SCALE;
+}
+
+DStarLite::Cost DStarLite::getG(int cell) const {
+    auto it = nodes.find(cell);
+    return it != nodes.end() ? it->second.g : INFINITE_COST;
+}
+
+DStarLite::Cost DStarLite::getRhs(int cell) const {
+    auto it = nodes.find(cell);
+    return it != nodes.end() ? it->second.rhs : INFINITE_COST;
+}
+
+DStarLite::Node& DStarLite::getNode(const NavGrid& grid, int cell) {
+    auto it = nodes.find(cell);
+    if (it != nodes.end()) {
+        return it->second;
+    }
+
+    explored.include(cell % grid.getWidth(), cell / grid.getWidth());
+    Node& node = nodes[cell];
+    node.g = INFINITE_COST;
+    node.rhs = INFINITE_COST;
+    return node;
+}
+
+DStarLite::Cost DStarLite::getStepCost(const NavGrid& grid, int x, int y) const {
+    return static_cast<Cost>(std::lround(grid.getStepCost(x, y, movementClass) * COST_SCALE));
+}
+
+DStarLite::Key DStarLite::calculateKey(const NavGrid& grid, int cell) const {
+    Cost best = std::min(getG(cell), getRhs(cell));
+    return Key{best + heuristic(grid, startCell, cell) + keyModifier, best};
+}
+
+DStarLite::Cost DStarLite::heuristic(const NavGrid& grid, int fromCell, int toCell) const {
+    const int width = grid.getWidth();
+    int distance = std::abs(fromCell % width - toCell % width) + std::abs(fromCell / width - toCell / width);
+    return static_cast<Cost>(distance) * heuristicStep;
+}
+
+void DStarLite::updateVertex(const NavGrid& grid, int cell) {
+    Cost rhs = 0;
+    if (cell != goalCell) {
+        // Cost to goal through the cheapest neighbour; entering a cell costs its terrain
+        const int width = grid.getWidth();
+        int x = cell % width;
+        int y = cell / width;
+        rhs = INFINITE_COST;
+        for (int i = 0; i < 4; ++i) {
+            int nx = x + NEIGHBOR_DX[i];
+            int ny = y + NEIGHBOR_DY[i];
+            if (!grid.isInBounds(nx, ny)) continue;
+
+            int neighbor = ny * width + nx;
+            Cost g = getG(neighbor);
+            if (g >= INFINITE_COST || !grid.isPassable(nx, ny, movementClass)) continue;
+            rhs = std::min(rhs, getStepCost(grid, nx, ny) + g);
+        }
+    }
+
+    auto it = nodes.find(cell);
+    if (it == nodes.end() && rhs == INFINITE_COST) {
+        return;  // Untouched and still unreachable
+    }
+
+    Node& node = it != nodes.end() ? it->second : getNode(grid, cell);
+    node.rhs = rhs;
+    if (node.g != node.rhs) {
+        push(grid, cell, node);
+    } else {
+        node.open = false;
+    }
+}
+
+void DStarLite::push(const NavGrid& grid, int cell, Node& node) {
+    node.key = calculateKey(grid, cell);
+    node.open = true;
+    open.push({node.key, cell});
+}
+
+bool DStarLite::peekTop(QueueEntry& entry) {
+    while (!open.empty()) {
+        const QueueEntry& top = open.top();
+        auto it = nodes.find(top.cell);
+        if (it != nodes.end() && it->second.open && !(it->second.key < top.key) && !(top.key < it->second.key)) {
+            entry = top;
+            return true;
+        }
+        open.pop();
+    }
+    return false;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+#include "NavGrid.h"
+#include "MovementClass.h"
+
+// Incremental planner for one long-lived route (D* Lite, Koenig & Likhachev).
+// Searches backwards from the goal cell and keeps its cost-to-goal values, so
+// after a grid change only the cells around the change are re-expanded. Node
+// state is sparse: only cells the search has touched are stored.
+//
+// Costs are fixed point internally: with fractional terrain costs, float sums
+// that are equal on paper differ in the last bit, and D* Lite's stop test
+// depends on exact key ties.
+class DStarLite {
+public:
+    DStarLite(int goalCell, MovementClass movementClass);
+
+    // Search from scratch towards startCell on the grid
+    bool initialize(const NavGrid& grid, int startCell);
+
+    // The unit has moved; call before notifyChanged/computeShortestPath
+    void moveStart(const NavGrid& grid, int startCell);
+
+    // Cells in the region changed passability or cost since the last repair
+    void notifyChanged(const NavGrid& grid, const GridRect& region);
+
+    // Re-expand inconsistent cells until the start is settled; false if unreachable
+    bool computeShortestPath(const NavGrid& grid);
+
+    // Row-major cells from the start to the goal following the cost-to-goal values
+    bool extractPath(const NavGrid& grid, std::vector<int>& cells) const;
+
+    int getGoalCell() const { return goalCell; }
+    int getStartCell() const { return startCell; }
+    MovementClass getMovementClass() const { return movementClass; }
+    float getHeuristicScale() const { return heuristicScale; }
+
+    // Bounding box of every cell the search has touched
+    const GridRect& getExploredBounds() const { return explored; }
+
+    // Cost from the start cell to the goal; infinite if unreachable
+    float getPathCost() const;
+
+    std::size_t getNodeCount() const { return nodes.size(); }
+    std::uint64_t getExpandedCount() const { return expanded; }
+
+private:
+    using Cost = std::int64_t;
+
+    struct Key {
+        Cost primary = 0;
+        Cost secondary = 0;
+
+        bool operator<(const Key& other) const {
+            return primary < other.primary || (primary == other.primary && secondary < other.secondary);
+        }
+    };
+
+    struct Node {
+        Cost g;
+        Cost rhs;
+        Key key;
+        bool open = false;
+    };
+
+    struct QueueEntry {
+        Key key;
+        int cell = 0;
+
+        bool operator>(const QueueEntry& other) const { return other.key < key; }
+    };
+
+    Cost getG(int cell) const;
+    Cost getRhs(int cell) const;
+    Cost getStepCost(const NavGrid& grid, int x, int y) const;
+    Node& getNode(const NavGrid& grid, int cell);
+    Key calculateKey(const NavGrid& grid, int cell) const;
+    Cost heuristic(const NavGrid& grid, int fromCell, int toCell) const;
+    void updateVertex(const NavGrid& grid, int cell);
+    void push(const NavGrid& grid, int cell, Node& node);
+    bool peekTop(QueueEntry& entry);
+
+    int goalCell;
+    int startCell = -1;
+    int lastStartCell = -1;
+    MovementClass movementClass;
+    float heuristicScale = 1.0f;
+    Cost heuristicStep = 0;
+    Cost keyModifier = 0;  // k_m: heuristic drift from start moves
+    std::uint64_t expanded = 0;
+    GridRect explored;
+
+    std::unordered_map<int, Node> nodes;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> open;  // Lazy deletion
+};
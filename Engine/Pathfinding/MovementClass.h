@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// How a unit interacts with the nav grid. Each class has its own passability
+// mask and terrain cost table.
+enum class MovementClass : std::uint8_t {
+    Infantry,  // Workers, soldiers
+    Light,     // Scouts: fast over rough ground
+    Heavy,     // Tanks: need a wide corridor, bog down in mud
+    Count
+};
+
+enum class TerrainType : std::uint8_t {
+    Open,
+    Road,
+    Rough,
+    Mud,
+    Count
+};
+
+constexpr int MOVEMENT_CLASS_COUNT = static_cast<int>(MovementClass::Count);
+constexpr int TERRAIN_TYPE_COUNT = static_cast<int>(TerrainType::Count);
@@ -0,0 +1,231 @@
+#include "NavGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+//                                                    Open  Road  Rough  Mud
+const float NavGrid::TERRAIN_COSTS[MOVEMENT_CLASS_COUNT][TERRAIN_TYPE_COUNT] = {
+    /* Infantry */                                  { 1.0f, 0.6f, 2.0f,  3.0f },
+    /* Light    */                                  { 1.0f, 0.6f, 1.4f,  3.0f },
+    /* Heavy    */                                  { 1.0f, 0.5f, 2.5f,  0.0f },  // Mud impassable
+};
+
+namespace {
+bool isTerrainPassable(MovementClass movementClass, TerrainType type) {
+    return !(movementClass == MovementClass::Heavy && type == TerrainType::Mud);
+}
+}  // namespace
+
+NavGrid::NavGrid(int width, int height, float cellSize)
+    : width(width), height(height), cellSize(cellSize),
+      cells(width, height, packCell(MAX_CLEARANCE, TerrainType::Open)) {
+    terrainCounts[static_cast<int>(TerrainType::Open)] = width * height;
+}
+
+float NavGrid::getMinStepCost(MovementClass movementClass) const {
+    float minCost = 0.0f;
+    for (int type = 0; type < TERRAIN_TYPE_COUNT; ++type) {
+        if (terrainCounts[type] == 0 || !isTerrainPassable(movementClass, static_cast<TerrainType>(type))) {
+            continue;
+        }
+        float cost = TERRAIN_COSTS[static_cast<int>(movementClass)][type];
+        if (minCost == 0.0f || cost < minCost) {
+            minCost = cost;
+        }
+    }
+    return minCost > 0.0f ? minCost : 1.0f;
+}
+
+int NavGrid::getRequiredClearance(MovementClass movementClass) {
+    // Tanks are wider than half a cell, so they need a free ring around their cell
+    return movementClass == MovementClass::Heavy ? 2 : 1;
+}
+
+bool NavGrid::setBlocked(int x, int y, bool isBlocked) {
+    if (!isInBounds(x, y) || this->isBlocked(x, y) == isBlocked) {
+        return false;
+    }
+
+    int cell = y * width + x;
+    auto it = std::lower_bound(blockedCells.begin(), blockedCells.end(), cell);
+    if (isBlocked) {
+        blockedCells.insert(it, cell);
+    } else {
+        blockedCells.erase(it);
+    }
+
+    cells.at(x, y) = packCell(isBlocked ? 0 : MAX_CLEARANCE, getTerrain(x, y));
+    refreshAround(x, y);
+    GridRect changed;
+    changed.include(x, y);
+    markChanged(changed);
+    return true;
+}
+
+bool NavGrid::assignBlocked(const std::vector<std::uint8_t>& blockedLayer) {
+    if (blockedLayer.size() != static_cast<std::size_t>(width) * height) {
+        return false;
+    }
+
+    std::vector<int> sortedCells;
+    for (std::size_t i = 0; i < blockedLayer.size(); ++i) {
+        if (blockedLayer[i]) {
+            sortedCells.push_back(static_cast<int>(i));
+        }
+    }
+    return assignBlockedCells(sortedCells);
+}
+
+bool NavGrid::assignBlockedCells(const std::vector<int>& sortedCells) {
+    // Merge the old and new sorted lists; cells in only one of them flipped
+    std::vector<int> flipped;
+    std::set_symmetric_difference(blockedCells.begin(), blockedCells.end(), sortedCells.begin(), sortedCells.end(),
+                                  std::back_inserter(flipped));
+    if (flipped.empty()) {
+        return false;
+    }
+
+    blockedCells = sortedCells;
+
+    // Settle the flipped cells first so the clearance pass can read obstacles straight off the grid
+    for (int cell : flipped) {
+        int x = cell % width;
+        int y = cell / width;
+        cells.at(x, y) = packCell(isBlocked(x, y) ? MAX_CLEARANCE : 0, getTerrain(x, y));
+    }
+
+    GridRect changed;
+    for (int cell : flipped) {
+        int x = cell % width;
+        int y = cell / width;
+        refreshAround(x, y);
+        changed.include(x, y);
+    }
+    markChanged(changed);
+    return true;
+}
+
+bool NavGrid::fillTerrain(const GridRect& area, TerrainType type) {
+    GridRect changed;
+    for (int y = std::max(0, area.minY); y <= std::min(height - 1, area.maxY); ++y) {
+        for (int x = std::max(0, area.minX); x <= std::min(width - 1, area.maxX); ++x) {
+            TerrainType previous = getTerrain(x, y);
+            if (previous == type) {
+                continue;
+            }
+            --terrainCounts[static_cast<int>(previous)];
+            ++terrainCounts[static_cast<int>(type)];
+            cells.at(x, y) = packCell(getClearance(x, y), type);
+            changed.include(x, y);
+        }
+    }
+    if (changed.isEmpty()) {
+        return false;
+    }
+
+    markChanged(changed);
+    return true;
+}
+
+void NavGrid::clear() {
+    assignBlockedCells({});
+}
+
+bool NavGrid::findNearestPassableCell(int& x, int& y, MovementClass movementClass, int maxRadius) const {
+    if (isInBounds(x, y) && isPassable(x, y, movementClass)) {
+        return true;
+    }
+
+    for (int radius = 1; radius <= maxRadius; ++radius) {
+        int bestX = 0, bestY = 0, bestDistance = -1;
+        for (int dy = -radius; dy <= radius; ++dy) {
+            for (int dx = -radius; dx <= radius; ++dx) {
+                if (std::abs(dx) != radius && std::abs(dy) != radius) continue;  // Ring only
+                int cx = x + dx, cy = y + dy;
+                if (!isInBounds(cx, cy) || !isPassable(cx, cy, movementClass)) continue;
+                int distance = dx * dx + dy * dy;
+                if (bestDistance < 0 || distance < bestDistance) {
+                    bestX = cx;
+                    bestY = cy;
+                    bestDistance = distance;
+                }
+            }
+        }
+        if (bestDistance >= 0) {
+            x = bestX;
+            y = bestY;
+            return true;
+        }
+    }
+    return false;
+}
+
+int NavGrid::worldToCellX(float worldX) const {
+    return static_cast<int>(std::floor(worldX / cellSize));
+}
+
+int NavGrid::worldToCellY(float worldY) const {
+    return static_cast<int>(std::floor(worldY / cellSize));
+}
+
+Vector2 NavGrid::cellToWorld(int x, int y) const {
+    return Vector2(x * cellSize + cellSize / 2.0f,
+                   y * cellSize + cellSize / 2.0f);
+}
+
+std::uint8_t NavGrid::packCell(int clearance, TerrainType terrain) {
+    std::uint8_t passableBits = 0;
+    for (int cls = 0; cls < MOVEMENT_CLASS_COUNT; ++cls) {
+        auto movementClass = static_cast<MovementClass>(cls);
+        if (clearance >= getRequiredClearance(movementClass) && isTerrainPassable(movementClass, terrain)) {
+            passableBits |= static_cast<std::uint8_t>(1u << cls);
+        }
+    }
+    return static_cast<std::uint8_t>(passableBits | (clearance << CLEARANCE_SHIFT) |
+                                     (static_cast<int>(terrain) << TERRAIN_SHIFT));
+}
+
+void NavGrid::refreshAround(int x, int y) {
+    // Clearance is saturated, so a flip only reaches the rings below MAX_CLEARANCE
+    const int reach = MAX_CLEARANCE - 1;
+    for (int cy = std::max(0, y - reach); cy <= std::min(height - 1, y + reach); ++cy) {
+        for (int cx = std::max(0, x - reach); cx <= std::min(width - 1, x + reach); ++cx) {
+            refreshCell(cx, cy);
+        }
+    }
+}
+
+void NavGrid::refreshCell(int x, int y) {
+    int clearance = MAX_CLEARANCE;
+    if (isBlocked(x, y)) {
+        clearance = 0;
+    } else {
+        // Nearest obstacle ring by Chebyshev distance; off-map counts as open ground
+        for (int ring = 1; ring < MAX_CLEARANCE && clearance == MAX_CLEARANCE; ++ring) {
+            for (int cy = std::max(0, y - ring); cy <= std::min(height - 1, y + ring); ++cy) {
+                for (int cx = std::max(0, x - ring); cx <= std::min(width - 1, x + ring); ++cx) {
+                    if (std::max(std::abs(cx - x), std::abs(cy - y)) == ring && isBlocked(cx, cy)) {
+                        clearance = ring;
+                    }
+                }
+            }
+        }
+    }
+
+    std::uint8_t packed = packCell(clearance, getTerrain(x, y));
+    if (cells.get(x, y) != packed) {
+        cells.at(x, y) = packed;  // Only cells that differ from open ground allocate their chunk
+    }
+}
+
+void NavGrid::markChanged(GridRect region) {
+    // Clearance spreads an obstacle change over the rings a wide unit needs
+    int spread = MAX_CLEARANCE - 1;
+    region.minX = std::max(0, region.minX - spread);
+    region.minY = std::max(0, region.minY - spread);
+    region.maxX = std::min(width - 1, region.maxX + spread);
+    region.maxY = std::min(height - 1, region.maxY + spread);
+
+    lastChangedRegion = region;
+    ++version;
+}
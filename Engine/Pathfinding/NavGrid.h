@@ -0,0 +1,157 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "../Math/Vector2.h"
+#include "../Core/ChunkedGrid.h"
+#include "MovementClass.h"
+
+// Inclusive cell rectangle
+struct GridRect {
+    int minX = 0;
+    int minY = 0;
+    int maxX = -1;
+    int maxY = -1;
+
+    bool isEmpty() const { return maxX < minX || maxY < minY; }
+
+    bool intersects(const GridRect& other) const {
+        return !isEmpty() && !other.isEmpty() &&
+               minX <= other.maxX && other.minX <= maxX &&
+               minY <= other.maxY && other.minY <= maxY;
+    }
+
+    void include(int x, int y) {
+        if (isEmpty()) {
+            minX = maxX = x;
+            minY = maxY = y;
+            return;
+        }
+        if (x < minX) minX = x;
+        if (x > maxX) maxX = x;
+        if (y < minY) minY = y;
+        if (y > maxY) maxY = y;
+    }
+};
+
+// Walkability data for the pathfinding grid. Kept separate from Pathfinder so
+// worker threads can search an immutable copy while the live grid keeps changing.
+//
+// One byte per cell packs the terrain, the clearance (Chebyshev distance to the
+// nearest obstacle, saturated at what the widest class needs) and a passable bit
+// per movement class. Cells live in a ChunkedGrid: open ground costs nothing
+// until something is built or painted on it, and copies share untouched chunks,
+// so maps up to 4096x4096 cells stay cheap to hold and to snapshot.
+class NavGrid {
+public:
+    NavGrid(int width, int height, float cellSize);
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    float getCellSize() const { return cellSize; }
+
+    bool isInBounds(int x, int y) const {
+        return x >= 0 && x < width && y >= 0 && y < height;
+    }
+
+    bool isBlocked(int x, int y) const {
+        return getClearance(x, y) == 0;
+    }
+
+    // Branch-free per-class queries; prefer the (x, y) forms in hot loops, the
+    // row-major cell forms divide by the width
+    bool isPassable(int x, int y, MovementClass movementClass) const {
+        return ((cells.get(x, y) >> static_cast<int>(movementClass)) & 1u) != 0;
+    }
+
+    bool isPassable(int cell, MovementClass movementClass) const {
+        return isPassable(cell % width, cell / width, movementClass);
+    }
+
+    float getStepCost(int x, int y, MovementClass movementClass) const {
+        return TERRAIN_COSTS[static_cast<int>(movementClass)][cells.get(x, y) >> TERRAIN_SHIFT];
+    }
+
+    float getStepCost(int cell, MovementClass movementClass) const {
+        return getStepCost(cell % width, cell / width, movementClass);
+    }
+
+    // Cheapest step cost present on the map, keeps the A* heuristic admissible
+    float getMinStepCost(MovementClass movementClass) const;
+
+    TerrainType getTerrain(int x, int y) const {
+        return static_cast<TerrainType>(cells.get(x, y) >> TERRAIN_SHIFT);
+    }
+
+    // 0 on obstacles, 1 next to one, MAX_CLEARANCE anywhere further away
+    std::uint8_t getClearance(int x, int y) const {
+        return (cells.get(x, y) >> CLEARANCE_SHIFT) & CLEARANCE_MASK;
+    }
+
+    // Clearance (in cells) a class needs around its cell
+    static int getRequiredClearance(MovementClass movementClass);
+
+    // Returns true if the cell changed
+    bool setBlocked(int x, int y, bool isBlocked);
+
+    // Replace every cell at once; bumps the version only when something changed
+    bool assignBlocked(const std::vector<std::uint8_t>& blockedLayer);
+
+    // Same, from the sorted, unique row-major indices of every obstacle cell.
+    // Cost scales with the number of obstacles, not the map size.
+    bool assignBlockedCells(const std::vector<int>& sortedCells);
+
+    const std::vector<int>& getBlockedCells() const { return blockedCells; }
+
+    // Chunks holding anything but open ground
+    std::size_t getAllocatedChunkCount() const { return cells.getAllocatedChunkCount(); }
+
+    // Paint terrain over an inclusive cell rectangle
+    bool fillTerrain(const GridRect& area, TerrainType type);
+
+    void clear();
+
+    // Move (x, y) to the closest cell passable for the class within maxRadius rings; false if none
+    bool findNearestPassableCell(int& x, int& y, MovementClass movementClass, int maxRadius) const;
+
+    // Incremented on every change to the walkability data
+    std::uint64_t getVersion() const { return version; }
+
+    // Cells whose passability may have changed in the most recent change
+    const GridRect& getLastChangedRegion() const { return lastChangedRegion; }
+
+    // Cell <-> world conversion
+    int worldToCellX(float worldX) const;
+    int worldToCellY(float worldY) const;
+    Vector2 cellToWorld(int x, int y) const;
+
+    static constexpr int MAX_CLEARANCE = 2;
+
+private:
+    // Cell byte: bits 0-2 passable per movement class, bits 3-4 clearance, bits 5-6 terrain
+    static constexpr int CLEARANCE_SHIFT = 3;
+    static constexpr int TERRAIN_SHIFT = 5;
+    static constexpr std::uint8_t CLEARANCE_MASK = 0x3;
+    static_assert(MOVEMENT_CLASS_COUNT <= CLEARANCE_SHIFT, "passable bits overflow into clearance");
+    static_assert(MAX_CLEARANCE <= CLEARANCE_MASK, "clearance does not fit its bits");
+    static_assert(TERRAIN_TYPE_COUNT <= 4, "terrain does not fit its bits");
+
+    // Per class, per terrain step cost; impassable terrain is masked out of the passable bits
+    static const float TERRAIN_COSTS[MOVEMENT_CLASS_COUNT][TERRAIN_TYPE_COUNT];
+
+    static std::uint8_t packCell(int clearance, TerrainType terrain);
+
+    int width, height;
+    float cellSize;
+    std::uint64_t version = 0;
+    GridRect lastChangedRegion;
+    ChunkedGrid<std::uint8_t> cells;
+    std::vector<int> blockedCells;  // Sorted row-major obstacle cells
+    int terrainCounts[TERRAIN_TYPE_COUNT] = {};
+
+    // Recompute clearance and passability around cells whose obstacle state flipped;
+    // the flipped cells themselves must already read as blocked or not
+    void refreshAround(int x, int y);
+    void refreshCell(int x, int y);
+    void markChanged(GridRect region);
+};
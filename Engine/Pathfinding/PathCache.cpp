@@ -0,0 +1,82 @@
+#include "PathCache.h"
+#include <algorithm>
+
+PathCache::PathCache(std::size_t capacity) : capacity(std::max<std::size_t>(1, capacity)) {}
+
+bool PathCache::lookup(int startCell, int goalCell, MovementClass movementClass, std::uint64_t gridVersion,
+                       std::vector<Vector2>& waypoints) {
+    auto it = index.find(makeKey(startCell, goalCell, movementClass));
+    if (it == index.end() || it->second->gridVersion != gridVersion) {
+        ++stats.misses;
+        return false;
+    }
+
+    entries.splice(entries.begin(), entries, it->second);
+    waypoints = it->second->waypoints;
+    ++stats.hits;
+    return true;
+}
+
+void PathCache::insert(int startCell, int goalCell, MovementClass movementClass, std::uint64_t gridVersion,
+                       const std::vector<Vector2>& waypoints, const GridRect& bounds) {
+    std::uint64_t key = makeKey(startCell, goalCell, movementClass);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        entries.splice(entries.begin(), entries, it->second);
+    } else {
+        entries.emplace_front();
+        index[key] = entries.begin();
+    }
+
+    Entry& entry = entries.front();
+    entry.key = key;
+    entry.gridVersion = gridVersion;
+    entry.bounds = bounds;
+    entry.waypoints = waypoints;
+    ++stats.insertions;
+
+    evictOverflow();
+}
+
+void PathCache::invalidateRegion(const GridRect& region, std::uint64_t gridVersion) {
+    for (auto it = entries.begin(); it != entries.end(); ) {
+        if (it->bounds.intersects(region)) {
+            index.erase(it->key);
+            it = entries.erase(it);
+            ++stats.invalidations;
+        } else {
+            // The route never crosses the changed cells, so it is still walkable
+            it->gridVersion = gridVersion;
+            ++it;
+        }
+    }
+}
+
+void PathCache::clear() {
+    entries.clear();
+    index.clear();
+}
+
+void PathCache::setCapacity(std::size_t newCapacity) {
+    capacity = std::max<std::size_t>(1, newCapacity);
+    evictOverflow();
+}
+
+void PathCache::resetStats() {
+    stats = PathCacheStats();
+}
+
+std::uint64_t PathCache::makeKey(int startCell, int goalCell, MovementClass movementClass) {
+    // 30 bits per cell index covers grids up to 32768 x 32768
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(startCell) & 0x3FFFFFFFu) << 34) |
+           (static_cast<std::uint64_t>(static_cast<std::uint32_t>(goalCell) & 0x3FFFFFFFu) << 4) |
+           static_cast<std::uint64_t>(movementClass);
+}
+
+void PathCache::evictOverflow() {
+    while (entries.size() > capacity) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+        ++stats.evictions;
+    }
+}
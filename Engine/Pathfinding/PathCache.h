@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include "../Math/Vector2.h"
+#include "NavGrid.h"
+#include "MovementClass.h"
+
+struct PathCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t insertions = 0;
+    std::uint64_t evictions = 0;
+    std::uint64_t invalidations = 0;
+
+    float hitRate() const {
+        std::uint64_t lookups = hits + misses;
+        return lookups > 0 ? static_cast<float>(hits) / static_cast<float>(lookups) : 0.0f;
+    }
+};
+
+// LRU cache of solved routes keyed by start cell, goal cell and movement class. Entries remember the
+// cells they cover so a grid change only drops the routes that cross it.
+class PathCache {
+public:
+    explicit PathCache(std::size_t capacity = 256);
+
+    // Cell-center turning points after the start cell, not including the goal
+    bool lookup(int startCell, int goalCell, MovementClass movementClass, std::uint64_t gridVersion,
+                std::vector<Vector2>& waypoints);
+    void insert(int startCell, int goalCell, MovementClass movementClass, std::uint64_t gridVersion,
+                const std::vector<Vector2>& waypoints, const GridRect& bounds);
+
+    // Drop every entry whose bounds touch the region; the rest move to the new version
+    void invalidateRegion(const GridRect& region, std::uint64_t gridVersion);
+    void clear();
+
+    void setCapacity(std::size_t capacity);
+    std::size_t getCapacity() const { return capacity; }
+    std::size_t size() const { return entries.size(); }
+
+    const PathCacheStats& getStats() const { return stats; }
+    void resetStats();
+
+private:
+    struct Entry {
+        std::uint64_t key = 0;
+        std::uint64_t gridVersion = 0;
+        GridRect bounds;
+        std::vector<Vector2> waypoints;
+    };
+
+    static std::uint64_t makeKey(int startCell, int goalCell, MovementClass movementClass);
+    void evictOverflow();
+
+    std::size_t capacity;
+    std::list<Entry> entries;  // Most recently used first
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+    PathCacheStats stats;
+};
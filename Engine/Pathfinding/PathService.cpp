@@ -0,0 +1,339 @@
+#include "PathService.h"
+#include "Pathfinder.h"
+#include "../ECS/ComponentRegistry.h"
+#include "../ECS/Component.h"
+#include <algorithm>
+
+namespace {
+std::uint64_t cellKey(const NavGrid& grid, Vector2 position) {
+    auto x = static_cast<std::uint32_t>(grid.worldToCellX(position.x));
+    auto y = static_cast<std::uint32_t>(grid.worldToCellY(position.y));
+    return (static_cast<std::uint64_t>(y) << 32) | x;
+}
+}  // namespace
+
+PathService::PathService(std::shared_ptr<Pathfinder> pathfinder, std::size_t workerCount)
+    : pathfinder(pathfinder), repairer(pathfinder) {
+    workerCount = std::max<std::size_t>(1, workerCount);
+    for (std::size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&PathService::workerLoop, this);
+    }
+}
+
+PathService::~PathService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void PathService::requestPath(EntityID entityId, Vector2 start, Vector2 goal, MovementClass movementClass,
+                              PathPriority priority) {
+    const NavGrid& grid = pathfinder->getGrid();
+    int goalX = grid.worldToCellX(goal.x);
+    int goalY = grid.worldToCellY(goal.y);
+
+    auto pendingIt = pending.find(entityId);
+    if (pendingIt != pending.end() && pendingIt->second.goalX == goalX && pendingIt->second.goalY == goalY &&
+        pendingIt->second.movementClass == movementClass) {
+        auto queuedIt = queued.find(entityId);
+        if (queuedIt != queued.end()) {
+            queuedIt->second.priority = std::max(queuedIt->second.priority, priority);
+        }
+        return;
+    }
+
+    // The new request supersedes whatever route is being repaired
+    repairer.forget(entityId);
+
+    Request request;
+    request.subscriber.entityId = entityId;
+    request.subscriber.serial = nextSerial++;
+    request.subscriber.goal = goal;
+    request.start = start;
+    request.movementClass = movementClass;
+    request.priority = priority;
+    request.order = nextOrder++;
+
+    queued[entityId] = request;
+    pending[entityId] = Pending{request.subscriber.serial, goalX, goalY, movementClass};
+}
+
+void PathService::requestMove(const std::shared_ptr<Entity>& entity, Vector2 goal, PathPriority priority) {
+    if (!entity) {
+        return;
+    }
+
+    auto transform = entity->getComponent<TransformComponent>();
+    auto movement = entity->getComponent<MovementComponent>();
+    auto path = entity->getComponent<PathComponent>();
+    if (!transform || !movement) {
+        return;
+    }
+    if (!path) {
+        movement->setTarget(goal);
+        return;
+    }
+
+    const NavGrid& grid = pathfinder->getGrid();
+    if (path->hasPath()) {
+        Vector2 end = path->waypoints.back();
+        if (grid.worldToCellX(end.x) == grid.worldToCellX(goal.x) &&
+            grid.worldToCellY(end.y) == grid.worldToCellY(goal.y)) {
+            return;
+        }
+    }
+
+    // Head straight for the goal until the solved path arrives on a later frame
+    path->waypoints = {goal};
+    path->currentIndex = 0;
+    movement->setTarget(goal);
+
+    requestPath(entity->getId(), transform->position, goal, movement->movementClass, priority);
+}
+
+void PathService::cancel(EntityID entityId) {
+    repairer.forget(entityId);
+    queued.erase(entityId);
+    pending.erase(entityId);
+}
+
+void PathService::update(ComponentRegistry& registry) {
+    dispatchRequests();
+    if (deterministic) {
+        waitForWorkers();
+    }
+    deliverResults(registry);
+    repairer.update(registry);
+}
+
+void PathService::setResultBudget(std::size_t budget) {
+    resultBudget = std::max<std::size_t>(1, budget);
+}
+
+std::size_t PathService::getResultBudget() const {
+    return resultBudget;
+}
+
+void PathService::setCornerSmoothing(int samplesPerSegment) {
+    cornerSamples = std::max(0, samplesPerSegment);
+}
+
+int PathService::getCornerSmoothing() const {
+    return cornerSamples;
+}
+
+bool PathService::isPending(EntityID entityId) const {
+    return pending.find(entityId) != pending.end();
+}
+
+std::size_t PathService::getPendingCount() const {
+    return pending.size();
+}
+
+bool PathService::JobCompare::operator()(const std::unique_ptr<Job>& a, const std::unique_ptr<Job>& b) const {
+    if (a->priority != b->priority) {
+        return a->priority < b->priority;
+    }
+    return a->order > b->order;
+}
+
+void PathService::workerLoop() {
+    for (;;) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this] { return stopping || !jobHeap.empty(); });
+            if (stopping) {
+                return;
+            }
+            std::pop_heap(jobHeap.begin(), jobHeap.end(), JobCompare());
+            job = std::move(jobHeap.back());
+            jobHeap.pop_back();
+            ++busyWorkers;
+        }
+
+        if (job->batch.empty()) {
+            job->waypoints = Pathfinder::findPath(*job->grid, job->start, job->goal, job->movementClass);
+        } else {
+            solveBatch(*job);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& member : job->batch) {
+            finished.push_back(std::move(member));
+        }
+        job->batch.clear();
+        finished.push_back(std::move(job));
+        if (--busyWorkers == 0 && jobHeap.empty()) {
+            workDone.notify_all();
+        }
+    }
+}
+
+void PathService::waitForWorkers() {
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this] { return jobHeap.empty() && busyWorkers == 0; });
+}
+
+void PathService::solveBatch(Job& job) {
+    // Workers already run in parallel, so each batch stays on its own thread
+    std::vector<PathRequest> requests;
+    std::vector<std::vector<Vector2>> results(job.batch.size() + 1);
+    requests.reserve(results.size());
+    requests.push_back({job.start, job.goal, job.movementClass});
+    for (const auto& member : job.batch) {
+        requests.push_back({member->start, member->goal, member->movementClass});
+    }
+
+    Pathfinder::findPaths(*job.grid, requests.data(), requests.size(), results.data());
+    job.waypoints = std::move(results[0]);
+    for (std::size_t i = 0; i < job.batch.size(); ++i) {
+        job.batch[i]->waypoints = std::move(results[i + 1]);
+    }
+}
+
+void PathService::dispatchRequests() {
+    if (queued.empty()) {
+        return;
+    }
+
+    std::vector<Request> requests;
+    requests.reserve(queued.size());
+    for (auto& [id, request] : queued) {
+        requests.push_back(request);
+    }
+    queued.clear();
+
+    std::sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) {
+        return a.order < b.order;
+    });
+
+    // Identical start/goal cells collapse into one job per movement class
+    auto grid = pathfinder->getSnapshot();
+    std::vector<std::unique_ptr<Job>> jobs;
+    std::unordered_map<std::uint64_t, std::unordered_map<std::uint64_t, Job*>> jobsByCells[MOVEMENT_CLASS_COUNT];
+    for (const auto& request : requests) {
+        auto& jobsForClass = jobsByCells[static_cast<int>(request.movementClass)];
+        Job*& job = jobsForClass[cellKey(*grid, request.start)][cellKey(*grid, request.subscriber.goal)];
+        if (!job) {
+            jobs.push_back(std::make_unique<Job>());
+            job = jobs.back().get();
+            job->grid = grid;
+            job->start = request.start;
+            job->goal = request.subscriber.goal;
+            job->movementClass = request.movementClass;
+            job->order = request.order;
+        }
+        job->priority = std::max(job->priority, request.priority);
+        job->subscribers.push_back(request.subscriber);
+    }
+
+    // Repeated trips are answered from the route cache without touching the workers;
+    // the rest are batched by goal cell so a wave heading one way costs one search
+    bool queuedWork = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unordered_map<std::uint64_t, Job*> leaders[MOVEMENT_CLASS_COUNT];
+        std::vector<std::unique_ptr<Job>> searches;
+        for (auto& job : jobs) {
+            if (pathfinder->findCachedPath(job->start, job->goal, job->movementClass, job->waypoints)) {
+                job->fromCache = true;
+                finished.push_back(std::move(job));
+                continue;
+            }
+
+            Job*& leader = leaders[static_cast<int>(job->movementClass)][cellKey(*grid, job->goal)];
+            if (leader) {
+                leader->priority = std::max(leader->priority, job->priority);
+                leader->batch.push_back(std::move(job));
+                continue;
+            }
+            leader = job.get();
+            searches.push_back(std::move(job));
+        }
+
+        for (auto& job : searches) {
+            jobHeap.push_back(std::move(job));
+            std::push_heap(jobHeap.begin(), jobHeap.end(), JobCompare());
+            queuedWork = true;
+        }
+    }
+    if (queuedWork) {
+        workAvailable.notify_all();
+    }
+}
+
+void PathService::deliverResults(ComponentRegistry& registry) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Workers finish in any order; hand results out in the order they were asked for
+        std::sort(finished.begin(), finished.end(), [](const std::unique_ptr<Job>& a, const std::unique_ptr<Job>& b) {
+            return a->order < b->order;
+        });
+        for (auto& job : finished) {
+            ready.push_back(std::move(job));
+        }
+        finished.clear();
+    }
+
+    // The cache keeps the string-pulled route, so a hit suits any smoothing
+    // setting; corners are rounded on the copy handed out
+    for (auto& job : ready) {
+        if (job->prepared) continue;  // Delivery may span frames
+        if (!job->fromCache) {
+            pathfinder->cachePath(*job->grid, job->start, job->goal, job->movementClass, job->waypoints);
+        }
+        if (cornerSamples > 0) {
+            PathSmoother::smoothCorners(*job->grid, job->waypoints, job->movementClass, cornerSamples);
+        }
+        job->prepared = true;
+    }
+
+    std::size_t delivered = 0;
+    while (!ready.empty() && delivered < resultBudget) {
+        Job& job = *ready.front();
+        const Subscriber& subscriber = job.subscribers[readyCursor++];
+        if (readyCursor >= job.subscribers.size()) {
+            readyCursor = 0;
+        }
+
+        auto pendingIt = pending.find(subscriber.entityId);
+        bool current = pendingIt != pending.end() && pendingIt->second.serial == subscriber.serial;
+        auto entity = current ? registry.getEntity(subscriber.entityId) : nullptr;
+
+        if (entity && !entity->isDestroyed()) {
+            auto movement = entity->getComponent<MovementComponent>();
+            auto path = entity->getComponent<PathComponent>();
+            if (movement && path) {
+                path->waypoints = job.waypoints;
+                if (path->waypoints.empty()) {
+                    path->waypoints.push_back(subscriber.goal);
+                } else {
+                    // Shared jobs end at the first subscriber's goal; finish at our own
+                    path->waypoints.back() = subscriber.goal;
+                }
+                path->currentIndex = 0;
+                movement->setTarget(path->waypoints.front());
+                if (auto transform = entity->getComponent<TransformComponent>()) {
+                    repairer.track(subscriber.entityId, transform->position, subscriber.goal, job.movementClass,
+                                   path->waypoints);
+                }
+                ++delivered;
+            }
+        }
+
+        if (current) {
+            pending.erase(pendingIt);
+        }
+        if (readyCursor == 0) {
+            ready.pop_front();
+        }
+    }
+}
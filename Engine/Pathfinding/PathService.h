@@ -0,0 +1,144 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../ECS/Entity.h"
+#include "../Math/Vector2.h"
+#include "NavGrid.h"
+#include "MovementClass.h"
+#include "RouteRepairer.h"
+
+class ComponentRegistry;
+class Pathfinder;
+
+enum class PathPriority {
+    Low,
+    Normal,
+    High
+};
+
+// Solves path requests on background threads against a read-only snapshot of
+// the nav grid and hands the results to PathComponents on a later frame.
+class PathService {
+public:
+    PathService(std::shared_ptr<Pathfinder> pathfinder, std::size_t workerCount);
+    ~PathService();
+
+    PathService(const PathService&) = delete;
+    PathService& operator=(const PathService&) = delete;
+
+    // Queue a path for an entity. A newer request for the same entity replaces an
+    // older one; repeating a pending request for the same goal cell is a no-op.
+    void requestPath(EntityID entityId, Vector2 start, Vector2 goal,
+                     MovementClass movementClass = MovementClass::Infantry,
+                     PathPriority priority = PathPriority::Normal);
+
+    // Send a unit towards a goal: walk straight at it right away and queue a path
+    // for its movement class. Does nothing if the unit's current or pending path already ends in the goal cell.
+    void requestMove(const std::shared_ptr<Entity>& entity, Vector2 goal,
+                     PathPriority priority = PathPriority::Normal);
+
+    // Forget any queued or in-flight request for the entity
+    void cancel(EntityID entityId);
+
+    // Main thread, once per frame: dispatch queued requests, deliver finished paths
+    // and repair long routes that grid changes have blocked
+    void update(ComponentRegistry& registry);
+
+    // Maximum number of paths written into PathComponents per update
+    void setResultBudget(std::size_t budget);
+    std::size_t getResultBudget() const;
+
+    // Deterministic delivery: update() waits for the workers, so every path lands
+    // on the update after it was requested, in request order, however long the
+    // searches took. Needed for lockstep; costs the overlap with the frame.
+    void setDeterministic(bool enabled) { deterministic = enabled; }
+    bool isDeterministic() const { return deterministic; }
+
+    // Round path corners with this many Catmull-Rom samples per segment; 0 keeps them straight
+    void setCornerSmoothing(int samplesPerSegment);
+    int getCornerSmoothing() const;
+
+    RouteRepairer& getRouteRepairer() { return repairer; }
+
+    bool isPending(EntityID entityId) const;
+    std::size_t getPendingCount() const;
+
+private:
+    struct Subscriber {
+        EntityID entityId = 0;
+        std::uint64_t serial = 0;
+        Vector2 goal;
+    };
+
+    struct Request {
+        Subscriber subscriber;
+        Vector2 start;
+        MovementClass movementClass = MovementClass::Infantry;
+        PathPriority priority = PathPriority::Normal;
+        std::uint64_t order = 0;
+    };
+
+    struct Pending {
+        std::uint64_t serial = 0;
+        int goalX = 0;
+        int goalY = 0;
+        MovementClass movementClass = MovementClass::Infantry;
+    };
+
+    // One search shared by every subscriber asking for the same start/goal cells and movement class
+    struct Job {
+        std::shared_ptr<const NavGrid> grid;
+        Vector2 start;
+        Vector2 goal;
+        MovementClass movementClass = MovementClass::Infantry;
+        PathPriority priority = PathPriority::Normal;
+        std::uint64_t order = 0;
+        std::vector<Subscriber> subscribers;
+        std::vector<Vector2> waypoints;
+        bool fromCache = false;
+        bool prepared = false;  // Cached and smoothed, ready to hand out
+        std::vector<std::unique_ptr<Job>> batch;  // Other jobs to the same goal cell, solved in one search
+    };
+
+    // Heap ordering: highest priority first, then oldest
+    struct JobCompare {
+        bool operator()(const std::unique_ptr<Job>& a, const std::unique_ptr<Job>& b) const;
+    };
+
+    void workerLoop();
+    void solveBatch(Job& job);
+    void dispatchRequests();
+    void deliverResults(ComponentRegistry& registry);
+    void waitForWorkers();
+
+    std::shared_ptr<Pathfinder> pathfinder;
+    std::size_t resultBudget = 64;
+    bool deterministic = false;
+    int cornerSamples = 0;
+    RouteRepairer repairer;
+
+    // Main thread only
+    std::unordered_map<EntityID, Request> queued;
+    std::unordered_map<EntityID, Pending> pending;
+    std::uint64_t nextSerial = 1;
+    std::uint64_t nextOrder = 1;
+    std::deque<std::unique_ptr<Job>> ready;
+    std::size_t readyCursor = 0;  // Next subscriber of ready.front() to deliver
+
+    // Shared with workers
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+    std::vector<std::unique_ptr<Job>> jobHeap;
+    std::size_t busyWorkers = 0;
+    std::vector<std::unique_ptr<Job>> finished;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
@@ -0,0 +1,168 @@
+#include "PathSmoother.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+// Body half-width swept along a shortcut, in cells. Matches the room a unit had
+// walking cell centers, so a pulled path never hugs an obstacle closer than that.
+const float SWEEP_HALF_WIDTH = 0.45f;
+}  // namespace
+
+bool PathSmoother::hasLineOfSight(const NavGrid& grid, Vector2 from, Vector2 to,
+                                  MovementClass movementClass, float maxStepCost) {
+    const float cellSize = grid.getCellSize();
+    float x0 = from.x / cellSize, y0 = from.y / cellSize;
+    float x1 = to.x / cellSize, y1 = to.y / cellSize;
+
+    float dx = x1 - x0, dy = y1 - y0;
+    float length = std::sqrt(dx * dx + dy * dy);
+    if (length < 1e-4f) {
+        return isSegmentClear(grid, x0, y0, x1, y1, movementClass, maxStepCost);
+    }
+
+    // Centre line plus both edges of the unit's body
+    float nx = -dy / length * SWEEP_HALF_WIDTH;
+    float ny = dx / length * SWEEP_HALF_WIDTH;
+    return isSegmentClear(grid, x0, y0, x1, y1, movementClass, maxStepCost) &&
+           isSegmentClear(grid, x0 + nx, y0 + ny, x1 + nx, y1 + ny, movementClass, maxStepCost) &&
+           isSegmentClear(grid, x0 - nx, y0 - ny, x1 - nx, y1 - ny, movementClass, maxStepCost);
+}
+
+void PathSmoother::stringPull(const NavGrid& grid, std::vector<int>& cells, MovementClass movementClass) {
+    if (cells.size() < 3) {
+        return;
+    }
+
+    const int width = grid.getWidth();
+    auto center = [&](int cell) { return grid.cellToWorld(cell % width, cell / width); };
+
+    std::vector<int> pulled;
+    pulled.push_back(cells.front());
+
+    std::size_t anchor = 0;
+    float sectionCost = grid.getStepCost(cells[anchor], movementClass);
+    for (std::size_t next = anchor + 1; next < cells.size(); ++next) {
+        // A shortcut may not cross terrain dearer than the stretch of path it replaces
+        float candidateCost = std::max(sectionCost, grid.getStepCost(cells[next], movementClass));
+        if (next == anchor + 1 ||
+            hasLineOfSight(grid, center(cells[anchor]), center(cells[next]), movementClass, candidateCost)) {
+            sectionCost = candidateCost;
+            continue;
+        }
+
+        anchor = next - 1;
+        pulled.push_back(cells[anchor]);
+        sectionCost = std::max(grid.getStepCost(cells[anchor], movementClass),
+                               grid.getStepCost(cells[next], movementClass));
+    }
+
+    pulled.push_back(cells.back());
+    cells.swap(pulled);
+}
+
+void PathSmoother::smoothCorners(const NavGrid& grid, std::vector<Vector2>& waypoints,
+                                 MovementClass movementClass, int samplesPerSegment) {
+    if (waypoints.size() < 3 || samplesPerSegment <= 0) {
+        return;
+    }
+
+    std::vector<Vector2> smoothed;
+    smoothed.reserve(waypoints.size() * (samplesPerSegment + 1));
+    std::vector<Vector2> samples(samplesPerSegment);
+
+    const std::size_t last = waypoints.size() - 1;
+    for (std::size_t i = 0; i < last; ++i) {
+        const Vector2& p0 = waypoints[i > 0 ? i - 1 : i];
+        const Vector2& p1 = waypoints[i];
+        const Vector2& p2 = waypoints[i + 1];
+        const Vector2& p3 = waypoints[i + 2 <= last ? i + 2 : last];
+
+        smoothed.push_back(p1);
+
+        float maxStepCost = std::max(getStepCostAt(grid, p1, movementClass),
+                                     getStepCostAt(grid, p2, movementClass));
+        bool clear = true;
+        Vector2 previous = p1;
+        for (int s = 0; s < samplesPerSegment && clear; ++s) {
+            float t = static_cast<float>(s + 1) / static_cast<float>(samplesPerSegment + 1);
+            float t2 = t * t, t3 = t2 * t;
+            // Uniform Catmull-Rom through p1 and p2
+            samples[s] = (p1 * 2.0f +
+                          (p2 - p0) * t +
+                          (p0 * 2.0f - p1 * 5.0f + p2 * 4.0f - p3) * t2 +
+                          (p1 * 3.0f - p0 - p2 * 3.0f + p3) * t3) * 0.5f;
+            clear = hasLineOfSight(grid, previous, samples[s], movementClass, maxStepCost);
+            previous = samples[s];
+        }
+        if (clear && hasLineOfSight(grid, previous, p2, movementClass, maxStepCost)) {
+            smoothed.insert(smoothed.end(), samples.begin(), samples.end());
+        }
+    }
+    smoothed.push_back(waypoints.back());
+
+    waypoints.swap(smoothed);
+}
+
+bool PathSmoother::isSegmentClear(const NavGrid& grid, float x0, float y0, float x1, float y1,
+                                  MovementClass movementClass, float maxStepCost) {
+    auto usable = [&](int x, int y) {
+        return grid.isInBounds(x, y) && grid.isPassable(x, y, movementClass) &&
+               grid.getStepCost(x, y, movementClass) <= maxStepCost;
+    };
+
+    // Supercover DDA: visit every cell the segment touches
+    int x = static_cast<int>(std::floor(x0));
+    int y = static_cast<int>(std::floor(y0));
+    const int endX = static_cast<int>(std::floor(x1));
+    const int endY = static_cast<int>(std::floor(y1));
+    if (!usable(x, y)) {
+        return false;
+    }
+
+    const float infinity = std::numeric_limits<float>::infinity();
+    float dx = x1 - x0, dy = y1 - y0;
+    int stepX = dx > 0.0f ? 1 : (dx < 0.0f ? -1 : 0);
+    int stepY = dy > 0.0f ? 1 : (dy < 0.0f ? -1 : 0);
+    float tDeltaX = stepX != 0 ? std::abs(1.0f / dx) : infinity;
+    float tDeltaY = stepY != 0 ? std::abs(1.0f / dy) : infinity;
+    float tMaxX = stepX > 0 ? (x + 1 - x0) * tDeltaX : (stepX < 0 ? (x0 - x) * tDeltaX : infinity);
+    float tMaxY = stepY > 0 ? (y + 1 - y0) * tDeltaY : (stepY < 0 ? (y0 - y) * tDeltaY : infinity);
+
+    int remaining = std::abs(endX - x) + std::abs(endY - y);
+    while (remaining > 0) {
+        if (stepX != 0 && stepY != 0 && std::abs(tMaxX - tMaxY) < 1e-5f) {
+            // Passing exactly through a corner touches both side cells
+            if (!usable(x + stepX, y) || !usable(x, y + stepY)) {
+                return false;
+            }
+            x += stepX;
+            y += stepY;
+            tMaxX += tDeltaX;
+            tMaxY += tDeltaY;
+            remaining -= 2;
+        } else if (tMaxX < tMaxY) {
+            x += stepX;
+            tMaxX += tDeltaX;
+            --remaining;
+        } else {
+            y += stepY;
+            tMaxY += tDeltaY;
+            --remaining;
+        }
+
+        if (!usable(x, y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+float PathSmoother::getStepCostAt(const NavGrid& grid, Vector2 position, MovementClass movementClass) {
+    int x = grid.worldToCellX(position.x);
+    int y = grid.worldToCellY(position.y);
+    if (!grid.isInBounds(x, y)) {
+        return 0.0f;
+    }
+    return grid.getStepCost(x, y, movementClass);
+}
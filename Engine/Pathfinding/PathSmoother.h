@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include "../Math/Vector2.h"
+#include "NavGrid.h"
+#include "MovementClass.h"
+
+// Post-processing for A* cell paths. String pulling drops every cell a unit can
+// walk past in a straight line; corner smoothing optionally rounds the remaining
+// turns with Catmull-Rom samples where the curve stays on usable ground.
+class PathSmoother {
+public:
+    // True if a unit of the class can walk the segment. The segment is swept with
+    // half a cell of body width, and every touched cell must be passable and cost
+    // no more than maxStepCost.
+    static bool hasLineOfSight(const NavGrid& grid, Vector2 from, Vector2 to,
+                               MovementClass movementClass, float maxStepCost);
+
+    // Reduce a start-to-goal list of row-major cells to the turning points
+    static void stringPull(const NavGrid& grid, std::vector<int>& cells, MovementClass movementClass);
+
+    // Insert Catmull-Rom samples between waypoints; segments whose curve would
+    // leave usable ground stay straight
+    static void smoothCorners(const NavGrid& grid, std::vector<Vector2>& waypoints,
+                              MovementClass movementClass, int samplesPerSegment = 3);
+
+    // Step cost of the cell under a world position; 0 off the grid
+    static float getStepCostAt(const NavGrid& grid, Vector2 position, MovementClass movementClass);
+
+private:
+    static bool isSegmentClear(const NavGrid& grid, float x0, float y0, float x1, float y1,
+                               MovementClass movementClass, float maxStepCost);
+};
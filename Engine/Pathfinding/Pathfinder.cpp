@@ -1,144 +1,461 @@
 #include "Pathfinder.h"
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <functional>
+#include <limits>
+#include <thread>
+
+namespace {
+// 4 cardinal directions
+const int NEIGHBOR_DX[] = {0, 1, 0, -1};
+const int NEIGHBOR_DY[] = {-1, 0, 1, 0};
+
+// A reverse search only pays off once it replaces several A* runs
+const std::size_t SHARED_SEARCH_MIN_STARTS = 3;
+
+// Keep only the turning points; the unit is already in the start cell and the
+// goal cell is replaced by the exact goal
+void buildWaypoints(const NavGrid& grid, std::vector<int>& cells, MovementClass movementClass, Vector2 goal,
+                    std::vector<Vector2>& path) {
+    const int width = grid.getWidth();
+    PathSmoother::stringPull(grid, cells, movementClass);
+    for (std::size_t i = 1; i + 1 < cells.size(); ++i) {
+        path.push_back(grid.cellToWorld(cells[i] % width, cells[i] / width));
+    }
+    path.push_back(goal);
+}
+
+struct BatchEntry {
+    std::size_t request = 0;
+    int startCell = 0;
+};
+
+// Requests that resolved to the same goal cell and movement class
+struct GoalGroup {
+    int goalCell = 0;
+    MovementClass movementClass = MovementClass::Infantry;
+    std::vector<BatchEntry> entries;
+};
+
+// Dijkstra outwards from the goal until every start cell is settled. Entering a
+// cell costs its terrain, so relaxing towards a neighbour charges the current cell.
+void solveGoalGroup(const NavGrid& grid, const GoalGroup& group, const PathRequest* requests,
+                    std::vector<Vector2>* results, SearchStats* stats) {
+    const std::uint8_t START = 2;
+    const int width = grid.getWidth();
+    const MovementClass movementClass = group.movementClass;
+    SearchSpace space(width, grid.getHeight());
+
+    std::size_t remaining = 0;
+    for (const auto& entry : group.entries) {
+        SearchSpace::Node& node = space.at(entry.startCell % width, entry.startCell / width);
+        if (!(node.flags & START)) {
+            node.flags |= START;
+            ++remaining;
+        }
+    }
+
+    std::vector<PathNode> open;
+    space.at(group.goalCell % width, group.goalCell / width).cost = 0.0f;
+    open.push_back({group.goalCell, 0.0f});
+    std::uint64_t expandedCount = 0;
+    auto later = std::greater<PathNode>();
+
+    while (!open.empty() && remaining > 0) {
+        std::pop_heap(open.begin(), open.end(), later);
+        PathNode current = open.back();
+        open.pop_back();
+
+        int x = current.cell % width;
+        int y = current.cell / width;
+        SearchSpace::Node& node = space.at(x, y);
+        if (node.flags & SearchSpace::CLOSED) continue;  // Stale queue entry
+        node.flags |= SearchSpace::CLOSED;
+        ++expandedCount;
+
+        if (node.flags & START) {
+            --remaining;
+        }
+        // A unit standing on a blocked cell can leave it, but nothing routes through it
+        if (current.cell != group.goalCell && !grid.isPassable(x, y, movementClass)) continue;
+
+        const float newCost = node.cost + grid.getStepCost(x, y, movementClass);
+        for (int i = 0; i < 4; ++i) {
+            int nx = x + NEIGHBOR_DX[i];
+            int ny = y + NEIGHBOR_DY[i];
+            if (!grid.isInBounds(nx, ny)) continue;
+
+            const SearchSpace::Node& neighbor = space.get(nx, ny);
+            if (neighbor.flags & SearchSpace::CLOSED) continue;
+            if (!(neighbor.flags & START) && !grid.isPassable(nx, ny, movementClass)) continue;
+            if (newCost >= neighbor.cost) continue;
+
+            SearchSpace::Node& updated = space.at(nx, ny);
+            updated.cost = newCost;
+            updated.parent = current.cell;  // One step closer to the goal
+            open.push_back({ny * width + nx, newCost});
+            std::push_heap(open.begin(), open.end(), later);
+        }
+    }
+
+    std::vector<int> cells;
+    for (const auto& entry : group.entries) {
+        const PathRequest& request = requests[entry.request];
+        std::vector<Vector2>& path = results[entry.request];
+        const SearchSpace::Node& start = space.get(entry.startCell % width, entry.startCell / width);
+        bool found = (start.flags & SearchSpace::CLOSED) != 0;
+        if (stats) {
+            stats[entry.request].found = found;
+            stats[entry.request].pathCost = found ? start.cost : 0.0f;
+        }
+        if (!found) {
+            path.push_back(request.goal);
+            continue;
+        }
+
+        cells.clear();
+        for (int cell = entry.startCell; cell != -1; cell = space.get(cell % width, cell / width).parent) {
+            cells.push_back(cell);
+        }
+        buildWaypoints(grid, cells, movementClass, request.goal, path);
+    }
+    if (stats) {
+        stats[group.entries.front().request].nodesExpanded += expandedCount;
+    }
+}
+}  // namespace
 
 Pathfinder::Pathfinder(int gridWidth, int gridHeight, float cellSize)
-    : gridWidth(gridWidth), gridHeight(gridHeight), cellSize(cellSize) {
-    obstacles.resize(gridHeight, std::vector<bool>(gridWidth, false));
+    : grid(gridWidth, gridHeight, cellSize) {}
+
+std::vector<Vector2> Pathfinder::findPath(Vector2 start, Vector2 goal, MovementClass movementClass) {
+    std::vector<Vector2> path;
+    if (findCachedPath(start, goal, movementClass, path)) {
+        return path;
+    }
+
+    path = findPath(grid, start, goal, movementClass);
+    cachePath(grid, start, goal, movementClass, path);
+    return path;
 }
 
-std::vector<Vector2> Pathfinder::findPath(Vector2 start, Vector2 goal) {
+std::vector<Vector2> Pathfinder::findPath(const NavGrid& grid, Vector2 start, Vector2 goal,
+                                          MovementClass movementClass, SearchStats* stats) {
     std::vector<Vector2> path;
-    
-    Vector2 startGrid = worldToGrid(start);
-    Vector2 goalGrid = worldToGrid(goal);
-    
-    int startX = static_cast<int>(startGrid.x);
-    int startY = static_cast<int>(startGrid.y);
-    int goalX = static_cast<int>(goalGrid.x);
-    int goalY = static_cast<int>(goalGrid.y);
-    
+
+    int startX = grid.worldToCellX(start.x);
+    int startY = grid.worldToCellY(start.y);
+    int goalX = grid.worldToCellX(goal.x);
+    int goalY = grid.worldToCellY(goal.y);
+
     // Bounds checking
-    if (startX < 0 || startX >= gridWidth || startY < 0 || startY >= gridHeight ||
-        goalX < 0 || goalX >= gridWidth || goalY < 0 || goalY >= gridHeight) {
+    if (!grid.isInBounds(startX, startY) || !grid.isInBounds(goalX, goalY)) {
         path.push_back(goal);
         return path;
     }
-    
+
+    // Mines, bases and turrets sit on blocked cells; route to the closest usable cell instead
+    if (!grid.findNearestPassableCell(goalX, goalY, movementClass, 4)) {
+        path.push_back(goal);
+        return path;
+    }
+
+    const int width = grid.getWidth();
+    const int startCell = startY * width + startX;
+    const int goalCell = goalY * width + goalX;
+
+    // Cost, parent and closed state, paged in only where the search goes
+    SearchSpace space(width, grid.getHeight());
+
     // OpenList priority queue
     std::priority_queue<PathNode, std::vector<PathNode>, std::greater<PathNode>> openList;
-    std::unordered_map<int, std::shared_ptr<PathNode>> closedList;
-    
-    // Start node
-    PathNode startNode;
-    startNode.position = startGrid;
-    startNode.gCost = 0.0f;
-    startNode.hCost = heuristic(startGrid, goalGrid);
-    startNode.fCost = startNode.hCost;
-    
-    openList.push(startNode);
-    
+
+    // Scale by the cheapest terrain on the map so roads don't make the heuristic overestimate
+    const float heuristicScale = grid.getMinStepCost(movementClass);
+
+    space.at(startX, startY).cost = 0.0f;
+    openList.push({startCell, heuristic(startX, startY, goalX, goalY) * heuristicScale});
+
     while (!openList.empty()) {
         PathNode current = openList.top();
         openList.pop();
-        
-        int currentX = static_cast<int>(current.position.x);
-        int currentY = static_cast<int>(current.position.y);
-        
+
+        int currentX = current.cell % width;
+        int currentY = current.cell / width;
+        SearchSpace::Node& node = space.at(currentX, currentY);
+        if (node.flags & SearchSpace::CLOSED) continue;  // Stale queue entry
+        node.flags |= SearchSpace::CLOSED;
+        if (stats) {
+            ++stats->nodesExpanded;
+        }
+
         // Goal reached
-        if (currentX == goalX && currentY == goalY) {
-            // Reconstruct path
-            auto node = current.parent;
-            while (node) {
-                path.push_back(gridToWorld(static_cast<int>(node->position.x), 
-                                          static_cast<int>(node->position.y)));
-                node = node->parent;
+        if (current.cell == goalCell) {
+            if (stats) {
+                stats->found = true;
+                stats->pathCost = node.cost;
+            }
+
+            std::vector<int> cells;
+            for (int cell = goalCell; cell != -1; cell = space.get(cell % width, cell / width).parent) {
+                cells.push_back(cell);
             }
-            std::reverse(path.begin(), path.end());
-            path.push_back(goal);
+            std::reverse(cells.begin(), cells.end());
+            buildWaypoints(grid, cells, movementClass, goal, path);
             return path;
         }
-        
-        // Get neighbors
-        auto neighbors = getNeighbors(currentX, currentY);
-        for (auto [neighborX, neighborY] : neighbors) {
-            if (obstacles[neighborY][neighborX]) continue;  // Skip obstacles
-            
-            Vector2 neighborPos(static_cast<float>(neighborX), static_cast<float>(neighborY));
-            float newGCost = current.gCost + 1.0f;  // Assume unit cost
-            
-            // Skip if already checked
-            int key = neighborY * gridWidth + neighborX;
-            if (closedList.find(key) != closedList.end()) continue;
-            
-            PathNode neighborNode;
-            neighborNode.position = neighborPos;
-            neighborNode.gCost = newGCost;
-            neighborNode.hCost = heuristic(neighborPos, goalGrid);
-            neighborNode.fCost = neighborNode.gCost + neighborNode.hCost;
-            neighborNode.parent = std::make_shared<PathNode>(current);
-            
-            openList.push(neighborNode);
+
+        for (int i = 0; i < 4; ++i) {
+            int neighborX = currentX + NEIGHBOR_DX[i];
+            int neighborY = currentY + NEIGHBOR_DY[i];
+            if (!grid.isInBounds(neighborX, neighborY)) continue;
+
+            const SearchSpace::Node& neighbor = space.get(neighborX, neighborY);
+            if (neighbor.flags & SearchSpace::CLOSED) continue;
+            if (!grid.isPassable(neighborX, neighborY, movementClass)) continue;  // Obstacles, tight gaps, bad terrain
+
+            float newGCost = node.cost + grid.getStepCost(neighborX, neighborY, movementClass);
+            if (newGCost >= neighbor.cost) continue;
+
+            SearchSpace::Node& updated = space.at(neighborX, neighborY);
+            updated.cost = newGCost;
+            updated.parent = current.cell;
+            openList.push({neighborY * width + neighborX, newGCost + heuristic(neighborX, neighborY, goalX, goalY) * heuristicScale});
         }
-        
-        int key = currentY * gridWidth + currentX;
-        closedList[key] = std::make_shared<PathNode>(current);
     }
-    
+
     // No path found
     path.push_back(goal);
     return path;
 }
 
-void Pathfinder::setObstacle(int gridX, int gridY, bool isObstacle) {
-    if (gridX >= 0 && gridX < gridWidth && gridY >= 0 && gridY < gridHeight) {
-        obstacles[gridY][gridX] = isObstacle;
+void Pathfinder::findPaths(const NavGrid& grid, const PathRequest* requests, std::size_t count,
+                           std::vector<Vector2>* results, std::size_t threadCount, SearchStats* stats) {
+    // Resolve goal cells the way findPath does, then sort so requests to one goal sit together
+    struct Keyed {
+        std::uint64_t key = 0;
+        BatchEntry entry;
+    };
+    std::vector<Keyed> keyed;
+    keyed.reserve(count);
+    const int width = grid.getWidth();
+    for (std::size_t i = 0; i < count; ++i) {
+        const PathRequest& request = requests[i];
+        results[i].clear();
+        if (stats) {
+            stats[i] = SearchStats();
+        }
+
+        int startX = grid.worldToCellX(request.start.x);
+        int startY = grid.worldToCellY(request.start.y);
+        int goalX = grid.worldToCellX(request.goal.x);
+        int goalY = grid.worldToCellY(request.goal.y);
+        if (!grid.isInBounds(startX, startY) || !grid.isInBounds(goalX, goalY) ||
+            !grid.findNearestPassableCell(goalX, goalY, request.movementClass, 4)) {
+            results[i].push_back(request.goal);
+            continue;
+        }
+
+        auto goalCell = static_cast<std::uint64_t>(goalY * width + goalX);
+        keyed.push_back({(static_cast<std::uint64_t>(request.movementClass) << 32) | goalCell,
+                         BatchEntry{i, startY * width + startX}});
+    }
+    std::sort(keyed.begin(), keyed.end(), [](const Keyed& a, const Keyed& b) {
+        return a.key < b.key || (a.key == b.key && a.entry.request < b.entry.request);
+    });
+
+    std::vector<GoalGroup> groups;
+    for (std::size_t i = 0; i < keyed.size(); ++i) {
+        if (i == 0 || keyed[i].key != keyed[i - 1].key) {
+            groups.emplace_back();
+            groups.back().goalCell = static_cast<int>(keyed[i].key & 0xffffffffu);
+            groups.back().movementClass = requests[keyed[i].entry.request].movementClass;
+        }
+        groups.back().entries.push_back(keyed[i].entry);
+    }
+
+    // Largest groups first so one big wave doesn't start last on a busy thread
+    std::stable_sort(groups.begin(), groups.end(), [](const GoalGroup& a, const GoalGroup& b) {
+        return a.entries.size() > b.entries.size();
+    });
+
+    std::atomic<std::size_t> nextGroup{0};
+    auto solveGroups = [&]() {
+        for (std::size_t g = nextGroup++; g < groups.size(); g = nextGroup++) {
+            const GoalGroup& group = groups[g];
+            std::size_t distinctStarts = 1;
+            for (std::size_t i = 1; i < group.entries.size() && distinctStarts < SHARED_SEARCH_MIN_STARTS; ++i) {
+                if (group.entries[i].startCell != group.entries[0].startCell) ++distinctStarts;
+            }
+            if (distinctStarts >= SHARED_SEARCH_MIN_STARTS) {
+                solveGoalGroup(grid, group, requests, results, stats);
+                continue;
+            }
+
+            for (const auto& entry : group.entries) {
+                const PathRequest& request = requests[entry.request];
+                auto path = findPath(grid, request.start, request.goal, request.movementClass,
+                                     stats ? &stats[entry.request] : nullptr);
+                results[entry.request].assign(path.begin(), path.end());
+            }
+        }
+    };
+
+    std::size_t helpers = std::min(threadCount, groups.size());
+    helpers = helpers > 0 ? helpers - 1 : 0;  // The calling thread works too
+    std::vector<std::thread> threads;
+    threads.reserve(helpers);
+    for (std::size_t i = 0; i < helpers; ++i) {
+        threads.emplace_back(solveGroups);
     }
+    solveGroups();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void Pathfinder::setObstacle(int gridX, int gridY, bool isObstacle) {
+    std::uint64_t previousVersion = grid.getVersion();
+    grid.setBlocked(gridX, gridY, isObstacle);
+    onGridChanged(previousVersion);
+}
+
+void Pathfinder::setObstacles(const std::vector<std::uint8_t>& cells) {
+    std::uint64_t previousVersion = grid.getVersion();
+    grid.assignBlocked(cells);
+    onGridChanged(previousVersion);
+}
+
+void Pathfinder::setObstacleCells(const std::vector<int>& sortedCells) {
+    std::uint64_t previousVersion = grid.getVersion();
+    grid.assignBlockedCells(sortedCells);
+    onGridChanged(previousVersion);
+}
+
+void Pathfinder::setTerrain(Vector2 min, Vector2 max, TerrainType type) {
+    GridRect area{grid.worldToCellX(min.x), grid.worldToCellY(min.y),
+                  grid.worldToCellX(max.x), grid.worldToCellY(max.y)};
+    std::uint64_t previousVersion = grid.getVersion();
+    grid.fillTerrain(area, type);
+    onGridChanged(previousVersion);
 }
 
 void Pathfinder::clearGrid() {
-    for (auto& row : obstacles) {
-        std::fill(row.begin(), row.end(), false);
-    }
+    std::uint64_t previousVersion = grid.getVersion();
+    grid.clear();
+    onGridChanged(previousVersion);
 }
 
 int Pathfinder::getGridWidth() const {
-    return gridWidth;
+    return grid.getWidth();
 }
 
 int Pathfinder::getGridHeight() const {
-    return gridHeight;
+    return grid.getHeight();
 }
 
-Vector2 Pathfinder::worldToGrid(Vector2 worldPos) const {
-    return Vector2(worldPos.x / cellSize, worldPos.y / cellSize);
+float Pathfinder::getCellSize() const {
+    return grid.getCellSize();
 }
 
-Vector2 Pathfinder::gridToWorld(int gridX, int gridY) const {
-    return Vector2(gridX * cellSize + cellSize / 2.0f, 
-                   gridY * cellSize + cellSize / 2.0f);
+std::uint64_t Pathfinder::getGridVersion() const {
+    return grid.getVersion();
 }
 
-float Pathfinder::heuristic(Vector2 from, Vector2 to) const {
-    // Manhattan distance heuristic for grid-based pathfinding
-    return std::abs(from.x - to.x) + std::abs(from.y - to.y);
-}
-
-std::vector<std::pair<int, int>> Pathfinder::getNeighbors(int gridX, int gridY) const {
-    std::vector<std::pair<int, int>> neighbors;
-    
-    // 4 cardinal directions
-    int dx[] = {0, 1, 0, -1};
-    int dy[] = {-1, 0, 1, 0};
-    
-    for (int i = 0; i < 4; ++i) {
-        int newX = gridX + dx[i];
-        int newY = gridY + dy[i];
-        
-        if (newX >= 0 && newX < gridWidth && newY >= 0 && newY < gridHeight) {
-            neighbors.push_back({newX, newY});
+const NavGrid& Pathfinder::getGrid() const {
+    return grid;
+}
+
+std::shared_ptr<const NavGrid> Pathfinder::getSnapshot() {
+    if (!snapshot || snapshot->getVersion() != grid.getVersion()) {
+        snapshot = std::make_shared<const NavGrid>(grid);
+    }
+    return snapshot;
+}
+
+bool Pathfinder::findCachedPath(Vector2 start, Vector2 goal, MovementClass movementClass,
+                                std::vector<Vector2>& path) {
+    int startX = grid.worldToCellX(start.x);
+    int startY = grid.worldToCellY(start.y);
+    int goalX = grid.worldToCellX(goal.x);
+    int goalY = grid.worldToCellY(goal.y);
+    if (!grid.isInBounds(startX, startY) || !grid.isInBounds(goalX, goalY)) {
+        return false;
+    }
+
+    int width = grid.getWidth();
+    if (!cache.lookup(startY * width + startX, goalY * width + goalX, movementClass, grid.getVersion(), path)) {
+        return false;
+    }
+
+    path.push_back(goal);
+    return true;
+}
+
+void Pathfinder::cachePath(const NavGrid& solvedOn, Vector2 start, Vector2 goal, MovementClass movementClass,
+                           const std::vector<Vector2>& path) {
+    // Results from an outdated snapshot may cross cells that have changed since
+    if (solvedOn.getVersion() != grid.getVersion() || path.empty()) {
+        return;
+    }
+
+    int startX = grid.worldToCellX(start.x);
+    int startY = grid.worldToCellY(start.y);
+    int goalX = grid.worldToCellX(goal.x);
+    int goalY = grid.worldToCellY(goal.y);
+    if (!grid.isInBounds(startX, startY) || !grid.isInBounds(goalX, goalY)) {
+        return;
+    }
+
+    // Everything but the exact goal point, which differs per caller
+    std::vector<Vector2> route(path.begin(), path.end() - 1);
+    GridRect bounds;
+    bounds.include(startX, startY);
+    bounds.include(goalX, goalY);
+    for (const auto& waypoint : route) {
+        bounds.include(grid.worldToCellX(waypoint.x), grid.worldToCellY(waypoint.y));
+    }
+
+    int width = grid.getWidth();
+    cache.insert(startY * width + startX, goalY * width + goalX, movementClass, grid.getVersion(), route, bounds);
+}
+
+const PathCacheStats& Pathfinder::getCacheStats() const {
+    return cache.getStats();
+}
+
+PathCache& Pathfinder::getPathCache() {
+    return cache;
+}
+
+void Pathfinder::takeChangedRegions(std::vector<GridRect>& out) {
+    out.clear();
+    out.swap(changedRegions);
+}
+
+void Pathfinder::onGridChanged(std::uint64_t previousVersion) {
+    if (grid.getVersion() == previousVersion) {
+        return;
+    }
+
+    const GridRect& region = grid.getLastChangedRegion();
+    cache.invalidateRegion(region, grid.getVersion());
+
+    // Nobody drained the log for a while; fold it into one rectangle rather than grow it
+    const std::size_t maxChangedRegions = 32;
+    if (changedRegions.size() >= maxChangedRegions) {
+        GridRect merged = changedRegions.front();
+        for (const auto& changed : changedRegions) {
+            merged.include(changed.minX, changed.minY);
+            merged.include(changed.maxX, changed.maxY);
         }
+        changedRegions.assign(1, merged);
     }
-    
-    return neighbors;
+    changedRegions.push_back(region);
+}
+
+float Pathfinder::heuristic(int fromX, int fromY, int toX, int toY) {
+    // Manhattan distance heuristic for grid-based pathfinding
+    return static_cast<float>(std::abs(fromX - toX) + std::abs(fromY - toY));
 }
@@ -2,51 +2,103 @@
 
 #include <vector>
 #include <queue>
-#include <unordered_map>
 #include <memory>
+#include <cstdint>
 #include "../Math/Vector2.h"
+#include "NavGrid.h"
+#include "PathCache.h"
+#include "PathSmoother.h"
+#include "SearchSpace.h"
 
 struct PathNode {
-    Vector2 position;
-    float gCost = 0.0f;  // Cost from start
-    float hCost = 0.0f;  // Heuristic to goal
-    float fCost = 0.0f;  // Total cost
-    std::shared_ptr<PathNode> parent;
-    
+    int cell = 0;        // Row-major cell index
+    float fCost = 0.0f;  // Cost from start + heuristic to goal
+
     bool operator>(const PathNode& other) const {
         return fCost > other.fCost;
     }
 };
 
+// Optional counters filled in by a search
+struct SearchStats {
+    std::uint64_t nodesExpanded = 0;
+    float pathCost = 0.0f;  // Grid cost of the cell path to the (possibly moved) goal cell
+    bool found = false;
+};
+
+// One query of a batched search
+struct PathRequest {
+    Vector2 start;
+    Vector2 goal;
+    MovementClass movementClass = MovementClass::Infantry;
+};
+
 class Pathfinder {
 public:
     Pathfinder(int gridWidth, int gridHeight, float cellSize);
-    
-    // Find path using A*
-    std::vector<Vector2> findPath(Vector2 start, Vector2 goal);
-    
+
+    // Find path using A* on the live grid, served from the route cache when possible.
+    // Paths hold the turning points after the start cell and end at the exact goal.
+    std::vector<Vector2> findPath(Vector2 start, Vector2 goal,
+                                  MovementClass movementClass = MovementClass::Infantry);
+
+    // Find path using A* on any grid; safe to call from worker threads
+    static std::vector<Vector2> findPath(const NavGrid& grid, Vector2 start, Vector2 goal,
+                                         MovementClass movementClass = MovementClass::Infantry,
+                                         SearchStats* stats = nullptr);
+
+    // Solve count requests at once; results[i] receives the path for requests[i] in the
+    // findPath format, reusing the buffer's capacity. Requests sharing a goal cell and
+    // movement class are answered by one reverse search from the goal; independent
+    // groups run on up to threadCount threads. stats, if given, is parallel to requests;
+    // a shared search's expansions are counted on the first request of its group.
+    static void findPaths(const NavGrid& grid, const PathRequest* requests, std::size_t count,
+                          std::vector<Vector2>* results, std::size_t threadCount = 1,
+                          SearchStats* stats = nullptr);
+
     // Set obstacles in the grid
     void setObstacle(int gridX, int gridY, bool isObstacle);
-    
+
+    // Replace the whole obstacle layer (row-major, 1 = obstacle)
+    void setObstacles(const std::vector<std::uint8_t>& cells);
+
+    // Same, from the sorted, unique row-major indices of the obstacle cells
+    void setObstacleCells(const std::vector<int>& sortedCells);
+
+    // Paint terrain over a world-space rectangle
+    void setTerrain(Vector2 min, Vector2 max, TerrainType type);
+
     // Clear grid
     void clearGrid();
-    
+
     // Get grid info
     int getGridWidth() const;
     int getGridHeight() const;
+    float getCellSize() const;
+    std::uint64_t getGridVersion() const;
+    const NavGrid& getGrid() const;
+
+    // Immutable copy of the current grid, shared until the grid changes
+    std::shared_ptr<const NavGrid> getSnapshot();
+
+    // Move every region changed since the last call into out (for incremental replanning)
+    void takeChangedRegions(std::vector<GridRect>& out);
+
+    // Route cache access for callers that search elsewhere (e.g. PathService workers)
+    bool findCachedPath(Vector2 start, Vector2 goal, MovementClass movementClass, std::vector<Vector2>& path);
+    void cachePath(const NavGrid& solvedOn, Vector2 start, Vector2 goal, MovementClass movementClass,
+                   const std::vector<Vector2>& path);
+    const PathCacheStats& getCacheStats() const;
+    PathCache& getPathCache();
 
 private:
-    int gridWidth, gridHeight;
-    float cellSize;
-    std::vector<std::vector<bool>> obstacles;  // true = obstacle
-    
-    // Convert world coordinates to grid coordinates
-    Vector2 worldToGrid(Vector2 worldPos) const;
-    Vector2 gridToWorld(int gridX, int gridY) const;
-    
+    NavGrid grid;
+    std::shared_ptr<const NavGrid> snapshot;
+    PathCache cache;
+    std::vector<GridRect> changedRegions;
+
+    void onGridChanged(std::uint64_t previousVersion);
+
     // Heuristic (Manhattan distance)
-    float heuristic(Vector2 from, Vector2 to) const;
-    
-    // Get neighbors of a grid cell
-    std::vector<std::pair<int, int>> getNeighbors(int gridX, int gridY) const;
+    static float heuristic(int fromX, int fromY, int toX, int toY);
 };
@@ -0,0 +1,209 @@
+#include "RouteRepairer.h"
+#include "Pathfinder.h"
+#include "PathSmoother.h"
+#include "../ECS/ComponentRegistry.h"
+#include "../ECS/Component.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+// Routes shorter than this are cheaper to re-request than to keep a planner for
+const float MIN_TRACKED_ROUTE_CELLS = 8.0f;
+}  // namespace
+
+RouteRepairer::RouteRepairer(std::shared_ptr<Pathfinder> pathfinder)
+    : pathfinder(std::move(pathfinder)) {}
+
+void RouteRepairer::track(EntityID entityId, Vector2 start, Vector2 goal, MovementClass movementClass,
+                          const std::vector<Vector2>& waypoints) {
+    const NavGrid& grid = pathfinder->getGrid();
+    if (waypoints.empty()) {
+        routes.erase(entityId);
+        return;
+    }
+
+    float length = start.distance(waypoints.front());
+    for (std::size_t i = 1; i < waypoints.size(); ++i) {
+        length += waypoints[i - 1].distance(waypoints[i]);
+    }
+
+    int goalX = grid.worldToCellX(goal.x);
+    int goalY = grid.worldToCellY(goal.y);
+    if (length < MIN_TRACKED_ROUTE_CELLS * grid.getCellSize() || !grid.isInBounds(goalX, goalY) ||
+        !grid.findNearestPassableCell(goalX, goalY, movementClass, 4)) {
+        routes.erase(entityId);
+        return;
+    }
+
+    Route& route = routes[entityId];
+    route = Route();
+    route.goal = goal;
+    route.goalCell = goalY * grid.getWidth() + goalX;
+    route.movementClass = movementClass;
+    route.bounds = computeBounds(start, waypoints);
+    route.waypointCount = waypoints.size();
+}
+
+void RouteRepairer::forget(EntityID entityId) {
+    routes.erase(entityId);
+}
+
+void RouteRepairer::update(ComponentRegistry& registry) {
+    pathfinder->takeChangedRegions(regionScratch);
+    if (routes.empty()) {
+        return;
+    }
+
+    for (auto it = routes.begin(); it != routes.end(); ) {
+        Route& route = it->second;
+        auto entity = registry.getEntity(it->first);
+        auto transform = entity ? entity->getComponent<TransformComponent>() : nullptr;
+        auto path = entity ? entity->getComponent<PathComponent>() : nullptr;
+
+        // Someone else replaced or finished the route
+        if (!entity || entity->isDestroyed() || !transform || !path || !path->hasPath() ||
+            path->waypoints.size() != route.waypointCount || !(path->waypoints.back() == route.goal)) {
+            it = routes.erase(it);
+            continue;
+        }
+
+        bool touched = false;
+        for (const auto& region : regionScratch) {
+            if (route.planner) {
+                if (region.intersects(route.planner->getExploredBounds())) {
+                    route.pendingRegions.push_back(region);
+                    route.dirty = true;
+                }
+            } else if (region.intersects(route.bounds)) {
+                touched = true;
+            }
+        }
+        if (touched && !route.dirty &&
+            !isStillWalkable(route, transform->position, path->waypoints, path->currentIndex)) {
+            route.dirty = true;
+        }
+        ++it;
+    }
+
+    std::size_t repaired = 0;
+    for (auto it = routes.begin(); it != routes.end() && repaired < repairBudget; ) {
+        if (!it->second.dirty) {
+            ++it;
+            continue;
+        }
+
+        ++repaired;
+        if (!repair(it->second, registry.getEntity(it->first))) {
+            // Unreachable now; the unit's stuck handling takes it from here
+            it = routes.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+
+void RouteRepairer::setRepairBudget(std::size_t budget) {
+    repairBudget = std::max<std::size_t>(1, budget);
+}
+
+bool RouteRepairer::isStillWalkable(const Route& route, Vector2 position, const std::vector<Vector2>& waypoints,
+                                    std::size_t currentIndex) const {
+    const NavGrid& grid = pathfinder->getGrid();
+    const float anyCost = std::numeric_limits<float>::infinity();
+    const int width = grid.getWidth();
+
+    Vector2 from = grid.cellToWorld(grid.worldToCellX(position.x), grid.worldToCellY(position.y));
+    for (std::size_t i = currentIndex; i < waypoints.size(); ++i) {
+        // The exact goal may sit inside a building; check up to the cell the route actually ends in
+        Vector2 to = i + 1 < waypoints.size()
+            ? waypoints[i]
+            : grid.cellToWorld(route.goalCell % width, route.goalCell / width);
+        if (!PathSmoother::hasLineOfSight(grid, from, to, route.movementClass, anyCost)) {
+            return false;
+        }
+        from = to;
+    }
+    return true;
+}
+
+bool RouteRepairer::repair(Route& route, const std::shared_ptr<Entity>& entity) {
+    if (!entity) {
+        return false;
+    }
+
+    auto transform = entity->getComponent<TransformComponent>();
+    auto movement = entity->getComponent<MovementComponent>();
+    auto path = entity->getComponent<PathComponent>();
+    if (!transform || !movement || !path) {
+        return false;
+    }
+
+    const NavGrid& grid = pathfinder->getGrid();
+    const int width = grid.getWidth();
+    int startX = grid.worldToCellX(transform->position.x);
+    int startY = grid.worldToCellY(transform->position.y);
+    int goalX = grid.worldToCellX(route.goal.x);
+    int goalY = grid.worldToCellY(route.goal.y);
+    if (!grid.isInBounds(startX, startY) ||
+        !grid.findNearestPassableCell(goalX, goalY, route.movementClass, 4)) {
+        ++stats.failures;
+        return false;
+    }
+
+    // A moved goal cell or a new cheapest terrain invalidates everything the planner knows
+    int goalCell = goalY * width + goalX;
+    if (route.planner && (route.planner->getGoalCell() != goalCell ||
+                          route.planner->getHeuristicScale() != grid.getMinStepCost(route.movementClass))) {
+        route.planner.reset();
+    }
+    route.goalCell = goalCell;
+
+    int startCell = startY * width + startX;
+    bool reachable = false;
+    std::uint64_t expandedBefore = 0;
+    if (!route.planner) {
+        route.planner = std::make_unique<DStarLite>(goalCell, route.movementClass);
+        reachable = route.planner->initialize(grid, startCell);
+        ++stats.fullSearches;
+    } else {
+        expandedBefore = route.planner->getExpandedCount();
+        route.planner->moveStart(grid, startCell);
+        for (const auto& region : route.pendingRegions) {
+            route.planner->notifyChanged(grid, region);
+        }
+        reachable = route.planner->computeShortestPath(grid);
+        ++stats.repairs;
+    }
+    route.pendingRegions.clear();
+    route.dirty = false;
+    stats.nodesExpanded += route.planner->getExpandedCount() - expandedBefore;
+
+    if (!reachable || !route.planner->extractPath(grid, cellScratch)) {
+        ++stats.failures;
+        return false;
+    }
+
+    // Same shape as a fresh A* result: turning points after the start cell, then the exact goal
+    PathSmoother::stringPull(grid, cellScratch, route.movementClass);
+    path->waypoints.clear();
+    for (std::size_t i = 1; i + 1 < cellScratch.size(); ++i) {
+        path->waypoints.push_back(grid.cellToWorld(cellScratch[i] % width, cellScratch[i] / width));
+    }
+    path->waypoints.push_back(route.goal);
+    path->currentIndex = 0;
+    movement->setTarget(path->waypoints.front());
+
+    route.bounds = computeBounds(transform->position, path->waypoints);
+    route.waypointCount = path->waypoints.size();
+    return true;
+}
+
+GridRect RouteRepairer::computeBounds(Vector2 start, const std::vector<Vector2>& waypoints) const {
+    const NavGrid& grid = pathfinder->getGrid();
+    GridRect bounds;
+    bounds.include(grid.worldToCellX(start.x), grid.worldToCellY(start.y));
+    for (const auto& waypoint : waypoints) {
+        bounds.include(grid.worldToCellX(waypoint.x), grid.worldToCellY(waypoint.y));
+    }
+    return bounds;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include "../ECS/Entity.h"
+#include "../Math/Vector2.h"
+#include "NavGrid.h"
+#include "MovementClass.h"
+#include "DStarLite.h"
+
+class ComponentRegistry;
+class Pathfinder;
+
+struct RouteRepairStats {
+    std::uint64_t fullSearches = 0;   // Planner built from scratch for a route
+    std::uint64_t repairs = 0;        // Incremental repairs of an existing planner
+    std::uint64_t failures = 0;       // Routes that became unreachable
+    std::uint64_t nodesExpanded = 0;
+};
+
+// Keeps long routes walkable while the grid changes. Each tracked route gets a
+// D* Lite planner the first time a change blocks it; later changes near the
+// route only re-expand the cells around them instead of searching again.
+class RouteRepairer {
+public:
+    explicit RouteRepairer(std::shared_ptr<Pathfinder> pathfinder);
+
+    // Watch a route just written to the entity's PathComponent; short routes are ignored
+    void track(EntityID entityId, Vector2 start, Vector2 goal, MovementClass movementClass,
+               const std::vector<Vector2>& waypoints);
+    void forget(EntityID entityId);
+
+    // Main thread, once per frame after the grid is rebuilt
+    void update(ComponentRegistry& registry);
+
+    // Maximum number of routes repaired per update; the rest wait a frame
+    void setRepairBudget(std::size_t budget);
+    std::size_t getRepairBudget() const { return repairBudget; }
+
+    std::size_t getTrackedCount() const { return routes.size(); }
+    const RouteRepairStats& getStats() const { return stats; }
+
+private:
+    struct Route {
+        Vector2 goal;
+        int goalCell = 0;  // Nearest cell the class can stand on
+        MovementClass movementClass = MovementClass::Infantry;
+        GridRect bounds;   // Cells covered by the current waypoints
+        std::size_t waypointCount = 0;
+        std::unique_ptr<DStarLite> planner;
+        std::vector<GridRect> pendingRegions;  // Changes the planner hasn't seen yet
+        bool dirty = false;
+    };
+
+    bool isStillWalkable(const Route& route, Vector2 position, const std::vector<Vector2>& waypoints,
+                         std::size_t currentIndex) const;
+    bool repair(Route& route, const std::shared_ptr<Entity>& entity);
+    GridRect computeBounds(Vector2 start, const std::vector<Vector2>& waypoints) const;
+
+    std::shared_ptr<Pathfinder> pathfinder;
+    std::map<EntityID, Route> routes;  // By id, so the repair budget goes the same way every run
+    std::vector<GridRect> regionScratch;
+    std::vector<int> cellScratch;
+    std::size_t repairBudget = 8;
+    RouteRepairStats stats;
+};
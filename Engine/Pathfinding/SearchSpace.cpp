@@ -0,0 +1,40 @@
+#include "SearchSpace.h"
+#include <algorithm>
+
+namespace {
+// Pages a thread keeps for its next search (12 KB each)
+const std::size_t MAX_POOLED_PAGES = 1024;
+}  // namespace
+
+const SearchSpace::Node SearchSpace::UNTOUCHED;
+
+SearchSpace::SearchSpace(int width, int height)
+    : pagesX((width + PAGE_SIZE - 1) >> PAGE_SHIFT),
+      pages(static_cast<std::size_t>(pagesX) * ((height + PAGE_SIZE - 1) >> PAGE_SHIFT), nullptr) {}
+
+SearchSpace::~SearchSpace() {
+    auto& pool = pagePool();
+    for (auto& page : used) {
+        if (pool.size() >= MAX_POOLED_PAGES) {
+            break;
+        }
+        pool.push_back(std::move(page));
+    }
+}
+
+SearchSpace::Page* SearchSpace::acquirePage() {
+    auto& pool = pagePool();
+    if (pool.empty()) {
+        used.push_back(std::make_unique<Page>());
+    } else {
+        used.push_back(std::move(pool.back()));
+        pool.pop_back();
+        std::fill(std::begin(used.back()->nodes), std::end(used.back()->nodes), Node());
+    }
+    return used.back().get();
+}
+
+std::vector<std::unique_ptr<SearchSpace::Page>>& SearchSpace::pagePool() {
+    thread_local std::vector<std::unique_ptr<Page>> pool;
+    return pool;
+}
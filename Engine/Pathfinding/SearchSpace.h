@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Per-search node state (cost, parent, flags) kept in 32x32-cell pages that are
+// only allocated where the search goes. Pages are recycled through a per-thread
+// pool, so a search on a 4096x4096 map costs memory in proportion to the area it
+// explores rather than the size of the map.
+class SearchSpace {
+public:
+    static constexpr std::uint8_t CLOSED = 1;
+
+    struct Node {
+        float cost = std::numeric_limits<float>::max();
+        int parent = -1;  // Row-major cell
+        std::uint8_t flags = 0;
+    };
+
+    SearchSpace(int width, int height);
+    ~SearchSpace();
+
+    SearchSpace(const SearchSpace&) = delete;
+    SearchSpace& operator=(const SearchSpace&) = delete;
+
+    // Cells the search hasn't touched read as a default node
+    const Node& get(int x, int y) const {
+        const Page* page = pages[pageIndex(x, y)];
+        return page ? page->nodes[localIndex(x, y)] : UNTOUCHED;
+    }
+
+    Node& at(int x, int y) {
+        Page*& page = pages[pageIndex(x, y)];
+        if (!page) {
+            page = acquirePage();
+        }
+        return page->nodes[localIndex(x, y)];
+    }
+
+    std::size_t getPageCount() const { return used.size(); }
+
+private:
+    static constexpr int PAGE_SHIFT = 5;
+    static constexpr int PAGE_SIZE = 1 << PAGE_SHIFT;
+
+    struct Page {
+        Node nodes[PAGE_SIZE * PAGE_SIZE];
+    };
+
+    static const Node UNTOUCHED;
+
+    std::size_t pageIndex(int x, int y) const {
+        return static_cast<std::size_t>(y >> PAGE_SHIFT) * pagesX + (x >> PAGE_SHIFT);
+    }
+
+    static int localIndex(int x, int y) {
+        return ((y & (PAGE_SIZE - 1)) << PAGE_SHIFT) | (x & (PAGE_SIZE - 1));
+    }
+
+    Page* acquirePage();
+    static std::vector<std::unique_ptr<Page>>& pagePool();
+
+    int pagesX;
+    std::vector<Page*> pages;
+    std::vector<std::unique_ptr<Page>> used;
+};
@@ -0,0 +1,269 @@
+#include "BodyKernels.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define BODY_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define KERNEL_TARGET_SSE2
+#define KERNEL_TARGET_AVX2
+#else
+// Compiled for these instruction sets whatever the build targets; only called
+// once the CPU is known to have them
+#define KERNEL_TARGET_SSE2 __attribute__((target("sse2")))
+#define KERNEL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+SimdLevel detectSimdLevel() {
+#ifdef BODY_KERNELS_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    const bool osSavesAvx = (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 &&
+                            (_xgetbv(0) & 0x6) == 0x6;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osSavesAvx) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    const bool sse2 = __builtin_cpu_supports("sse2");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) return SimdLevel::AVX2;
+    if (sse2) return SimdLevel::SSE2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel& activeSimdLevel() {
+    static SimdLevel level = getSupportedSimdLevel();
+    return level;
+}
+
+// Each kernel handles [begin, count); the SIMD ones return where they stopped
+// so the scalar loop can finish the tail
+
+void integrateScalar(IntegrationBatch& b, std::size_t begin, float deltaTime) {
+    for (std::size_t i = begin; i < b.size(); ++i) {
+        b.velocityX[i] = b.velocityX[i] + b.accelerationX[i] * deltaTime;
+        b.velocityY[i] = b.velocityY[i] + b.accelerationY[i] * deltaTime;
+        b.x[i] = b.x[i] + b.velocityX[i] * deltaTime;
+        b.y[i] = b.y[i] + b.velocityY[i] * deltaTime;
+        b.velocityX[i] = b.velocityX[i] * b.decay[i];
+        b.velocityY[i] = b.velocityY[i] * b.decay[i];
+    }
+}
+
+void seekScalar(SeekBatch& b, std::size_t begin) {
+    for (std::size_t i = begin; i < b.size(); ++i) {
+        float dx = b.targetX[i] - b.x[i];
+        float dy = b.targetY[i] - b.y[i];
+        float distance = std::sqrt(dx * dx + dy * dy);
+        bool arrived = distance <= b.arrivalRadius[i];
+        b.velocityX[i] = arrived ? 0.0f : dx / distance * b.speed[i];
+        b.velocityY[i] = arrived ? 0.0f : dy / distance * b.speed[i];
+        b.arrived[i] = arrived ? 1 : 0;
+    }
+}
+
+#ifdef BODY_KERNELS_X86
+KERNEL_TARGET_SSE2 std::size_t integrateSSE2(IntegrationBatch& b, float deltaTime) {
+    const std::size_t count = b.size();
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_add_ps(_mm_loadu_ps(&b.velocityX[i]), _mm_mul_ps(_mm_loadu_ps(&b.accelerationX[i]), dt));
+        __m128 vy = _mm_add_ps(_mm_loadu_ps(&b.velocityY[i]), _mm_mul_ps(_mm_loadu_ps(&b.accelerationY[i]), dt));
+        _mm_storeu_ps(&b.x[i], _mm_add_ps(_mm_loadu_ps(&b.x[i]), _mm_mul_ps(vx, dt)));
+        _mm_storeu_ps(&b.y[i], _mm_add_ps(_mm_loadu_ps(&b.y[i]), _mm_mul_ps(vy, dt)));
+        __m128 decay = _mm_loadu_ps(&b.decay[i]);
+        _mm_storeu_ps(&b.velocityX[i], _mm_mul_ps(vx, decay));
+        _mm_storeu_ps(&b.velocityY[i], _mm_mul_ps(vy, decay));
+    }
+    return i;
+}
+
+KERNEL_TARGET_AVX2 std::size_t integrateAVX2(IntegrationBatch& b, float deltaTime) {
+    const std::size_t count = b.size();
+    const __m256 dt = _mm256_set1_ps(deltaTime);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 vx = _mm256_add_ps(_mm256_loadu_ps(&b.velocityX[i]), _mm256_mul_ps(_mm256_loadu_ps(&b.accelerationX[i]), dt));
+        __m256 vy = _mm256_add_ps(_mm256_loadu_ps(&b.velocityY[i]), _mm256_mul_ps(_mm256_loadu_ps(&b.accelerationY[i]), dt));
+        _mm256_storeu_ps(&b.x[i], _mm256_add_ps(_mm256_loadu_ps(&b.x[i]), _mm256_mul_ps(vx, dt)));
+        _mm256_storeu_ps(&b.y[i], _mm256_add_ps(_mm256_loadu_ps(&b.y[i]), _mm256_mul_ps(vy, dt)));
+        __m256 decay = _mm256_loadu_ps(&b.decay[i]);
+        _mm256_storeu_ps(&b.velocityX[i], _mm256_mul_ps(vx, decay));
+        _mm256_storeu_ps(&b.velocityY[i], _mm256_mul_ps(vy, decay));
+    }
+    return i;
+}
+
+KERNEL_TARGET_SSE2 std::size_t seekSSE2(SeekBatch& b) {
+    const std::size_t count = b.size();
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(&b.targetX[i]), _mm_loadu_ps(&b.x[i]));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(&b.targetY[i]), _mm_loadu_ps(&b.y[i]));
+        __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        __m128 arrived = _mm_cmple_ps(distance, _mm_loadu_ps(&b.arrivalRadius[i]));
+        __m128 speed = _mm_loadu_ps(&b.speed[i]);
+
+        // Arrived lanes may have divided by zero; they are masked to zero
+        _mm_storeu_ps(&b.velocityX[i], _mm_andnot_ps(arrived, _mm_mul_ps(_mm_div_ps(dx, distance), speed)));
+        _mm_storeu_ps(&b.velocityY[i], _mm_andnot_ps(arrived, _mm_mul_ps(_mm_div_ps(dy, distance), speed)));
+        const int mask = _mm_movemask_ps(arrived);
+        for (int lane = 0; lane < 4; ++lane) {
+            b.arrived[i + lane] = static_cast<std::uint8_t>((mask >> lane) & 1);
+        }
+    }
+    return i;
+}
+
+KERNEL_TARGET_AVX2 std::size_t seekAVX2(SeekBatch& b) {
+    const std::size_t count = b.size();
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(&b.targetX[i]), _mm256_loadu_ps(&b.x[i]));
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(&b.targetY[i]), _mm256_loadu_ps(&b.y[i]));
+        __m256 distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        __m256 arrived = _mm256_cmp_ps(distance, _mm256_loadu_ps(&b.arrivalRadius[i]), _CMP_LE_OQ);
+        __m256 speed = _mm256_loadu_ps(&b.speed[i]);
+
+        _mm256_storeu_ps(&b.velocityX[i], _mm256_andnot_ps(arrived, _mm256_mul_ps(_mm256_div_ps(dx, distance), speed)));
+        _mm256_storeu_ps(&b.velocityY[i], _mm256_andnot_ps(arrived, _mm256_mul_ps(_mm256_div_ps(dy, distance), speed)));
+        const int mask = _mm256_movemask_ps(arrived);
+        for (int lane = 0; lane < 8; ++lane) {
+            b.arrived[i + lane] = static_cast<std::uint8_t>((mask >> lane) & 1);
+        }
+    }
+    return i;
+}
+#endif
+}  // namespace
+
+SimdLevel getSupportedSimdLevel() {
+    static const SimdLevel level = detectSimdLevel();
+    return level;
+}
+
+SimdLevel getSimdLevel() {
+    return activeSimdLevel();
+}
+
+void setSimdLevel(SimdLevel level) {
+    activeSimdLevel() = std::min(level, getSupportedSimdLevel());
+}
+
+const char* getSimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "avx2";
+        case SimdLevel::SSE2: return "sse2";
+        default:              return "scalar";
+    }
+}
+
+void IntegrationBatch::clear() {
+    x.clear();
+    y.clear();
+    velocityX.clear();
+    velocityY.clear();
+    accelerationX.clear();
+    accelerationY.clear();
+    decay.clear();
+}
+
+void IntegrationBatch::resize(std::size_t count) {
+    x.resize(count);
+    y.resize(count);
+    velocityX.resize(count);
+    velocityY.resize(count);
+    accelerationX.resize(count);
+    accelerationY.resize(count);
+    decay.resize(count);
+}
+
+void IntegrationBatch::add(Vector2 position, Vector2 velocity, Vector2 acceleration, float decay) {
+    resize(size() + 1);
+    set(size() - 1, position, velocity, acceleration, decay);
+}
+
+void IntegrationBatch::set(std::size_t lane, Vector2 position, Vector2 velocity, Vector2 acceleration, float decay) {
+    x[lane] = position.x;
+    y[lane] = position.y;
+    velocityX[lane] = velocity.x;
+    velocityY[lane] = velocity.y;
+    accelerationX[lane] = acceleration.x;
+    accelerationY[lane] = acceleration.y;
+    this->decay[lane] = decay;
+}
+
+void IntegrationBatch::integrate(float deltaTime) {
+    std::size_t done = 0;
+#ifdef BODY_KERNELS_X86
+    switch (getSimdLevel()) {
+        case SimdLevel::AVX2: done = integrateAVX2(*this, deltaTime); break;
+        case SimdLevel::SSE2: done = integrateSSE2(*this, deltaTime); break;
+        default: break;
+    }
+#endif
+    integrateScalar(*this, done, deltaTime);
+}
+
+void SeekBatch::clear() {
+    x.clear();
+    y.clear();
+    targetX.clear();
+    targetY.clear();
+    speed.clear();
+    arrivalRadius.clear();
+}
+
+void SeekBatch::resize(std::size_t count) {
+    x.resize(count);
+    y.resize(count);
+    targetX.resize(count);
+    targetY.resize(count);
+    speed.resize(count);
+    arrivalRadius.resize(count);
+}
+
+void SeekBatch::add(Vector2 position, Vector2 target, float speed, float arrivalRadius) {
+    resize(size() + 1);
+    set(size() - 1, position, target, speed, arrivalRadius);
+}
+
+void SeekBatch::set(std::size_t lane, Vector2 position, Vector2 target, float speed, float arrivalRadius) {
+    x[lane] = position.x;
+    y[lane] = position.y;
+    targetX[lane] = target.x;
+    targetY[lane] = target.y;
+    this->speed[lane] = speed;
+    this->arrivalRadius[lane] = arrivalRadius;
+}
+
+void SeekBatch::solve() {
+    const std::size_t count = size();
+    velocityX.resize(count);
+    velocityY.resize(count);
+    arrived.resize(count);
+
+    std::size_t done = 0;
+#ifdef BODY_KERNELS_X86
+    switch (getSimdLevel()) {
+        case SimdLevel::AVX2: done = seekAVX2(*this); break;
+        case SimdLevel::SSE2: done = seekSSE2(*this); break;
+        default: break;
+    }
+#endif
+    seekScalar(*this, done);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "../Math/Vector2.h"
+
+// Batch forms of the per-body math in PhysicsSystem and MovementSystem over
+// structure-of-arrays data. Every kernel has a scalar loop plus SSE2 and AVX2
+// versions; the widest one the CPU supports is picked at startup. All levels
+// do the same operations in the same order (no fused multiply-add), so they
+// give bit-identical results.
+
+enum class SimdLevel { Scalar, SSE2, AVX2 };
+
+// Widest level this CPU and build support, detected once
+SimdLevel getSupportedSimdLevel();
+
+// Level the kernels run at; defaults to the supported one
+SimdLevel getSimdLevel();
+
+// Caps the kernels to level (or the supported one, if lower), for benchmarks
+void setSimdLevel(SimdLevel level);
+
+const char* getSimdLevelName(SimdLevel level);
+
+// Moving bodies for one explicit Euler step
+struct IntegrationBatch {
+    std::vector<float> x, y;
+    std::vector<float> velocityX, velocityY;
+    std::vector<float> accelerationX, accelerationY;
+    std::vector<float> decay;  // Share of velocity friction leaves after the step
+
+    // Filling by lane after a resize() skips the per-array capacity checks of add()
+    void clear();
+    void resize(std::size_t count);
+    void add(Vector2 position, Vector2 velocity, Vector2 acceleration, float decay);
+    void set(std::size_t lane, Vector2 position, Vector2 velocity, Vector2 acceleration, float decay);
+    std::size_t size() const { return x.size(); }
+
+    // velocity += acceleration * dt; position += velocity * dt; velocity *= decay
+    void integrate(float deltaTime);
+};
+
+// Units heading for a target point at full speed
+struct SeekBatch {
+    std::vector<float> x, y;
+    std::vector<float> targetX, targetY;
+    std::vector<float> speed;
+    std::vector<float> arrivalRadius;
+
+    // Output: velocity straight at the target, zero once within arrivalRadius
+    std::vector<float> velocityX, velocityY;
+    std::vector<std::uint8_t> arrived;
+
+    void clear();
+    void resize(std::size_t count);
+    void add(Vector2 position, Vector2 target, float speed, float arrivalRadius);
+    void set(std::size_t lane, Vector2 position, Vector2 target, float speed, float arrivalRadius);
+    std::size_t size() const { return x.size(); }
+
+    void solve();
+};
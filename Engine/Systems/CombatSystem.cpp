@@ -1,8 +1,29 @@
 #include "CombatSystem.h"
+#include <algorithm>
+
+namespace {
+// Indexed positions are from before collision response; the slack covers the push
+const float TARGET_SLACK = 8.0f;
+// Attackers without a target look again this often; first searches are spread
+// over RETARGET_PHASES frames' worth of it so a new army doesn't search at once
+const float IDLE_SEARCH_INTERVAL = 0.25f;
+const int RETARGET_PHASES = 8;
+
+std::uint64_t cellKey(SpatialIndex::Cell cell) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cell.x)) << 32) | static_cast<std::uint32_t>(cell.y);
+}
+}  // namespace
 
 void CombatSystem::update(float deltaTime) {
+    if (combatantsVersion != membershipVersion) {
+        cacheCombatants();
+    }
+
     updateAttackCooldowns(deltaTime);
     performAttacks();
+    projectiles.update(deltaTime);
+    applyHits();
+    resolveDamage();
 }
 
 void CombatSystem::setRequiredComponents() {
@@ -11,85 +32,336 @@ void CombatSystem::setRequiredComponents() {
     require<TeamComponent>();
 }
 
+void CombatSystem::setEventSystem(std::shared_ptr<EventSystem> events) {
+    eventSystem = std::move(events);
+    damageChannel = eventSystem ? &eventSystem->channel<DamageEvent>() : nullptr;
+    destroyedChannel = eventSystem ? &eventSystem->channel<EntityDestroyedEvent>() : nullptr;
+}
+
+void CombatSystem::setSpatialIndex(std::shared_ptr<const SpatialIndex> index) {
+    spatialIndex = index;
+    projectiles.setSpatialIndex(std::move(index));
+}
+
+void CombatSystem::cacheCombatants() {
+    combatants.clear();
+    slots.clear();
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+        const auto& entity = entities[i];
+        Combatant combatant;
+        combatant.transform = entity->getComponent<TransformComponent>().get();
+        combatant.health = entity->getComponent<HealthComponent>().get();
+        combatant.team = entity->getComponent<TeamComponent>().get();
+        combatant.combat = entity->getComponent<CombatComponent>().get();
+        combatant.eventTags = EventTags::of(*entity);
+        combatant.coverage = nullptr;
+        combatants.push_back(combatant);
+        slots[entity->getId()] = i;
+    }
+    cacheCoverage();
+    combatantsVersion = membershipVersion;
+}
+
+void CombatSystem::cacheCoverage() {
+    if (!spatialIndex) {
+        return;
+    }
+
+    // Turrets keep the cells found when they were placed; only new ones, and
+    // ones whose range changed, are worked out here
+    const float cellSize = spatialIndex->getCellSize();
+    bool changed = false;
+    for (std::size_t slot = 0; slot < entities.size(); ++slot) {
+        Combatant& combatant = combatants[slot];
+        if (!combatant.combat || entities[slot]->hasComponent<PhysicsComponent>()) continue;
+
+        Coverage& coverage = coverages[entities[slot]->getId()];
+        if (coverage.cells.empty() || coverage.range != combatant.combat->attackRange || coverage.cellSize != cellSize) {
+            coverage.range = combatant.combat->attackRange;
+            coverage.cellSize = cellSize;
+            spatialIndex->cellsWithin(combatant.transform->position, coverage.range + TARGET_SLACK, coverage.cells);
+            changed = true;
+        }
+        combatant.coverage = &coverage;
+    }
+
+    for (auto it = coverages.begin(); it != coverages.end(); ) {
+        if (findSlot(it->first) == entities.size()) {
+            it = coverages.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+
+    if (changed) {
+        threatCells.clear();
+        for (const auto& [id, coverage] : coverages) {
+            for (SpatialIndex::Cell cell : coverage.cells) {
+                threatCells[cellKey(cell)].push_back(id);
+            }
+        }
+        for (auto& [key, ids] : threatCells) {
+            std::sort(ids.begin(), ids.end());
+        }
+    }
+}
+
 void CombatSystem::updateAttackCooldowns(float deltaTime) {
-    for (auto& entity : entities) {
-        auto combat = entity->getComponent<CombatComponent>();
-        if (combat && combat->attackCooldownTimer > 0.0f) {
-            combat->attackCooldownTimer -= deltaTime;
+    readyAttackers.clear();
+    for (std::size_t i = 0; i < combatants.size(); ++i) {
+        const Combatant& combatant = combatants[i];
+        if (!combatant.combat) continue;
+        if (combatant.combat->attackCooldownTimer > 0.0f) {
+            combatant.combat->attackCooldownTimer -= deltaTime;
+        }
+        if (combatant.combat->retargetTimer > 0.0f) {
+            combatant.combat->retargetTimer = std::max(0.0f, combatant.combat->retargetTimer - deltaTime);
+        }
+        if (combatant.combat->attackCooldownTimer <= 0.0f) {
+            readyAttackers.push_back(i);
         }
     }
 }
 
 void CombatSystem::performAttacks() {
-    for (auto& entity : entities) {
-        if (!entity || !entity->isActive() || entity->isDestroyed()) {
+    // Only attackers off cooldown; most of an army is waiting on any one step
+    for (std::size_t i : readyAttackers) {
+        const auto& entity = entities[i];
+        if (!entity->isActive() || entity->isDestroyed()) {
             continue;
         }
 
-        auto combat = entity->getComponent<CombatComponent>();
-        if (!combat || combat->attackCooldownTimer > 0.0f) continue;
+        CombatComponent* combat = combatants[i].combat;
 
         auto commandTarget = resolveCommandTarget(entity);
         if (commandTarget) {
-            auto attackerTransform = entity->getComponent<TransformComponent>();
-            auto targetTransform = commandTarget->getComponent<TransformComponent>();
-            if (attackerTransform && targetTransform &&
-                attackerTransform->position.distance(targetTransform->position) <= combat->attackRange) {
-                dealDamage(commandTarget, combat->attackDamage);
-                combat->attackCooldownTimer = combat->attackCooldown;
+            const Combatant& target = combatants[findSlot(commandTarget->getId())];
+            if (combatants[i].transform->position.isWithin(target.transform->position, combat->attackRange)) {
+                attack(i, commandTarget);
                 continue;
             }
         }
 
-        auto targets = findTargetsInRange(entity);
-        if (!targets.empty()) {
-            dealDamage(targets[0], combat->attackDamage);
-            combat->attackCooldownTimer = combat->attackCooldown;
+        if (auto target = acquireTarget(i)) {
+            attack(i, target);
         }
     }
 }
 
+void CombatSystem::attack(std::size_t attackerSlot, const std::shared_ptr<Entity>& target) {
+    const Combatant& attacker = combatants[attackerSlot];
+    CombatComponent& combat = *attacker.combat;
+    combat.attackCooldownTimer = combat.attackCooldown;
+
+    DamageProfile profile;
+    profile.damage = combat.attackDamage;
+    profile.type = combat.damageType;
+    profile.splashRadius = combat.splashRadius;
+    profile.burnDuration = combat.burnDuration;
+
+    // Shots aren't led: they fly at where the target stands now
+    Vector2 aim = combatants[findSlot(target->getId())].transform->position;
+    if (combat.projectileSpeed > 0.0f) {
+        projectiles.spawn(attacker.transform->position, aim, combat.projectileSpeed, attacker.team->faction, profile);
+    } else {
+        projectiles.strike(target, aim, attacker.team->faction, profile);
+    }
+}
+
+void CombatSystem::applyHits() {
+    for (const Projectiles::Hit& hit : projectiles.getHits()) {
+        dealDamage(hit.target, hit.damage);
+    }
+    projectiles.clearHits();
+}
+
 void CombatSystem::dealDamage(std::shared_ptr<Entity> target, float damage) {
-    auto health = target->getComponent<HealthComponent>();
-    if (!health) return;
-    
-    health->currentHealth -= damage;
-    
-    if (health->currentHealth <= 0.0f) {
-        target->destroy();
-    }
-}
-
-std::vector<std::shared_ptr<Entity>> CombatSystem::findTargetsInRange(std::shared_ptr<Entity> attacker, float overrideRange) {
-    std::vector<std::shared_ptr<Entity>> targets;
-    
-    auto attackerTransform = attacker->getComponent<TransformComponent>();
-    auto attackerCombat = attacker->getComponent<CombatComponent>();
-    auto attackerTeam = attacker->getComponent<TeamComponent>();
-    
-    if (!attackerTransform || !attackerCombat || !attackerTeam) return targets;
-
-    float range = overrideRange > 0.0f ? overrideRange : attackerCombat->attackRange;
-    
-    for (auto& entity : entities) {
-        if (!entity || !entity->isActive() || entity->isDestroyed()) {
-            continue;
+    damageBuffer.push_back({std::move(target), damage, static_cast<std::uint32_t>(damageBuffer.size())});
+}
+
+void CombatSystem::resolveDamage() {
+    if (damageBuffer.empty()) {
+        return;
+    }
+
+    // By target, then in the order dealt, so the outcome doesn't depend on how
+    // the attackers happened to be ordered in memory
+    std::sort(damageBuffer.begin(), damageBuffer.end(), [](const PendingDamage& a, const PendingDamage& b) {
+        EntityID idA = a.target->getId();
+        EntityID idB = b.target->getId();
+        return idA != idB ? idA < idB : a.order < b.order;
+    });
+
+    for (std::size_t begin = 0; begin < damageBuffer.size(); ) {
+        const std::shared_ptr<Entity>& target = damageBuffer[begin].target;
+        std::size_t end = begin;
+        float total = 0.0f;
+        for (; end < damageBuffer.size() && damageBuffer[end].target == target; ++end) {
+            total += damageBuffer[end].damage;
         }
-        if (entity->getId() == attacker->getId()) continue;
-        
-        auto targetTransform = entity->getComponent<TransformComponent>();
-        auto targetTeam = entity->getComponent<TeamComponent>();
-        if (!targetTransform || !targetTeam) continue;
-        if (targetTeam->faction == attackerTeam->faction) continue;
-        if (targetTeam->faction == Faction::Neutral) continue;
-        
-        float distance = attackerTransform->position.distance(targetTransform->position);
-        if (distance <= range) {
-            targets.push_back(entity);
+        begin = end;
+
+        auto health = target->getComponent<HealthComponent>();
+        if (!health || target->isDestroyed()) continue;
+
+        // A unit under fire reacts even if it had gone to sleep
+        target->wake();
+        health->currentHealth -= total;
+        EventMask tags = 0;
+        if (eventSystem) {
+            // Splash can reach entities this system doesn't track
+            std::size_t slot = findSlot(target->getId());
+            tags = slot < combatants.size() ? combatants[slot].eventTags : EventTags::of(*target);
         }
+        if (damageChannel) {
+            damageChannel->publish({target->getId(), total}, tags);
+        }
+
+        if (health->currentHealth <= 0.0f) {
+            target->destroy();
+            if (destroyedChannel) {
+                destroyedChannel->publish({target->getId()}, tags);
+            }
+        }
+    }
+    damageBuffer.clear();
+}
+
+std::shared_ptr<Entity> CombatSystem::findBestTarget(const std::shared_ptr<Entity>& attacker, float overrideRange) {
+    if (combatantsVersion != membershipVersion) {
+        cacheCombatants();
+    }
+
+    std::size_t attackerSlot = findSlot(attacker->getId());
+    if (attackerSlot == entities.size() || !combatants[attackerSlot].combat) return nullptr;
+
+    const Combatant& self = combatants[attackerSlot];
+    const Vector2 position = self.transform->position;
+    const float range = overrideRange > 0.0f ? overrideRange : self.combat->attackRange;
+    const TargetPriority priority = self.combat->targetPriority;
+
+    // Lowest (rank, distance, id) wins, so ties don't depend on query order
+    std::size_t best = entities.size();
+    float bestRank = 0.0f;
+    float bestDistanceSq = 0.0f;
+    auto consider = [&](std::size_t slot) {
+        if (slot == attackerSlot) return;
+        const auto& entity = entities[slot];
+        if (!entity->isActive() || entity->isDestroyed()) return;
+
+        const Combatant& candidate = combatants[slot];
+        if (candidate.team->faction == self.team->faction) return;
+        if (candidate.team->faction == Faction::Neutral) return;
+
+        float distanceSq = position.distanceSquared(candidate.transform->position);
+        if (distanceSq > range * range) return;
+
+        float rank = priority == TargetPriority::LowestHealth ? candidate.health->currentHealth : 0.0f;
+        if (best != entities.size()) {
+            if (rank > bestRank) return;
+            if (rank == bestRank) {
+                if (distanceSq > bestDistanceSq) return;
+                if (distanceSq == bestDistanceSq && entity->getId() > entities[best]->getId()) return;
+            }
+        }
+        best = slot;
+        bestRank = rank;
+        bestDistanceSq = distanceSq;
+    };
+
+    if (spatialIndex) {
+        auto visit = [&](std::size_t item) {
+            std::size_t slot = findSlot(spatialIndex->getEntity(item)->getId());
+            if (slot != entities.size()) {
+                consider(slot);
+            }
+        };
+        const Coverage* coverage = self.coverage;
+        if (coverage && coverage->range == range && coverage->cellSize == spatialIndex->getCellSize()) {
+            // Turrets only look in the cells they cover
+            const float reachSq = (range + TARGET_SLACK) * (range + TARGET_SLACK);
+            for (SpatialIndex::Cell cell : coverage->cells) {
+                spatialIndex->forEachInCell(cell, [&](std::size_t item) {
+                    if (position.distanceSquared(spatialIndex->getPosition(item)) <= reachSq) {
+                        visit(item);
+                    }
+                });
+            }
+        } else {
+            spatialIndex->forEachInRadius(position, range + TARGET_SLACK, visit);
+        }
+    } else {
+        for (std::size_t slot = 0; slot < entities.size(); ++slot) {
+            consider(slot);
+        }
+    }
+
+    return best != entities.size() ? entities[best] : nullptr;
+}
+
+void CombatSystem::findThreats(Vector2 position, Faction faction, std::vector<std::shared_ptr<Entity>>& out) {
+    out.clear();
+    if (combatantsVersion != membershipVersion) {
+        cacheCombatants();
+    }
+    if (!spatialIndex) {
+        return;
+    }
+
+    auto it = threatCells.find(cellKey(spatialIndex->cellAt(position)));
+    if (it == threatCells.end()) {
+        return;
+    }
+    for (EntityID id : it->second) {
+        std::size_t slot = findSlot(id);
+        const auto& defence = entities[slot];
+        const Combatant& combatant = combatants[slot];
+        if (!defence->isActive() || defence->isDestroyed()) continue;
+        if (combatant.team->faction == faction || combatant.team->faction == Faction::Neutral) continue;
+        if (position.isWithin(combatant.transform->position, combatant.combat->attackRange)) {
+            out.push_back(defence);
+        }
+    }
+}
+
+std::shared_ptr<Entity> CombatSystem::acquireTarget(std::size_t attackerSlot) {
+    const auto& attacker = entities[attackerSlot];
+    CombatComponent& combat = *combatants[attackerSlot].combat;
+    if (combat.retargetTimer < 0.0f) {
+        combat.retargetTimer = IDLE_SEARCH_INTERVAL * static_cast<float>(attacker->getId() % RETARGET_PHASES) /
+                               RETARGET_PHASES;
     }
-    
-    return targets;
+
+    // A target that died, was hidden or moved out of range is replaced at once;
+    // a valid one only when the timer is up
+    bool hadTarget = combat.currentTarget != 0;
+    std::size_t targetSlot = findSlot(combat.currentTarget);
+    if (isValidTarget(attackerSlot, targetSlot)) {
+        if (combat.retargetTimer > 0.0f) {
+            return entities[targetSlot];
+        }
+    } else {
+        combat.currentTarget = 0;
+        if (!hadTarget && combat.retargetTimer > 0.0f) {
+            return nullptr;
+        }
+    }
+
+    auto target = findBestTarget(attacker);
+    combat.currentTarget = target ? target->getId() : 0;
+    combat.retargetTimer = target ? combat.retargetInterval : IDLE_SEARCH_INTERVAL;
+    return target;
+}
+
+bool CombatSystem::isValidTarget(std::size_t attackerSlot, std::size_t targetSlot) const {
+    if (targetSlot == entities.size()) return false;
+    const auto& target = entities[targetSlot];
+    if (!target->isActive() || target->isDestroyed()) return false;
+
+    const Combatant& attacker = combatants[attackerSlot];
+    return attacker.transform->position.isWithin(combatants[targetSlot].transform->position,
+                                                 attacker.combat->attackRange);
 }
 
 std::shared_ptr<Entity> CombatSystem::resolveCommandTarget(const std::shared_ptr<Entity>& attacker) {
@@ -98,11 +370,15 @@ std::shared_ptr<Entity> CombatSystem::resolveCommandTarget(const std::shared_ptr
         return nullptr;
     }
 
-    for (auto& entity : entities) {
-        if (entity && entity->getId() == command->targetEntityId && entity->isActive() && !entity->isDestroyed()) {
-            return entity;
-        }
+    std::size_t slot = findSlot(command->targetEntityId);
+    if (slot == entities.size()) {
+        return nullptr;
     }
+    const auto& entity = entities[slot];
+    return entity->isActive() && !entity->isDestroyed() ? entity : nullptr;
+}
 
-    return nullptr;
+std::size_t CombatSystem::findSlot(EntityID id) const {
+    auto it = slots.find(id);
+    return it != slots.end() ? it->second : entities.size();
 }
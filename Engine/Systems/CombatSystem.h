@@ -1,14 +1,35 @@
 #pragma once
 
+#include <cstdint>
+#include <unordered_map>
 #include "../ECS/System.h"
 #include "../ECS/Component.h"
+#include "EventSystem.h"
+#include "Projectiles.h"
+#include "SpatialIndex.h"
+
+// How an attacker picks among the enemies in range
+enum class TargetPriority {
+    Nearest,
+    LowestHealth  // Finish off the weakest, nearest first on ties
+};
 
 struct CombatComponent : public Component {
     float attackDamage = 10.0f;
     float attackRange = 50.0f;
     float attackCooldown = 1.0f;
     float attackCooldownTimer = 0.0f;
-    std::string damageType = "Physical";
+    DamageType damageType = DamageType::Physical;
+    float projectileSpeed = 0.0f;  // 0 hits at once
+    float splashRadius = 0.0f;     // Explosive
+    float burnDuration = 0.0f;     // Fire
+    TargetPriority targetPriority = TargetPriority::Nearest;
+
+    // Target kept between attacks while it stays alive, active and in range;
+    // the best target is looked for again every retargetInterval seconds
+    EntityID currentTarget = 0;
+    float retargetInterval = 2.0f;
+    float retargetTimer = -1.0f;  // Below zero until the first search is scheduled
     
     CombatComponent() = default;
 };
@@ -18,14 +39,78 @@ public:
     void update(float deltaTime) override;
     void setRequiredComponents() override;
     
-    // Deal damage to entity
+    // Queue damage for the entity; queued damage is applied together at the end
+    // of the step, in entity id order, and deaths happen then
     void dealDamage(std::shared_ptr<Entity> target, float damage);
     
-    // Find nearby enemies
-    std::vector<std::shared_ptr<Entity>> findTargetsInRange(std::shared_ptr<Entity> attacker, float overrideRange = -1.0f);
+    // Best enemy in range by the attacker's target priority, or null
+    std::shared_ptr<Entity> findBestTarget(const std::shared_ptr<Entity>& attacker, float overrideRange = -1.0f);
+
+    // Index built by physics, so only entities with colliders are found; without
+    // one, targets are found by scanning every entity and shots never connect
+    void setSpatialIndex(std::shared_ptr<const SpatialIndex> index);
+
+    // Shots in flight and burns, for drawing
+    const Projectiles& getProjectiles() const { return projectiles; }
+
+    // Enemy turrets whose range covers position, looked up in the cells each
+    // one was found to cover when it was placed
+    void findThreats(Vector2 position, Faction faction, std::vector<std::shared_ptr<Entity>>& out);
+
+    // Where each step's DamageEvents (one per entity hit, in id order) and
+    // EntityDestroyedEvents go
+    void setEventSystem(std::shared_ptr<EventSystem> events);
 
 private:
+    // Grid cells a static attacker's range reaches, worked out once when it
+    // is placed since it never moves
+    struct Coverage {
+        float range;     // Attack range the cells were worked out for
+        float cellSize;  // And the index's cell size
+        std::vector<SpatialIndex::Cell> cells;
+    };
+
+    // Components of one entity, cached until the entity list changes
+    struct Combatant {
+        TransformComponent* transform;
+        HealthComponent* health;
+        TeamComponent* team;
+        CombatComponent* combat;  // Null for entities that can't attack
+        EventMask eventTags;      // For events about this entity
+        const Coverage* coverage;  // Attackers without physics only
+    };
+
+    // Damage owed to one entity, in the order it was dealt
+    struct PendingDamage {
+        std::shared_ptr<Entity> target;
+        float damage;
+        std::uint32_t order;  // Position in the buffer when dealt
+    };
+
+    std::shared_ptr<const SpatialIndex> spatialIndex;
+    std::shared_ptr<EventSystem> eventSystem;
+    EventChannel<DamageEvent>* damageChannel = nullptr;
+    EventChannel<EntityDestroyedEvent>* destroyedChannel = nullptr;
+    Projectiles projectiles;
+    std::vector<PendingDamage> damageBuffer;
+    std::vector<Combatant> combatants;  // Parallel to entities
+    std::unordered_map<EntityID, std::size_t> slots;  // Index of each entity in entities
+    std::unordered_map<EntityID, Coverage> coverages;
+    std::unordered_map<std::uint64_t, std::vector<EntityID>> threatCells;  // Static attackers covering each cell, by id
+    std::vector<std::size_t> readyAttackers;  // Slots off cooldown this step
+    std::uint64_t combatantsVersion = ~std::uint64_t(0);
+
+    void cacheCombatants();
+    void cacheCoverage();
     void updateAttackCooldowns(float deltaTime);
     void performAttacks();
+    void attack(std::size_t attackerSlot, const std::shared_ptr<Entity>& target);
+    void applyHits();
+    void resolveDamage();
     std::shared_ptr<Entity> resolveCommandTarget(const std::shared_ptr<Entity>& attacker);
+    // Cached target if still valid, otherwise a new one when a search is due
+    std::shared_ptr<Entity> acquireTarget(std::size_t attackerSlot);
+    bool isValidTarget(std::size_t attackerSlot, std::size_t targetSlot) const;
+    // Slot of a live member entity, or entities.size()
+    std::size_t findSlot(EntityID id) const;
 };
@@ -0,0 +1,366 @@
+#include "CrowdSteering.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
+namespace {
+// Centre distance within which neighbours are considered
+const float NEIGHBOR_DISTANCE = 128.0f;
+// Seconds ahead agents avoid each other and blockers
+const float TIME_HORIZON = 0.5f;
+const float OBSTACLE_TIME_HORIZON = 0.5f;
+const float EPSILON = 0.00001f;
+// Units plan to pass a little closer than their colliders allow and leave the
+// last few pixels to collision response, which packs crowds tighter in gaps
+const float CROWD_PACKING = 0.8f;
+// Agents per work item, and fewest agents worth waking helper threads for
+const std::size_t AGENT_BLOCK = 64;
+const std::size_t PARALLEL_MIN_AGENTS = 512;
+
+float det(const Vector2& a, const Vector2& b) {
+    return a.x * b.y - a.y * b.x;
+}
+
+float dot(const Vector2& a, const Vector2& b) {
+    return a.x * b.x + a.y * b.y;
+}
+
+float absSq(const Vector2& v) {
+    return v.x * v.x + v.y * v.y;
+}
+
+bool isIdle(const CrowdSteering::Agent& agent) {
+    return agent.preferredVelocity.x == 0.0f && agent.preferredVelocity.y == 0.0f;
+}
+
+// Share of the avoidance a moving agent takes towards a moving neighbour: half,
+// shifted towards whoever is behind so queues drain from the front instead of
+// locking up symmetrically. Agents heading the same way always sum to one.
+float getResponsibility(const CrowdSteering::Agent& agent, Vector2 toNeighbor) {
+    float denominator = std::sqrt(absSq(agent.preferredVelocity) * absSq(toNeighbor));
+    if (denominator <= EPSILON) {
+        return 0.5f;
+    }
+    return 0.5f + 0.5f * dot(agent.preferredVelocity, toNeighbor) / denominator;
+}
+
+struct Neighbor {
+    float distanceSq;
+    std::size_t item;
+};
+}  // namespace
+
+CrowdSteering::~CrowdSteering() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& helper : helpers) {
+        if (helper.joinable()) {
+            helper.join();
+        }
+    }
+}
+
+void CrowdSteering::setSpatialIndex(std::shared_ptr<const SpatialIndex> index) {
+    spatialIndex = std::move(index);
+}
+
+void CrowdSteering::setThreadCount(std::size_t count) {
+    threadCount = std::max<std::size_t>(1, count);
+}
+
+void CrowdSteering::solve(std::vector<Agent>& agents, float deltaTime) {
+    if (!spatialIndex || deltaTime <= 0.0f) {
+        for (auto& agent : agents) {
+            agent.newVelocity = agent.preferredVelocity;
+            agent.movingNeighbors = 0;
+        }
+        return;
+    }
+
+    // Sleeping units aren't agents this step but stand aside like idle ones
+    itemKinds.resize(spatialIndex->size());
+    for (std::size_t item = 0; item < itemKinds.size(); ++item) {
+        itemKinds[item] = (spatialIndex->getFlags(item) & SpatialIndex::SLEEPING) ? ItemKind::IdleAgent : ItemKind::Other;
+    }
+    for (const auto& agent : agents) {
+        if (agent.item < itemKinds.size()) {
+            itemKinds[agent.item] = isIdle(agent) ? ItemKind::IdleAgent : ItemKind::MovingAgent;
+        }
+    }
+
+    std::size_t helperCount = 0;
+    if (agents.size() >= PARALLEL_MIN_AGENTS) {
+        std::size_t blocks = (agents.size() + AGENT_BLOCK - 1) / AGENT_BLOCK;
+        helperCount = std::min(threadCount, blocks) - 1;  // The calling thread works too
+    }
+    if (scratch.size() < helperCount + 1) {
+        scratch.resize(helperCount + 1);
+    }
+
+    jobAgents = &agents;
+    jobDeltaTime = deltaTime;
+    nextBlock = 0;
+    if (helperCount == 0) {
+        solveBlocks(scratch[0]);
+        return;
+    }
+
+    while (helpers.size() < helperCount) {
+        helpers.emplace_back(&CrowdSteering::helperLoop, this, helpers.size());
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++generation;
+        activeHelpers = helperCount;
+        runningHelpers = helperCount;
+    }
+    workAvailable.notify_all();
+    solveBlocks(scratch[0]);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this] { return runningHelpers == 0; });
+}
+
+void CrowdSteering::solveBlocks(Scratch& own) {
+    // Agents only read shared state and write themselves, so blocks run in any order
+    std::vector<Agent>& agents = *jobAgents;
+    for (;;) {
+        std::size_t begin = nextBlock.fetch_add(1) * AGENT_BLOCK;
+        if (begin >= agents.size()) {
+            break;
+        }
+        std::size_t end = std::min(agents.size(), begin + AGENT_BLOCK);
+        for (std::size_t i = begin; i < end; ++i) {
+            solveAgent(agents[i], jobDeltaTime, own.lines, own.projected);
+        }
+    }
+}
+
+void CrowdSteering::helperLoop(std::size_t helper) {
+    std::uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [&] { return stopping || (generation != seen && helper < activeHelpers); });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+        }
+
+        solveBlocks(scratch[helper + 1]);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--runningHelpers == 0) {
+            workDone.notify_all();
+        }
+    }
+}
+
+void CrowdSteering::solveAgent(Agent& agent, float deltaTime, std::vector<Line>& lines,
+                               std::vector<Line>& projected) const {
+    // Nearest solid neighbours, closest surface first
+    Neighbor nearest[MAX_NEIGHBORS];
+    int count = 0;
+    spatialIndex->forEachInRadius(agent.position, NEIGHBOR_DISTANCE, [&](std::size_t item) {
+        if (item == agent.item) return;
+        if (!(spatialIndex->getFlags(item) & SpatialIndex::SOLID)) return;
+
+        float gap = std::max(0.0f, agent.position.distance(spatialIndex->getPosition(item)) - spatialIndex->getRadius(item));
+        Neighbor candidate{gap * gap, item};
+        if (count == MAX_NEIGHBORS && candidate.distanceSq >= nearest[count - 1].distanceSq) return;
+
+        int slot = count < MAX_NEIGHBORS ? count++ : count - 1;
+        while (slot > 0 && nearest[slot - 1].distanceSq > candidate.distanceSq) {
+            nearest[slot] = nearest[slot - 1];
+            --slot;
+        }
+        nearest[slot] = candidate;
+    });
+
+    // Blockers first: linearProgram3 keeps the leading lines hard
+    lines.clear();
+    agent.movingNeighbors = 0;
+    std::size_t hardLines = 0;
+    const bool idle = isIdle(agent);
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool mobilePass = pass == 1;
+        for (int i = 0; i < count; ++i) {
+            const std::size_t item = nearest[i].item;
+            const bool mobile = (spatialIndex->getFlags(item) & SpatialIndex::MOBILE) != 0;
+            if (mobile != mobilePass) continue;
+
+            // Moving agents push through idle ones; those take the whole avoidance
+            float responsibility = 1.0f;
+            if (itemKinds[item] == ItemKind::IdleAgent && !idle) {
+                continue;
+            }
+            if (mobile && !idle) {
+                responsibility = getResponsibility(agent, spatialIndex->getPosition(item) - agent.position);
+            }
+
+            const float horizon = mobile ? TIME_HORIZON : OBSTACLE_TIME_HORIZON;
+            const float invHorizon = 1.0f / horizon;
+            const Vector2 relativePosition = spatialIndex->getPosition(item) - agent.position;
+            const Vector2 relativeVelocity = agent.velocity - spatialIndex->getVelocity(item);
+            const float distSq = absSq(relativePosition);
+            const float combinedRadius = (agent.radius + spatialIndex->getRadius(item)) * (mobile ? CROWD_PACKING : 1.0f);
+            const float combinedRadiusSq = combinedRadius * combinedRadius;
+
+            Line line;
+            Vector2 u;
+            if (distSq > combinedRadiusSq) {
+                // Velocity obstacle is a cone truncated by a circle at the horizon
+                const Vector2 w = relativeVelocity - relativePosition * invHorizon;
+                const float wLengthSq = absSq(w);
+                const float dotProduct = dot(w, relativePosition);
+                if (dotProduct < 0.0f && dotProduct * dotProduct > combinedRadiusSq * wLengthSq) {
+                    // Closest to the cut-off circle
+                    const float wLength = std::sqrt(wLengthSq);
+                    const Vector2 unitW = w / wLength;
+                    line.direction = Vector2(unitW.y, -unitW.x);
+                    u = unitW * (combinedRadius * invHorizon - wLength);
+                } else {
+                    // Closest to one of the legs
+                    const float leg = std::sqrt(distSq - combinedRadiusSq);
+                    if (det(relativePosition, w) > 0.0f) {
+                        line.direction = Vector2(relativePosition.x * leg - relativePosition.y * combinedRadius,
+                                                 relativePosition.x * combinedRadius + relativePosition.y * leg) / distSq;
+                    } else {
+                        line.direction = Vector2(relativePosition.x * leg + relativePosition.y * combinedRadius,
+                                                 -relativePosition.x * combinedRadius + relativePosition.y * leg) / -distSq;
+                    }
+                    u = line.direction * dot(relativeVelocity, line.direction) - relativeVelocity;
+                }
+            } else {
+                // Already overlapping: get apart within this step
+                const float invStep = 1.0f / deltaTime;
+                const Vector2 w = relativeVelocity - relativePosition * invStep;
+                const float wLength = std::max(std::sqrt(absSq(w)), EPSILON);
+                const Vector2 unitW = w / wLength;
+                line.direction = Vector2(unitW.y, -unitW.x);
+                u = unitW * (combinedRadius * invStep - wLength);
+            }
+
+            line.point = agent.velocity + u * responsibility;
+            lines.push_back(line);
+            if (itemKinds[item] == ItemKind::MovingAgent) {
+                ++agent.movingNeighbors;
+            } else if (!mobile) {
+                ++hardLines;
+            }
+        }
+    }
+
+
+    std::size_t failed = linearProgram2(lines.data(), lines.size(), agent.maxSpeed, agent.preferredVelocity, false,
+                                        agent.newVelocity);
+    if (failed < lines.size()) {
+        linearProgram3(lines, hardLines, failed, agent.maxSpeed, agent.newVelocity, projected);
+    }
+}
+
+bool CrowdSteering::linearProgram1(const Line* lines, std::size_t lineNo, float maxSpeed, Vector2 optimal,
+                                   bool directionOptimal, Vector2& result) {
+    const Line& line = lines[lineNo];
+    const float dotProduct = dot(line.point, line.direction);
+    const float discriminant = dotProduct * dotProduct + maxSpeed * maxSpeed - absSq(line.point);
+    if (discriminant < 0.0f) {
+        return false;  // The speed circle misses the line entirely
+    }
+
+    const float sqrtDiscriminant = std::sqrt(discriminant);
+    float tLeft = -dotProduct - sqrtDiscriminant;
+    float tRight = -dotProduct + sqrtDiscriminant;
+    for (std::size_t i = 0; i < lineNo; ++i) {
+        const float denominator = det(line.direction, lines[i].direction);
+        const float numerator = det(lines[i].direction, line.point - lines[i].point);
+        if (std::fabs(denominator) <= EPSILON) {
+            // Parallel lines
+            if (numerator < 0.0f) {
+                return false;
+            }
+            continue;
+        }
+
+        const float t = numerator / denominator;
+        if (denominator >= 0.0f) {
+            tRight = std::min(tRight, t);
+        } else {
+            tLeft = std::max(tLeft, t);
+        }
+        if (tLeft > tRight) {
+            return false;
+        }
+    }
+
+    float t;
+    if (directionOptimal) {
+        t = dot(optimal, line.direction) > 0.0f ? tRight : tLeft;
+    } else {
+        t = std::max(tLeft, std::min(tRight, dot(line.direction, optimal - line.point)));
+    }
+    result = line.point + line.direction * t;
+    return true;
+}
+
+std::size_t CrowdSteering::linearProgram2(const Line* lines, std::size_t count, float maxSpeed, Vector2 optimal,
+                                          bool directionOptimal, Vector2& result) {
+    if (directionOptimal) {
+        result = optimal * maxSpeed;  // optimal is a unit direction here
+    } else if (absSq(optimal) > maxSpeed * maxSpeed) {
+        result = optimal.normalized() * maxSpeed;
+    } else {
+        result = optimal;
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        if (det(lines[i].direction, lines[i].point - result) > 0.0f) {
+            // Result violates this line; move it onto the line
+            const Vector2 previous = result;
+            if (!linearProgram1(lines, i, maxSpeed, optimal, directionOptimal, result)) {
+                result = previous;
+                return i;
+            }
+        }
+    }
+    return count;
+}
+
+void CrowdSteering::linearProgram3(const std::vector<Line>& lines, std::size_t hardLines, std::size_t beginLine,
+                                   float maxSpeed, Vector2& result, std::vector<Line>& projected) {
+    // Minimise the worst violation of the soft lines
+    float distance = 0.0f;
+    for (std::size_t i = beginLine; i < lines.size(); ++i) {
+        if (det(lines[i].direction, lines[i].point - result) <= distance) continue;
+
+        projected.assign(lines.begin(), lines.begin() + hardLines);
+        for (std::size_t j = hardLines; j < i; ++j) {
+            Line line;
+            const float determinant = det(lines[i].direction, lines[j].direction);
+            if (std::fabs(determinant) <= EPSILON) {
+                if (dot(lines[i].direction, lines[j].direction) > 0.0f) {
+                    continue;  // Same direction
+                }
+                line.point = (lines[i].point + lines[j].point) * 0.5f;
+            } else {
+                line.point = lines[i].point +
+                             lines[i].direction * (det(lines[j].direction, lines[i].point - lines[j].point) / determinant);
+            }
+            line.direction = (lines[j].direction - lines[i].direction).normalized();
+            projected.push_back(line);
+        }
+
+        const Vector2 previous = result;
+        if (linearProgram2(projected.data(), projected.size(), maxSpeed,
+                           Vector2(-lines[i].direction.y, lines[i].direction.x), true, result) < projected.size()) {
+            // Only numerical error gets here; keep the previous answer
+            result = previous;
+        }
+        distance = det(lines[i].direction, lines[i].point - result);
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../Math/Vector2.h"
+#include "SpatialIndex.h"
+
+// ORCA local avoidance (the RVO2 formulation). Each agent takes its nearest
+// neighbours from the spatial index, turns each into a half-plane of velocities
+// that avoid it for a short time horizon, and picks the allowed velocity closest
+// to the one it wants. Moving neighbours share the avoidance half and half;
+// idle agents make way for moving ones, which leave collision response to shove
+// them rather than wait; static blockers are hard constraints. Agents are solved
+// independently, so the work is split across threads for large groups.
+class CrowdSteering {
+public:
+    static constexpr std::size_t NO_ITEM = static_cast<std::size_t>(-1);
+
+    struct Agent {
+        std::size_t item = NO_ITEM;  // The agent's own index item, skipped in its neighbour query
+        Vector2 position;
+        Vector2 velocity;
+        Vector2 preferredVelocity;
+        float radius = 16.0f;
+        float maxSpeed = 0.0f;
+
+        // Output
+        Vector2 newVelocity;
+        int movingNeighbors = 0;  // Moving agents close enough to hold it up
+    };
+
+    static constexpr int MAX_NEIGHBORS = 10;
+
+    CrowdSteering() = default;
+    ~CrowdSteering();
+
+    CrowdSteering(const CrowdSteering&) = delete;
+    CrowdSteering& operator=(const CrowdSteering&) = delete;
+
+    void setSpatialIndex(std::shared_ptr<const SpatialIndex> index);
+    void setThreadCount(std::size_t count);
+
+    // Collision-free velocity for every agent. Agents' items must come from the
+    // index as it stands now.
+    void solve(std::vector<Agent>& agents, float deltaTime);
+
+private:
+    struct Line {
+        Vector2 point;
+        Vector2 direction;
+    };
+
+    // Per-thread working space, kept between frames
+    struct Scratch {
+        std::vector<Line> lines;
+        std::vector<Line> projected;
+    };
+
+    // What each index item is to the solve
+    enum class ItemKind : std::uint8_t { Other, IdleAgent, MovingAgent };
+
+    void solveBlocks(Scratch& own);
+    void helperLoop(std::size_t helper);
+    void solveAgent(Agent& agent, float deltaTime, std::vector<Line>& lines, std::vector<Line>& projected) const;
+
+    // Velocity within maxSpeed satisfying lines [0, count) closest to optimal;
+    // returns the first line it fails, or count
+    static std::size_t linearProgram2(const Line* lines, std::size_t count, float maxSpeed, Vector2 optimal,
+                                      bool directionOptimal, Vector2& result);
+    static bool linearProgram1(const Line* lines, std::size_t lineNo, float maxSpeed, Vector2 optimal,
+                               bool directionOptimal, Vector2& result);
+    // Least-bad velocity when the soft lines can't all hold; hard lines stay satisfied
+    static void linearProgram3(const std::vector<Line>& lines, std::size_t hardLines, std::size_t beginLine,
+                               float maxSpeed, Vector2& result, std::vector<Line>& projected);
+
+    std::shared_ptr<const SpatialIndex> spatialIndex;
+    std::size_t threadCount = 1;
+    std::vector<ItemKind> itemKinds;
+    std::vector<Scratch> scratch;
+
+    // The solve in progress; blocks of AGENT_BLOCK agents are claimed through nextBlock
+    std::vector<Agent>* jobAgents = nullptr;
+    float jobDeltaTime = 0.0f;
+    std::atomic<std::size_t> nextBlock{0};
+
+    // Helper threads, started by the first large solve and kept for later ones
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+    std::uint64_t generation = 0;    // Bumped for each solve the helpers join
+    std::size_t activeHelpers = 0;   // How many of them join the current one
+    std::size_t runningHelpers = 0;  // Those not yet out of blocks
+    bool stopping = false;
+    std::vector<std::thread> helpers;
+};
@@ -1,5 +1,22 @@
 #include "EventSystem.h"
 
+void EventSystem::dispatch() {
+    // Channels are only ever added, so the ones made by a subscriber during
+    // this loop are picked up at the end of it
+    for (std::size_t i = 0; ; ++i) {
+        EventChannelBase* current = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(channelMutex);
+            if (i >= channels.size()) break;
+            current = channels[i].get();
+        }
+        current->dispatch();
+    }
+}
+
 void EventSystem::clear() {
-    subscribers.clear();
+    std::lock_guard<std::mutex> lock(channelMutex);
+    for (auto& channel : channels) {
+        channel->clear();
+    }
 }
@@ -1,69 +1,392 @@
 #pragma once
 
-#include <memory>
-#include <string>
-#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
 #include <typeindex>
 #include <unordered_map>
+#include <vector>
+#include "../ECS/Component.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Bits describing what an event is about, set by the publisher. Subscribers
+// filter on them without touching the events themselves.
+using EventMask = std::uint32_t;
+
+namespace EventTags {
+constexpr EventMask NEUTRAL = 1u << 0;
+constexpr EventMask PLAYER = 1u << 1;
+constexpr EventMask ENEMY = 1u << 2;
+constexpr EventMask UNIT = 1u << 3;      // Workers and combat units
+constexpr EventMask BUILDING = 1u << 4;  // Bases and turrets
+
+inline EventMask ofFaction(Faction faction) {
+    switch (faction) {
+        case Faction::Player: return PLAYER;
+        case Faction::Enemy: return ENEMY;
+        default: return NEUTRAL;
+    }
+}
+
+// Tags for events about entity; an event about two entities gets both
+inline EventMask of(Entity& entity) {
+    EventMask tags = 0;
+    if (auto team = entity.getComponent<TeamComponent>()) {
+        tags |= ofFaction(team->faction);
+    }
+    if (auto role = entity.getComponent<RoleComponent>()) {
+        switch (role->role) {
+            case EntityRole::Worker:
+            case EntityRole::Soldier:
+            case EntityRole::Tank:
+            case EntityRole::Scout:
+                tags |= UNIT;
+                break;
+            case EntityRole::Base:
+            case EntityRole::Turret:
+                tags |= BUILDING;
+                break;
+            default:
+                break;
+        }
+    }
+    return tags;
+}
+}  // namespace EventTags
+
+// Which events a subscriber wants. Compiled to masks when subscribing, so the
+// tag test is an AND and a compare per event; an entity filter then also asks
+// the event whether it involves that entity.
+struct EventFilter {
+    static constexpr std::uint32_t ANY_ENTITY = 0;  // Entity ids start at 1
+
+    EventMask all = 0;   // Every one of these tags
+    EventMask any = 0;   // At least one of these, unless 0
+    EventMask none = 0;  // None of these
+    std::uint32_t entityId = ANY_ENTITY;
+
+    static EventFilter tagged(EventMask tags) {
+        EventFilter filter;
+        filter.all = tags;
+        return filter;
+    }
+
+    static EventFilter involving(std::uint32_t entityId) {
+        EventFilter filter;
+        filter.entityId = entityId;
+        return filter;
+    }
+
+    bool passesEverything() const { return all == 0 && any == 0 && none == 0 && entityId == ANY_ENTITY; }
+};
+
+// The events one subscriber asked for out of a run of the channel's ring. It
+// reads the ring in place, stepping over unwanted events by a bit per event,
+// and is only valid during the subscriber call it was passed to.
+template<typename T>
+class EventView {
+public:
+    class Iterator {
+    public:
+        Iterator(const EventView* view, std::size_t index) : view(view), index(view->next(index)) {}
+
+        const T& operator*() const { return view->data[index]; }
+        const T* operator->() const { return &view->data[index]; }
+        Iterator& operator++() {
+            index = view->next(index + 1);
+            return *this;
+        }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+
+    private:
+        const EventView* view;
+        std::size_t index;
+    };
+
+    // selected holds a bit per event, or is null when every event is wanted
+    EventView(const T* data, std::size_t count, const std::uint64_t* selected, std::size_t matched)
+        : data(data), count(count), selected(selected), matched(matched) {}
+
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, count); }
+    std::size_t size() const { return matched; }
+    bool empty() const { return matched == 0; }
+
+private:
+    const T* data;
+    std::size_t count;
+    const std::uint64_t* selected;
+    std::size_t matched;
+
+    // First wanted event at or after index, or count
+    std::size_t next(std::size_t index) const {
+        if (!selected) return std::min(index, count);
+        while (index < count) {
+            std::uint64_t word = selected[index / 64] & (~std::uint64_t(0) << (index % 64));
+            if (word) return std::min(count, index - index % 64 + lowestBit(word));
+            index = index - index % 64 + 64;
+        }
+        return count;
+    }
 
-class Event {
+    static std::size_t lowestBit(std::uint64_t word) {
+#if defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanForward64(&bit, word);
+        return bit;
+#else
+        return static_cast<std::size_t>(__builtin_ctzll(word));
+#endif
+    }
+};
+
+class EventChannelBase {
 public:
-    virtual ~Event() = default;
+    virtual ~EventChannelBase() = default;
+    virtual void dispatch() = 0;
+    virtual void clear() = 0;
 };
 
-using EventCallback = std::function<void(const std::shared_ptr<Event>&)>;
+// Ring buffer for one event type. Any number of threads may publish at once
+// without a lock: each claims slots by advancing the write cursor with a
+// compare-and-swap, copies its events in and marks the slots ready. dispatch()
+// runs on one thread at a sync point and hands each subscriber a view of the
+// ready events it asked for, one per run of the ring (two where it wraps). A
+// subscriber with nothing wanted in a run isn't called. A full ring drops what
+// doesn't fit and counts it rather than stall a worker.
+template<typename T>
+class EventChannel : public EventChannelBase {
+    static_assert(std::is_trivially_copyable<T>::value, "events are copied as raw memory");
+
+public:
+    using Subscriber = std::function<void(const EventView<T>&)>;
+
+    // Capacity is rounded up to a power of two
+    explicit EventChannel(std::size_t capacity)
+        : mask(roundUpToPowerOfTwo(capacity) - 1),
+          events(new T[mask + 1]),
+          tags(new EventMask[mask + 1]),
+          ready(new std::atomic<std::uint64_t>[mask + 1]),
+          selection((mask + 1 + 63) / 64) {
+        // Slot i holds event n once ready[i] == n + 1; nothing is ready yet
+        for (std::size_t i = 0; i <= mask; ++i) {
+            ready[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // Not thread-safe; subscribe during setup
+    void subscribe(Subscriber subscriber, const EventFilter& filter = EventFilter()) {
+        Subscription subscription;
+        subscription.subscriber = std::move(subscriber);
+        subscription.careMask = filter.all | filter.none;
+        subscription.wantMask = filter.all;
+        subscription.anyMask = filter.any;
+        subscription.entityId = filter.entityId;
+        subscription.everything = filter.passesEverything();
+        subscriptions.push_back(std::move(subscription));
+    }
+
+    // Safe from any thread. False if the ring was full and the event dropped.
+    bool publish(const T& event, EventMask eventTags = 0) { return publish(&event, 1, &eventTags) == 1; }
 
+    // Claims room for the whole run in one step; returns how many fit.
+    // eventTags is one mask per event, or null for untagged events.
+    std::size_t publish(const T* first, std::size_t count, const EventMask* eventTags = nullptr) {
+        std::uint64_t cursor = writeCursor.load(std::memory_order_relaxed);
+        std::size_t claimed = 0;
+        do {
+            std::uint64_t room = mask + 1 - (cursor - readCursor.load(std::memory_order_acquire));
+            claimed = static_cast<std::size_t>(std::min<std::uint64_t>(count, room));
+            if (claimed == 0) break;
+        } while (!writeCursor.compare_exchange_weak(cursor, cursor + claimed, std::memory_order_relaxed));
+
+        for (std::size_t i = 0; i < claimed; ++i) {
+            std::uint64_t slot = cursor + i;
+            events[slot & mask] = first[i];
+            tags[slot & mask] = eventTags ? eventTags[i] : 0;
+            ready[slot & mask].store(slot + 1, std::memory_order_release);
+        }
+        if (claimed < count) {
+            dropped.fetch_add(count - claimed, std::memory_order_relaxed);
+        }
+        return claimed;
+    }
+
+    // Hands everything published so far to the subscribers that want it and
+    // frees the slots. Stops short of a slot a publisher is still filling, which is then
+    // delivered next time.
+    void dispatch() override {
+        const std::uint64_t begin = readCursor.load(std::memory_order_relaxed);
+        const std::uint64_t limit = writeCursor.load(std::memory_order_acquire);
+        std::uint64_t end = begin;
+        while (end < limit && ready[end & mask].load(std::memory_order_acquire) == end + 1) {
+            ++end;
+        }
+
+        for (std::uint64_t cursor = begin; cursor < end; ) {
+            std::size_t first = static_cast<std::size_t>(cursor & mask);
+            std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(end - cursor, mask + 1 - first));
+            for (const Subscription& subscription : subscriptions) {
+                deliver(subscription, first, count);
+            }
+            cursor += count;
+        }
+        readCursor.store(end, std::memory_order_release);
+    }
+
+    // Drops subscribers and anything not yet dispatched; only while no one publishes
+    void clear() override {
+        subscriptions.clear();
+        readCursor.store(writeCursor.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    std::size_t capacity() const { return mask + 1; }
+    std::size_t pending() const {
+        return static_cast<std::size_t>(writeCursor.load(std::memory_order_acquire) - readCursor.load(std::memory_order_acquire));
+    }
+    // Events lost to a full ring since the channel was made
+    std::uint64_t getDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Subscription {
+        Subscriber subscriber;
+        EventMask careMask;  // Tags the filter looks at
+        EventMask wantMask;  // What they must be
+        EventMask anyMask;   // At least one of these, unless 0
+        std::uint32_t entityId;
+        bool everything;
+    };
+
+    // Marks the wanted events in slots [first, first + count) and calls the
+    // subscriber if there are any
+    void deliver(const Subscription& subscription, std::size_t first, std::size_t count) {
+        if (subscription.everything) {
+            subscription.subscriber(EventView<T>(&events[first], count, nullptr, count));
+            return;
+        }
+
+        std::size_t matched = 0;
+        for (std::size_t word = 0; word * 64 < count; ++word) {
+            std::uint64_t bits = 0;
+            const std::size_t end = std::min(count, word * 64 + 64);
+            for (std::size_t i = word * 64; i < end; ++i) {
+                const EventMask eventTags = tags[first + i];
+                bool wanted = (eventTags & subscription.careMask) == subscription.wantMask &&
+                              (subscription.anyMask == 0 || (eventTags & subscription.anyMask) != 0);
+                if (wanted && subscription.entityId != EventFilter::ANY_ENTITY) {
+                    wanted = events[first + i].involves(subscription.entityId);
+                }
+                bits |= std::uint64_t(wanted) << (i % 64);
+                matched += wanted;
+            }
+            selection[word] = bits;
+        }
+        if (matched > 0) {
+            subscription.subscriber(EventView<T>(&events[first], count, selection.data(), matched));
+        }
+    }
+
+    static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+        std::size_t power = 1;
+        while (power < value) power <<= 1;
+        return power;
+    }
+
+    const std::size_t mask;
+    std::unique_ptr<T[]> events;
+    std::unique_ptr<EventMask[]> tags;  // Parallel to events
+    std::unique_ptr<std::atomic<std::uint64_t>[]> ready;
+    std::vector<Subscription> subscriptions;
+    std::vector<std::uint64_t> selection;  // A bit per slot, reused by every delivery
+
+    // Kept on separate cache lines so publishers and the dispatcher don't
+    // contend over one
+    alignas(64) std::atomic<std::uint64_t> writeCursor{0};
+    alignas(64) std::atomic<std::uint64_t> readCursor{0};
+    alignas(64) std::atomic<std::uint64_t> dropped{0};
+};
+
+// Typed event bus: one channel per event type, each a lock-free ring of plain
+// data. Systems publish during the frame, from worker threads if they like,
+// and subscribers see the events in batches when the engine calls dispatch().
 class EventSystem {
 public:
-    // Subscribe to an event type
+    static constexpr std::size_t DEFAULT_CAPACITY = 1 << 16;
+
+    // The channel for T, made on first use with the given capacity. The lookup
+    // takes a lock, so hot publishers should keep the reference.
     template<typename T>
-    void subscribe(EventCallback callback) {
+    EventChannel<T>& channel(std::size_t capacity = DEFAULT_CAPACITY) {
+        std::lock_guard<std::mutex> lock(channelMutex);
         auto typeIndex = std::type_index(typeid(T));
-        subscribers[typeIndex].push_back(callback);
+        auto it = channelSlots.find(typeIndex);
+        if (it == channelSlots.end()) {
+            it = channelSlots.emplace(typeIndex, channels.size()).first;
+            channels.push_back(std::make_unique<EventChannel<T>>(capacity));
+        }
+        return static_cast<EventChannel<T>&>(*channels[it->second]);
     }
-    
-    // Publish an event
+
     template<typename T>
-    void publish(const std::shared_ptr<T>& event) {
-        auto typeIndex = std::type_index(typeid(T));
-        auto it = subscribers.find(typeIndex);
-        if (it != subscribers.end()) {
-            for (auto& callback : it->second) {
-                callback(event);
-            }
-        }
+    void subscribe(typename EventChannel<T>::Subscriber subscriber, const EventFilter& filter = EventFilter()) {
+        channel<T>().subscribe(std::move(subscriber), filter);
+    }
+
+    template<typename T>
+    bool publish(const T& event, EventMask tags = 0) {
+        return channel<T>().publish(event, tags);
     }
-    
+
+    // Sync point: every channel, in the order they were made, hands what was
+    // published to its subscribers. Events published by a subscriber arrive
+    // in this dispatch if their channel comes later, otherwise in the next.
+    void dispatch();
+
     void clear();
 
 private:
-    std::unordered_map<std::type_index, std::vector<EventCallback>> subscribers;
+    std::mutex channelMutex;
+    std::unordered_map<std::type_index, std::size_t> channelSlots;
+    std::vector<std::unique_ptr<EventChannelBase>> channels;
 };
 
 // ===== EVENT TYPES =====
+// Plain data, so they can be copied into a ring as they are. involves() is
+// what EventFilter::involving tests.
 
-struct EntityDestroyedEvent : public Event {
+struct EntityDestroyedEvent {
     uint32_t entityId;
-    EntityDestroyedEvent(uint32_t id) : entityId(id) {}
+
+    bool involves(uint32_t id) const { return entityId == id; }
 };
 
-struct CollisionEvent : public Event {
+struct CollisionEvent {
     uint32_t entity1Id;
     uint32_t entity2Id;
-    CollisionEvent(uint32_t id1, uint32_t id2) : entity1Id(id1), entity2Id(id2) {}
+
+    bool involves(uint32_t id) const { return entity1Id == id || entity2Id == id; }
 };
 
-struct DamageEvent : public Event {
+struct DamageEvent {
     uint32_t targetEntityId;
     float damage;
-    DamageEvent(uint32_t target, float dmg) : targetEntityId(target), damage(dmg) {}
+
+    bool involves(uint32_t id) const { return targetEntityId == id; }
 };
 
-struct ResourceCollectedEvent : public Event {
+struct ResourceCollectedEvent {
     uint32_t collecterId;
-    std::string resourceType;
+    uint32_t resourceNodeId;
     float amount;
-    ResourceCollectedEvent(uint32_t id, const std::string& type, float amt) 
-        : collecterId(id), resourceType(type), amount(amt) {}
+
+    bool involves(uint32_t id) const { return collecterId == id || resourceNodeId == id; }
 };
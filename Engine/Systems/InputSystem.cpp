@@ -1,7 +1,7 @@
 #include "InputSystem.h"
 
 void InputSystem::update(float deltaTime) {
-    // Click events are one-frame pulses.
+    // Click events are one-step pulses.
     mouseClicked[0] = false;
     mouseClicked[1] = false;
     mouseClicked[2] = false;
@@ -1,8 +1,38 @@
 #include "MovementSystem.h"
+#include <algorithm>
 #include <cmath>
+#include "../Pathfinding/Pathfinder.h"
+
+namespace {
+// Seconds without progress before a unit drops its path; longer while moving
+// units around it may be what holds it up, but not for ever
+const float STUCK_TIME = 0.8f;
+const float CROWDED_STUCK_TIME = 3.0f;
+// Waypoints short of the last only need passing near, so a crowd doesn't queue
+// to touch each corner exactly
+const float CORNER_RADIUS = 48.0f;
+// An idle unit slower than this for SLEEP_DELAY seconds goes to sleep
+const float SLEEP_SPEED = 2.0f;
+const float SLEEP_DELAY = 0.5f;
+
+float distanceToSegment(Vector2 point, Vector2 a, Vector2 b) {
+    Vector2 ab = b - a;
+    float lengthSq = ab.magnitudeSquared();
+    float t = lengthSq > 0.0f ? std::max(0.0f, std::min(1.0f, (point - a).dot(ab) / lengthSq)) : 0.0f;
+    return point.distance(a + ab * t);
+}
+}  // namespace
 
 void MovementSystem::update(float deltaTime) {
-    for (auto& entity : entities) {
+    agents.clear();
+    movers.clear();
+    seek.resize(awakeEntities.size());
+    seekAgents.clear();
+    seekMovers.clear();
+    mapIndexItems();
+
+    // Sleeping units are still in the spatial index, so awake ones steer round them
+    for (auto& entity : awakeEntities) {
         auto transform = entity->getComponent<TransformComponent>();
         auto movement = entity->getComponent<MovementComponent>();
         auto physics = entity->getComponent<PhysicsComponent>();
@@ -13,24 +43,53 @@ void MovementSystem::update(float deltaTime) {
             continue;
         }
 
+        Mover mover{transform.get(), movement.get(), physics.get(), path.get(), command.get(), entity.get()};
+        CrowdSteering::Agent agent;
+        agent.item = findIndexItem(*entity);
+        agent.position = transform->position;
+        agent.velocity = physics ? physics->velocity : Vector2::zero();
+        agent.maxSpeed = movement->moveSpeed;
+        if (auto collider = entity->getComponent<ColliderComponent>()) {
+            agent.radius = collider->radius;
+        }
+
         if (path && path->hasPath()) {
             movement->setTarget(path->waypoints[path->currentIndex]);
         }
         
         if (!movement->hasTarget) {
-            // No target, stop moving
+            // No target: stand still, but still step aside for passing units
             if (physics) {
-                physics->velocity = Vector2(0, 0);
+                agents.push_back(agent);
+                movers.push_back(mover);
+            } else {
+                entity->sleep();
             }
             continue;
         }
         
-        // Calculate direction to target
-        Vector2 direction = movement->targetPosition - transform->position;
-        float distance = std::sqrt(direction.x * direction.x + direction.y * direction.y);
-        
-        // Check if arrived
-        if (distance <= movement->arrivalRadius) {
+        // Direction, speed and arrival for every unit with a target at once
+        seek.set(seekMovers.size(), transform->position, movement->targetPosition, movement->moveSpeed,
+                 movement->arrivalRadius);
+        seekAgents.push_back(agent);
+        seekMovers.push_back(mover);
+    }
+
+    seek.resize(seekMovers.size());
+    seek.solve();
+
+    for (std::size_t i = 0; i < seekMovers.size(); ++i) {
+        const Mover& mover = seekMovers[i];
+        TransformComponent* transform = mover.transform;
+        MovementComponent* movement = mover.movement;
+        PhysicsComponent* physics = mover.physics;
+        PathComponent* path = mover.path;
+        CommandComponent* command = mover.command;
+
+        // A corner also counts once the unit is near the leg after it, as when
+        // the crowd has pushed it round the corner already
+        bool arrived = seek.arrived[i] != 0 || canCutCorner(mover);
+        if (arrived) {
             if (path && path->hasPath()) {
                 ++path->currentIndex;
                 if (path->hasPath()) {
@@ -52,47 +111,130 @@ void MovementSystem::update(float deltaTime) {
             continue;
         }
         
-        // Normalize direction and apply speed
-        direction.x /= distance;
-        direction.y /= distance;
-        
-        Vector2 targetVelocity(
-            direction.x * movement->moveSpeed,
-            direction.y * movement->moveSpeed
-        );
+        Vector2 targetVelocity(seek.velocityX[i], seek.velocityY[i]);
         
-        // Apply velocity to physics component if available
         if (physics) {
-            physics->velocity = targetVelocity;
+            // Velocity is set once avoidance has seen every unit
+            CrowdSteering::Agent& agent = seekAgents[i];
+            agent.preferredVelocity = targetVelocity;
+            agents.push_back(agent);
+            movers.push_back(mover);
         } else {
             // Directly update position if no physics
             transform->position.x += targetVelocity.x * deltaTime;
             transform->position.y += targetVelocity.y * deltaTime;
+            updateStuck(mover, deltaTime, false);
         }
+    }
+
+    crowdSteering.solve(agents, deltaTime);
 
-        // Basic anti-stuck handling for dynamic maps/crowding.
-        if (!movement->hasLastPosition) {
-            movement->lastPosition = transform->position;
-            movement->hasLastPosition = true;
+    for (std::size_t i = 0; i < agents.size(); ++i) {
+        const Mover& mover = movers[i];
+        mover.physics->velocity = agents[i].newVelocity;
+        if (mover.movement->hasTarget) {
+            updateStuck(mover, deltaTime, agents[i].movingNeighbors > 0);
         } else {
-            float movedDistance = transform->position.distance(movement->lastPosition);
-            if (movedDistance < 1.0f) {
-                movement->stuckTimer += deltaTime;
-            } else {
-                movement->stuckTimer = 0.0f;
-                movement->lastPosition = transform->position;
-            }
+            updateRest(mover, deltaTime);
+        }
+    }
+}
 
-            if (movement->stuckTimer > 0.8f) {
-                movement->stuckTimer = 0.0f;
-                if (path) {
-                    path->clear();
-                }
-                movement->clearTarget();
-                if (physics) {
-                    physics->velocity = Vector2::zero();
-                }
-            }
+bool MovementSystem::canCutCorner(const Mover& mover) const {
+    const PathComponent* path = mover.path;
+    if (!pathfinder || !path || path->currentIndex + 1 >= path->waypoints.size()) {
+        return false;
+    }
+
+    const Vector2 position = mover.transform->position;
+    const Vector2 corner = mover.movement->targetPosition;
+    const Vector2 next = path->waypoints[path->currentIndex + 1];
+    if (distanceToSegment(position, corner, next) > CORNER_RADIUS) {
+        return false;
+    }
+
+    // Corners sit right beside what the path bends round, so near the leg is
+    // not enough: the unit must be able to walk straight to the next waypoint
+    // without crossing anything, or dearer ground, the corner avoided
+    const NavGrid& grid = pathfinder->getGrid();
+    const MovementClass movementClass = mover.movement->movementClass;
+    float maxStepCost = std::max({PathSmoother::getStepCostAt(grid, position, movementClass),
+                                  PathSmoother::getStepCostAt(grid, corner, movementClass),
+                                  PathSmoother::getStepCostAt(grid, next, movementClass)});
+    return PathSmoother::hasLineOfSight(grid, position, next, movementClass, maxStepCost);
+}
+
+void MovementSystem::mapIndexItems() {
+    // PhysicsSystem rebuilt the index's moving layer earlier this step, and
+    // every agent with a body is awake, so one pass over that layer finds them
+    if (!spatialIndex) {
+        return;
+    }
+    for (std::size_t item = spatialIndex->staticSize(); item < spatialIndex->size(); ++item) {
+        EntityID id = spatialIndex->getEntity(item)->getId();
+        if (id >= indexItems.size()) {
+            indexItems.resize(static_cast<std::size_t>(id) + 1, 0);
+        }
+        indexItems[id] = static_cast<std::uint32_t>(item);
+    }
+}
+
+std::size_t MovementSystem::findIndexItem(const Entity& entity) const {
+    // Entries for units that have since left the index point at someone else
+    EntityID id = entity.getId();
+    if (!spatialIndex || id >= indexItems.size()) {
+        return CrowdSteering::NO_ITEM;
+    }
+    std::size_t item = indexItems[id];
+    if (item >= spatialIndex->size() || spatialIndex->getEntity(item).get() != &entity) {
+        return CrowdSteering::NO_ITEM;
+    }
+    return item;
+}
+
+void MovementSystem::updateRest(const Mover& mover, float deltaTime) {
+    // Once the crowd has stopped nudging it, an idle unit sleeps until given work
+    if (mover.physics->velocity.magnitudeSquared() >= SLEEP_SPEED * SLEEP_SPEED) {
+        mover.movement->restTimer = 0.0f;
+        return;
+    }
+
+    mover.movement->restTimer += deltaTime;
+    if (mover.movement->restTimer >= SLEEP_DELAY) {
+        mover.movement->restTimer = 0.0f;
+        mover.physics->velocity = Vector2::zero();
+        mover.entity->sleep();
+    }
+}
+
+void MovementSystem::updateStuck(const Mover& mover, float deltaTime, bool crowded) {
+    // Basic anti-stuck handling for dynamic maps/crowding.
+    MovementComponent* movement = mover.movement;
+    const Vector2& position = mover.transform->position;
+    if (!movement->hasLastPosition) {
+        movement->lastPosition = position;
+        movement->hasLastPosition = true;
+        return;
+    }
+
+    float movedDistance = position.distance(movement->lastPosition);
+    if (movedDistance < 1.0f) {
+        movement->stuckTimer += deltaTime;
+    } else {
+        movement->stuckTimer = 0.0f;
+        movement->lastPosition = position;
+    }
+
+    // Waiting behind moving units isn't being stuck yet; avoidance keeps a
+    // crowd flowing. Idle and sleeping ones make way, so they grant no grace.
+    if (movement->stuckTimer > (crowded ? CROWDED_STUCK_TIME : STUCK_TIME)) {
+        movement->stuckTimer = 0.0f;
+        if (mover.path) {
+            mover.path->clear();
+        }
+        movement->clearTarget();
+        if (mover.physics) {
+            mover.physics->velocity = Vector2::zero();
         }
     }
 }
@@ -100,4 +242,18 @@ void MovementSystem::update(float deltaTime) {
 void MovementSystem::setRequiredComponents() {
     require<TransformComponent>();
     require<MovementComponent>();
+    trackActivity();
+}
+
+void MovementSystem::setSpatialIndex(std::shared_ptr<const SpatialIndex> index) {
+    spatialIndex = index;
+    crowdSteering.setSpatialIndex(std::move(index));
+}
+
+void MovementSystem::setPathfinder(std::shared_ptr<const Pathfinder> finder) {
+    pathfinder = std::move(finder);
+}
+
+void MovementSystem::setWorkerThreads(std::size_t count) {
+    crowdSteering.setThreadCount(count);
 }
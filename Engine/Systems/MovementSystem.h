@@ -2,9 +2,50 @@
 
 #include "../ECS/System.h"
 #include "../ECS/Component.h"
+#include "BodyKernels.h"
+#include "CrowdSteering.h"
+
+class Pathfinder;
 
 class MovementSystem : public System {
 public:
     void update(float deltaTime) override;
     void setRequiredComponents() override;
+
+    // Units with physics steer around each other using neighbours from the index;
+    // without one they head straight for their waypoints
+    void setSpatialIndex(std::shared_ptr<const SpatialIndex> index);
+    // Corners are cut only where the nav grid shows a clear line past them
+    void setPathfinder(std::shared_ptr<const Pathfinder> finder);
+    void setWorkerThreads(std::size_t count);
+
+private:
+    // Per-unit state carried from steering to the avoidance results
+    struct Mover {
+        TransformComponent* transform;
+        MovementComponent* movement;
+        PhysicsComponent* physics;
+        PathComponent* path;
+        CommandComponent* command;
+        Entity* entity;
+    };
+
+    bool canCutCorner(const Mover& mover) const;
+    void mapIndexItems();
+    std::size_t findIndexItem(const Entity& entity) const;
+    void updateStuck(const Mover& mover, float deltaTime, bool crowded);
+    void updateRest(const Mover& mover, float deltaTime);
+
+    std::shared_ptr<const SpatialIndex> spatialIndex;
+    std::shared_ptr<const Pathfinder> pathfinder;
+    std::vector<std::uint32_t> indexItems;  // Each unit's index item by id; stale for ids not in the index
+
+    CrowdSteering crowdSteering;
+    std::vector<CrowdSteering::Agent> agents;
+    std::vector<Mover> movers;  // Parallel to agents
+
+    // Units with a target, before arrival is settled
+    SeekBatch seek;
+    std::vector<CrowdSteering::Agent> seekAgents;
+    std::vector<Mover> seekMovers;  // Parallel to seek lanes
 };
@@ -1,45 +1,122 @@
 #include "PhysicsSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PHYSICS_SSE2 1
+#endif
+
+namespace {
+// Overlap left alone so resting contacts don't jitter
+const float PENETRATION_SLOP = 0.5f;
+// Share of a unit-unit overlap removed per step; crowds settle over a few frames
+const float SEPARATION_RELAXATION = 0.5f;
+// Centres closer than this (squared) are treated as coincident
+const float MIN_CONTACT_DISTANCE_SQ = 1e-6f;
+// A sleeping body is woken by a contact closing faster than this or overlapping
+// deeper than WAKE_OVERLAP; lighter touches are left alone so a resting crowd
+// can stay asleep
+const float WAKE_SPEED = 10.0f;
+const float WAKE_OVERLAP = 2.0f;
+
+// Roles that hold their ground and push units out, matching the nav grid blockers
+bool isStaticBlocker(const std::shared_ptr<RoleComponent>& role) {
+    return role && (role->role == EntityRole::Obstacle || role->role == EntityRole::Base ||
+                    role->role == EntityRole::Turret);
+}
+}  // namespace
 
 void PhysicsSystem::update(float deltaTime) {
-    for (auto& entity : entities) {
-        if (!entity->isActive()) continue;
-        
-        auto physics = entity->getComponent<PhysicsComponent>();
-        if (!physics) continue;
-        
-        integrateVelocity(entity, deltaTime);
+    if (bodiesVersion != membershipVersion) {
+        cacheBodies();
+    }
+    if (layersMembership != membershipVersion || layersActivity != activityVersion) {
+        sortLayers();
+    }
+
+    integrateBodies(deltaTime);
+
+    // Write the moving bodies back and feed the index's moving layer in one
+    // pass; lane i is the body of the index's i-th add()
+    spatialIndex->clear();
+    for (std::size_t lane = 0; lane < indexedBodies.size(); ++lane) {
+        const std::uint32_t i = indexedBodies[lane];
+        const Body& body = bodies[i];
+        Vector2 velocity(integration.velocityX[lane], integration.velocityY[lane]);
+        body.transform->position = Vector2(integration.x[lane], integration.y[lane]);
+        body.physics->velocity = velocity;
+        body.physics->acceleration = Vector2::zero();
+
+        std::uint32_t flags = (body.solid ? SpatialIndex::SOLID : 0) | SpatialIndex::MOBILE;
+        spatialIndex->add(entities[i], body.transform->position, body.collider->radius, flags, velocity);
     }
+    spatialIndex->build();
     
     checkEntityCollisions();
+    resolveCollisions();
 }
 
 void PhysicsSystem::setRequiredComponents() {
+    // Static colliders (buildings, obstacles) are indexed too; only entities
+    // with a PhysicsComponent move
     require<TransformComponent>();
-    require<PhysicsComponent>();
+    require<ColliderComponent>();
+    trackActivity();
 }
 
-void PhysicsSystem::integrateVelocity(std::shared_ptr<Entity> entity, float deltaTime) {
-    auto transform = entity->getComponent<TransformComponent>();
-    auto physics = entity->getComponent<PhysicsComponent>();
-    
-    if (!transform || !physics) return;
-    
-    // Apply friction
-    physics->velocity *= (1.0f - physics->friction);
-    
-    // Apply gravity
-    if (gravity != 0.0f) {
-        physics->acceleration.y += gravity;
+void PhysicsSystem::sortLayers() {
+    // Static colliders and sleeping bodies hold still, so they sit in the
+    // index's static layer. That and the moving list are only redone when a
+    // body joins, leaves, wakes or falls asleep; each step then only touches
+    // the awake bodies, in body order rather than the order they woke in.
+    movingBodies.clear();
+    spatialIndex->clearStatic();
+    staticBodies.clear();
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+        const auto& entity = entities[i];
+        const Body& body = bodies[i];
+        if (body.physics && entity->isAwake()) {
+            movingBodies.push_back(static_cast<std::uint32_t>(i));
+            continue;
+        }
+        if (!entity->isActive() || entity->isDestroyed()) continue;
+
+        std::uint32_t flags = (body.solid ? SpatialIndex::SOLID : 0) |
+                              (body.physics ? SpatialIndex::MOBILE | SpatialIndex::SLEEPING : 0);
+        spatialIndex->addStatic(entity, body.transform->position, body.collider->radius, flags);
+        staticBodies.push_back(static_cast<std::uint32_t>(i));
     }
-    
-    // Update velocity from acceleration
-    physics->velocity += physics->acceleration * deltaTime;
-    
-    // Update position from velocity
-    transform->position += physics->velocity * deltaTime;
-    
-    // Reset acceleration
-    physics->acceleration = Vector2::zero();
+    layersMembership = membershipVersion;
+    layersActivity = activityVersion;
+}
+
+void PhysicsSystem::integrateBodies(float deltaTime) {
+    // Gather the moving bodies into arrays and step them as one batch
+    integration.resize(movingBodies.size());
+    indexedBodies.clear();
+    for (std::uint32_t i : movingBodies) {
+        const auto& entity = entities[i];
+        Body& body = bodies[i];
+        if (!entity->isActive() || entity->isDestroyed()) continue;
+
+        // Friction is applied after the move, so a velocity steering just set is
+        // covered in full; exponential decay makes it the same per second at any
+        // step length
+        PhysicsComponent& physics = *body.physics;
+        if (physics.friction != body.decayFriction || deltaTime != body.decayStep) {
+            body.decay = std::exp(-physics.friction * deltaTime);
+            body.decayFriction = physics.friction;
+            body.decayStep = deltaTime;
+        }
+        integration.set(indexedBodies.size(), body.transform->position, physics.velocity,
+                        Vector2(physics.acceleration.x, physics.acceleration.y + gravity), body.decay);
+        indexedBodies.push_back(i);
+    }
+    integration.resize(indexedBodies.size());
+
+    integration.integrate(deltaTime);
 }
 
 bool PhysicsSystem::checkCollision(const std::shared_ptr<Entity>& entity1, 
@@ -51,24 +128,253 @@ bool PhysicsSystem::checkCollision(const std::shared_ptr<Entity>& entity1,
     
     if (!t1 || !c1 || !t2 || !c2) return false;
     
-    float distance = t1->position.distance(t2->position);
     float minDist = c1->radius + c2->radius;
     
-    return distance < minDist;
+    return t1->position.distanceSquared(t2->position) < minDist * minDist;
+}
+
+void PhysicsSystem::cacheBodies() {
+    bodies.clear();
+    for (const auto& entity : entities) {
+        auto physics = entity->getComponent<PhysicsComponent>();
+        auto collider = entity->getComponent<ColliderComponent>();
+
+        Body body;
+        body.transform = entity->getComponent<TransformComponent>().get();
+        body.collider = collider.get();
+        body.physics = physics.get();
+        body.inverseMass = physics ? 1.0f / std::max(physics->mass, 0.001f) : 0.0f;
+        body.solid = !collider->isTrigger &&
+                     (physics || isStaticBlocker(entity->getComponent<RoleComponent>()));
+        body.eventTags = EventTags::of(*entity);
+        body.decay = 1.0f;
+        body.decayFriction = std::numeric_limits<float>::quiet_NaN();  // Worked out on first step
+        body.decayStep = 0.0f;
+        bodies.push_back(body);
+    }
+    bodiesVersion = membershipVersion;
 }
 
 void PhysicsSystem::checkEntityCollisions() {
-    // Simple O(n²) collision detection
-    for (size_t i = 0; i < entities.size(); ++i) {
-        for (size_t j = i + 1; j < entities.size(); ++j) {
-            if (checkCollision(entities[i], entities[j])) {
-                // Trigger collision event
-                // This will be connected to EventSystem
-            }
+    // Broadphase pairs from the grid instead of testing every pair
+    contacts.clear();
+    spatialIndex->forEachOverlappingPair([this](std::size_t a, std::size_t b) {
+        contacts.emplace_back(a, b);
+    });
+}
+
+void PhysicsSystem::resolveCollisions() {
+    // Units push each other apart first, all contacts at once
+    batch.clear();
+    blockerContacts.clear();
+    for (const auto& [itemA, itemB] : contacts) {
+        std::uint32_t a = bodyOfItem(itemA);
+        std::uint32_t b = bodyOfItem(itemB);
+        const Body& bodyA = bodies[a];
+        const Body& bodyB = bodies[b];
+        if (!bodyA.solid || !bodyB.solid) continue;
+        if (!settleSleeper(a, itemA, b, itemB)) continue;
+
+        // Two immovable bodies just overlap, with nothing to resolve or report
+        if (bodyA.inverseMass > 0.0f && bodyB.inverseMass > 0.0f) {
+            addContact(a, b, spatialIndex->getPosition(itemA), spatialIndex->getPosition(itemB));
+        } else if (bodyA.inverseMass > 0.0f || bodyB.inverseMass > 0.0f) {
+            blockerContacts.emplace_back(a, b);
+        } else {
+            continue;
+        }
+        if (collisionChannel) {
+            collisionChannel->publish({entities[a]->getId(), entities[b]->getId()}, bodyA.eventTags | bodyB.eventTags);
         }
     }
+    applyContacts(SEPARATION_RELAXATION);
+
+    // Then blockers push units fully out from where the crowd left them
+    batch.clear();
+    for (const auto& [a, b] : blockerContacts) {
+        addContact(a, b, bodies[a].transform->position, bodies[b].transform->position);
+    }
+    applyContacts(1.0f);
+}
+
+std::uint32_t PhysicsSystem::bodyOfItem(std::size_t item) const {
+    std::size_t source = spatialIndex->getSourceIndex(item);
+    return spatialIndex->isStatic(item) ? staticBodies[source] : indexedBodies[source];
+}
+
+bool PhysicsSystem::settleSleeper(std::uint32_t a, std::size_t itemA, std::uint32_t b, std::size_t itemB) {
+    const bool asleepA = (spatialIndex->getFlags(itemA) & SpatialIndex::SLEEPING) != 0;
+    const bool asleepB = (spatialIndex->getFlags(itemB) & SpatialIndex::SLEEPING) != 0;
+    if (!asleepA && !asleepB) {
+        return true;
+    }
+
+    // Nothing moves in a contact between sleepers and blockers
+    const bool movingA = bodies[a].inverseMass > 0.0f && !asleepA;
+    const bool movingB = bodies[b].inverseMass > 0.0f && !asleepB;
+    if (!movingA && !movingB) {
+        return false;
+    }
+
+    // Sleeper velocities are zero, so the mover's speed is the closing speed
+    const std::size_t moving = movingA ? itemA : itemB;
+    const float reach = spatialIndex->getRadius(itemA) + spatialIndex->getRadius(itemB) - WAKE_OVERLAP;
+    const bool deep = reach > 0.0f && spatialIndex->getPosition(itemA).isWithin(spatialIndex->getPosition(itemB), reach);
+    if (!deep && spatialIndex->getVelocity(moving).magnitudeSquared() < WAKE_SPEED * WAKE_SPEED) {
+        return false;
+    }
+    entities[movingA ? b : a]->wake();
+    return true;
+}
+
+void PhysicsSystem::addContact(std::uint32_t a, std::uint32_t b, Vector2 positionA, Vector2 positionB) {
+    const Body& bodyA = bodies[a];
+    const Body& bodyB = bodies[b];
+    Vector2 velocityA = bodyA.physics ? bodyA.physics->velocity : Vector2::zero();
+    Vector2 velocityB = bodyB.physics ? bodyB.physics->velocity : Vector2::zero();
+    batch.bodyA.push_back(a);
+    batch.bodyB.push_back(b);
+    batch.ax.push_back(positionA.x);
+    batch.ay.push_back(positionA.y);
+    batch.bx.push_back(positionB.x);
+    batch.by.push_back(positionB.y);
+    batch.velocityAX.push_back(velocityA.x);
+    batch.velocityAY.push_back(velocityA.y);
+    batch.velocityBX.push_back(velocityB.x);
+    batch.velocityBY.push_back(velocityB.y);
+    batch.radiusSum.push_back(bodyA.collider->radius + bodyB.collider->radius);
+    batch.effectiveMass.push_back(1.0f / (bodyA.inverseMass + bodyB.inverseMass));
+}
+
+void PhysicsSystem::applyContacts(float relaxation) {
+    if (batch.size() == 0) {
+        return;
+    }
+
+    batch.solve();
+
+    // Accumulate every contact's push before applying any, so the result
+    // doesn't depend on contact order. The sums are left at zero after each
+    // pass, so only new bodies need clearing.
+    correctionX.resize(bodies.size(), 0.0f);
+    correctionY.resize(bodies.size(), 0.0f);
+    velocityChangeX.resize(bodies.size(), 0.0f);
+    velocityChangeY.resize(bodies.size(), 0.0f);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const std::uint32_t a = batch.bodyA[i];
+        const std::uint32_t b = batch.bodyB[i];
+        const float inverseMassA = bodies[a].inverseMass;
+        const float inverseMassB = bodies[b].inverseMass;
+
+        float push = batch.penetration[i] * batch.effectiveMass[i] * relaxation;
+        correctionX[a] -= batch.normalX[i] * push * inverseMassA;
+        correctionY[a] -= batch.normalY[i] * push * inverseMassA;
+        correctionX[b] += batch.normalX[i] * push * inverseMassB;
+        correctionY[b] += batch.normalY[i] * push * inverseMassB;
+
+        velocityChangeX[a] -= batch.normalX[i] * batch.impulse[i] * inverseMassA;
+        velocityChangeY[a] -= batch.normalY[i] * batch.impulse[i] * inverseMassA;
+        velocityChangeX[b] += batch.normalX[i] * batch.impulse[i] * inverseMassB;
+        velocityChangeY[b] += batch.normalY[i] * batch.impulse[i] * inverseMassB;
+    }
+
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        for (std::uint32_t body : {batch.bodyA[i], batch.bodyB[i]}) {
+            if (bodies[body].inverseMass == 0.0f) continue;
+
+            // Zeroed once applied, so bodies in several contacts move once
+            bodies[body].transform->position.x += correctionX[body];
+            bodies[body].transform->position.y += correctionY[body];
+            bodies[body].physics->velocity.x += velocityChangeX[body];
+            bodies[body].physics->velocity.y += velocityChangeY[body];
+            correctionX[body] = correctionY[body] = 0.0f;
+            velocityChangeX[body] = velocityChangeY[body] = 0.0f;
+        }
+    }
+}
+
+void PhysicsSystem::ContactBatch::clear() {
+    bodyA.clear();
+    bodyB.clear();
+    ax.clear();
+    ay.clear();
+    bx.clear();
+    by.clear();
+    velocityAX.clear();
+    velocityAY.clear();
+    velocityBX.clear();
+    velocityBY.clear();
+    radiusSum.clear();
+    effectiveMass.clear();
+}
+
+void PhysicsSystem::ContactBatch::solve() {
+    // Contact normal (A to B), penetration past the slop, and the impulse that
+    // stops the pair closing (fully inelastic); four contacts per step with SSE2.
+    // The lanes do the scalar loop's operations in its order, with max operands
+    // arranged to pick as std::max does, so both give the same bits.
+    const std::size_t count = size();
+    normalX.resize(count);
+    normalY.resize(count);
+    penetration.resize(count);
+    impulse.resize(count);
+
+    std::size_t i = 0;
+#ifdef PHYSICS_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);  // Normal of coincident centres
+    const __m128 slop = _mm_set1_ps(PENETRATION_SLOP);
+    const __m128 minDistanceSq = _mm_set1_ps(MIN_CONTACT_DISTANCE_SQ);
+    for (; i + 4 <= count; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(&bx[i]), _mm_loadu_ps(&ax[i]));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(&by[i]), _mm_loadu_ps(&ay[i]));
+        __m128 distanceSq = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 separated = _mm_cmpgt_ps(distanceSq, minDistanceSq);
+        __m128 distance = _mm_sqrt_ps(_mm_max_ps(minDistanceSq, distanceSq));
+
+        // Coincident centres separate along +x
+        __m128 nx = _mm_or_ps(_mm_and_ps(separated, _mm_div_ps(dx, distance)), _mm_andnot_ps(separated, one));
+        __m128 ny = _mm_and_ps(separated, _mm_div_ps(dy, distance));
+        __m128 depth = _mm_max_ps(_mm_sub_ps(_mm_sub_ps(_mm_loadu_ps(&radiusSum[i]), distance), slop), zero);
+
+        __m128 relativeX = _mm_sub_ps(_mm_loadu_ps(&velocityBX[i]), _mm_loadu_ps(&velocityAX[i]));
+        __m128 relativeY = _mm_sub_ps(_mm_loadu_ps(&velocityBY[i]), _mm_loadu_ps(&velocityAY[i]));
+        __m128 closing = _mm_sub_ps(zero, _mm_add_ps(_mm_mul_ps(relativeX, nx), _mm_mul_ps(relativeY, ny)));
+        __m128 stop = _mm_mul_ps(_mm_max_ps(closing, zero), _mm_loadu_ps(&effectiveMass[i]));
+
+        _mm_storeu_ps(&normalX[i], nx);
+        _mm_storeu_ps(&normalY[i], ny);
+        _mm_storeu_ps(&penetration[i], depth);
+        _mm_storeu_ps(&impulse[i], stop);
+    }
+#endif
+    for (; i < count; ++i) {
+        float dx = bx[i] - ax[i];
+        float dy = by[i] - ay[i];
+        float distanceSq = dx * dx + dy * dy;
+        bool separated = distanceSq > MIN_CONTACT_DISTANCE_SQ;
+        float distance = std::sqrt(std::max(distanceSq, MIN_CONTACT_DISTANCE_SQ));
+        float nx = separated ? dx / distance : 1.0f;
+        float ny = separated ? dy / distance : 0.0f;
+
+        float closing = 0.0f - ((velocityBX[i] - velocityAX[i]) * nx + (velocityBY[i] - velocityAY[i]) * ny);
+        normalX[i] = nx;
+        normalY[i] = ny;
+        penetration[i] = std::max(0.0f, radiusSum[i] - distance - PENETRATION_SLOP);
+        impulse[i] = std::max(0.0f, closing) * effectiveMass[i];
+    }
 }
 
 void PhysicsSystem::setGravity(float g) {
     gravity = g;
 }
+
+void PhysicsSystem::setEventSystem(std::shared_ptr<EventSystem> events) {
+    eventSystem = std::move(events);
+    collisionChannel = eventSystem ? &eventSystem->channel<CollisionEvent>() : nullptr;
+}
+
+void PhysicsSystem::setSpatialIndex(std::shared_ptr<SpatialIndex> index) {
+    spatialIndex = std::move(index);
+    layersMembership = ~std::uint64_t(0);  // The new index has no static layer yet
+}
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <cstdint>
+#include <utility>
 #include "../ECS/System.h"
 #include "../ECS/Component.h"
+#include "BodyKernels.h"
+#include "EventSystem.h"
+#include "SpatialIndex.h"
 
 class PhysicsSystem : public System {
 public:
@@ -14,9 +19,81 @@ public:
     
     void setGravity(float g);
 
+    // Index of every collider, shared with the systems that need proximity
+    // queries. Awake bodies are re-added each update after integration; static
+    // colliders and sleepers stay in its static layer until one of them changes.
+    void setSpatialIndex(std::shared_ptr<SpatialIndex> index);
+    std::shared_ptr<SpatialIndex> getSpatialIndex() const { return spatialIndex; }
+
+    // Each step's solid contacts go out as CollisionEvents
+    void setEventSystem(std::shared_ptr<EventSystem> events);
+
+    // Overlapping collider pairs from the last update, as spatial index items
+    const std::vector<std::pair<std::size_t, std::size_t>>& getContacts() const { return contacts; }
+
 private:
+    // Components of one entity, cached until the entity list changes
+    struct Body {
+        TransformComponent* transform;
+        ColliderComponent* collider;
+        PhysicsComponent* physics;  // Null for static colliders
+        float inverseMass;          // 0 for static colliders
+        bool solid;                 // Takes part in collision response
+        EventMask eventTags;        // For CollisionEvents
+
+        // Velocity kept over one step of friction, for the friction and step
+        // length it was worked out at; either changing recomputes it
+        float decay;
+        float decayFriction;
+        float decayStep;
+    };
+
+    // Contacts to resolve, one SIMD lane each
+    struct ContactBatch {
+        std::vector<std::uint32_t> bodyA, bodyB;
+        std::vector<float> ax, ay, bx, by;
+        std::vector<float> velocityAX, velocityAY, velocityBX, velocityBY;
+        std::vector<float> radiusSum;
+        std::vector<float> effectiveMass;  // 1 / (inverse mass A + inverse mass B)
+
+        // Narrowphase output
+        std::vector<float> normalX, normalY, penetration, impulse;
+
+        void clear();
+        void solve();
+        std::size_t size() const { return bodyA.size(); }
+    };
+
     float gravity = 0.0f;  // No gravity by default for top-down game
+    std::shared_ptr<SpatialIndex> spatialIndex = std::make_shared<SpatialIndex>();
+    std::shared_ptr<EventSystem> eventSystem;
+    EventChannel<CollisionEvent>* collisionChannel = nullptr;
+    std::vector<std::pair<std::size_t, std::size_t>> contacts;
+    std::vector<Body> bodies;  // Parallel to entities
+    std::uint64_t bodiesVersion = ~std::uint64_t(0);
+
+    // Awake bodies with physics, and the static layer's bodies, as of the
+    // membership and activity versions below
+    std::vector<std::uint32_t> movingBodies;
+    std::vector<std::uint32_t> staticBodies;  // Body of each spatial index addStatic()
+    std::uint64_t layersMembership = ~std::uint64_t(0);
+    std::uint64_t layersActivity = ~std::uint64_t(0);
+
+    std::vector<std::uint32_t> indexedBodies;  // Body of each spatial index add(), and of each lane
+    IntegrationBatch integration;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> blockerContacts;
+    ContactBatch batch;
+    std::vector<float> correctionX, correctionY;
+    std::vector<float> velocityChangeX, velocityChangeY;
     
-    void integrateVelocity(std::shared_ptr<Entity> entity, float deltaTime);
+    void integrateBodies(float deltaTime);
+    void cacheBodies();
+    void sortLayers();
+    std::uint32_t bodyOfItem(std::size_t item) const;
     void checkEntityCollisions();
+    void resolveCollisions();
+    // Whether a contact involving a sleeping body is resolved, waking it if so
+    bool settleSleeper(std::uint32_t a, std::size_t itemA, std::uint32_t b, std::size_t itemB);
+    void addContact(std::uint32_t a, std::uint32_t b, Vector2 positionA, Vector2 positionB);
+    void applyContacts(float relaxation);
 };
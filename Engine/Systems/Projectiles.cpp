@@ -0,0 +1,186 @@
+#include "Projectiles.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "../Core/WorldChecksum.h"
+
+namespace {
+// Shots are swept as small circles so a graze still counts
+const float SHOT_RADIUS = 2.0f;
+// Share of an explosion's damage left at the edge of its splash
+const float SPLASH_EDGE_DAMAGE = 0.5f;
+}  // namespace
+
+void Projectiles::setSpatialIndex(std::shared_ptr<const SpatialIndex> index) {
+    spatialIndex = std::move(index);
+}
+
+void Projectiles::spawn(Vector2 from, Vector2 to, float speed, Faction faction, const DamageProfile& profile) {
+    Vector2 offset = to - from;
+    float distance = offset.magnitude();
+    Vector2 velocity = distance > 0.0f && speed > 0.0f ? offset * (speed / distance) : Vector2::zero();
+
+    x.push_back(from.x);
+    y.push_back(from.y);
+    previousX.push_back(from.x);
+    previousY.push_back(from.y);
+    velocityX.push_back(velocity.x);
+    velocityY.push_back(velocity.y);
+    timeLeft.push_back(speed > 0.0f ? distance / speed : 0.0f);
+    profiles.push_back(profile);
+    factions.push_back(faction);
+}
+
+void Projectiles::strike(const std::shared_ptr<Entity>& target, Vector2 point, Faction faction,
+                         const DamageProfile& profile) {
+    impact(point, target, faction, profile);
+}
+
+void Projectiles::update(float deltaTime) {
+    updateBurns(deltaTime);
+    integrate(deltaTime);
+    collide();
+}
+
+void Projectiles::addToChecksum(WorldChecksum& checksum) const {
+    checksum.add(static_cast<std::uint64_t>(x.size()));
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        checksum.add(getPosition(i));
+        checksum.add(Vector2(velocityX[i], velocityY[i]));
+        checksum.add(timeLeft[i]);
+        checksum.add(profiles[i].damage);
+        checksum.add(static_cast<std::uint64_t>(profiles[i].type));
+        checksum.add(static_cast<std::uint64_t>(factions[i]));
+    }
+
+    checksum.add(static_cast<std::uint64_t>(burns.size()));
+    for (const Burn& burn : burns) {
+        checksum.add(static_cast<std::uint64_t>(burn.target ? burn.target->getId() : 0));
+        checksum.add(burn.damagePerSecond);
+        checksum.add(burn.timeLeft);
+    }
+}
+
+void Projectiles::integrate(float deltaTime) {
+    // Plain loops over the arrays, so the compiler steps several shots per
+    // instruction. A shot stops at its aim point rather than overshooting it.
+    const std::size_t count = x.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        float flight = std::min(deltaTime, std::max(0.0f, timeLeft[i]));
+        previousX[i] = x[i];
+        previousY[i] = y[i];
+        x[i] += velocityX[i] * flight;
+        y[i] += velocityY[i] * flight;
+        timeLeft[i] -= deltaTime;
+    }
+}
+
+void Projectiles::collide() {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        Vector2 from(previousX[i], previousY[i]);
+        Vector2 to(x[i], y[i]);
+        bool spent = false;
+
+        if (spatialIndex) {
+            // First enemy along this step's path; ties go to the lower id
+            std::size_t hitItem = std::numeric_limits<std::size_t>::max();
+            float hitT = 2.0f;
+            spatialIndex->forEachAlongSegment(from, to, SHOT_RADIUS, [&](std::size_t item, float t) {
+                const auto& entity = spatialIndex->getEntity(item);
+                if (t > hitT || !isHostile(*entity, factions[i])) return;
+                if (t == hitT && entity->getId() > spatialIndex->getEntity(hitItem)->getId()) return;
+                hitItem = item;
+                hitT = t;
+            });
+            if (hitItem != std::numeric_limits<std::size_t>::max()) {
+                impact(from + (to - from) * hitT, spatialIndex->getEntity(hitItem), factions[i], profiles[i]);
+                spent = true;
+            }
+        }
+
+        // Missed: explosives go off where they were aimed, anything else is lost
+        if (!spent && timeLeft[i] <= 0.0f) {
+            if (profiles[i].type == DamageType::Explosive) {
+                impact(to, nullptr, factions[i], profiles[i]);
+            }
+            spent = true;
+        }
+
+        if (!spent) {
+            x[kept] = x[i];
+            y[kept] = y[i];
+            previousX[kept] = previousX[i];
+            previousY[kept] = previousY[i];
+            velocityX[kept] = velocityX[i];
+            velocityY[kept] = velocityY[i];
+            timeLeft[kept] = timeLeft[i];
+            profiles[kept] = profiles[i];
+            factions[kept] = factions[i];
+            ++kept;
+        }
+    }
+
+    x.resize(kept);
+    y.resize(kept);
+    previousX.resize(kept);
+    previousY.resize(kept);
+    velocityX.resize(kept);
+    velocityY.resize(kept);
+    timeLeft.resize(kept);
+    profiles.resize(kept);
+    factions.resize(kept);
+}
+
+void Projectiles::updateBurns(float deltaTime) {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < burns.size(); ++i) {
+        Burn& burn = burns[i];
+        if (burn.target->isDestroyed()) continue;
+
+        hits.push_back({burn.target, burn.damagePerSecond * std::min(deltaTime, burn.timeLeft)});
+        burn.timeLeft -= deltaTime;
+        if (burn.timeLeft > 0.0f) {
+            if (kept != i) {
+                burns[kept] = std::move(burn);
+            }
+            ++kept;
+        }
+    }
+    burns.resize(kept);
+}
+
+void Projectiles::impact(Vector2 point, const std::shared_ptr<Entity>& target, Faction faction,
+                         const DamageProfile& profile) {
+    if (profile.type == DamageType::Explosive && profile.splashRadius > 0.0f && spatialIndex) {
+        // Full damage to anything the blast centre touches, falling off to the edge
+        spatialIndex->forEachOverlapping(point, profile.splashRadius, [&](std::size_t item) {
+            const auto& entity = spatialIndex->getEntity(item);
+            if (!isHostile(*entity, faction)) return;
+
+            float gap = std::max(0.0f, point.distance(spatialIndex->getPosition(item)) - spatialIndex->getRadius(item));
+            float falloff = 1.0f - (1.0f - SPLASH_EDGE_DAMAGE) * std::min(1.0f, gap / profile.splashRadius);
+            hits.push_back({entity, profile.damage * falloff});
+        });
+        return;
+    }
+
+    if (!target) {
+        return;
+    }
+
+    if (profile.type == DamageType::Fire && profile.burnDuration > 0.0f) {
+        burns.push_back({target, profile.damage / profile.burnDuration, profile.burnDuration});
+    } else {
+        hits.push_back({target, profile.damage});
+    }
+}
+
+bool Projectiles::isHostile(Entity& entity, Faction faction) const {
+    if (!entity.isActive() || entity.isDestroyed()) return false;
+
+    // Only what can be damaged stops a shot; friendly units are flown over
+    auto team = entity.getComponent<TeamComponent>();
+    if (!team || !entity.hasComponent<HealthComponent>()) return false;
+    return team->faction != faction && team->faction != Faction::Neutral;
+}
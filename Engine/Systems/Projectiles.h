@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../ECS/Component.h"
+#include "SpatialIndex.h"
+
+class WorldChecksum;
+
+// How a hit does its damage
+enum class DamageType : std::uint8_t {
+    Physical,   // All at once, to what was hit
+    Explosive,  // Splashes over splashRadius, half strength at the edge
+    Fire        // Burns the target for the damage over burnDuration seconds
+};
+
+// What one shot carries
+struct DamageProfile {
+    float damage = 0.0f;
+    DamageType type = DamageType::Physical;
+    float splashRadius = 0.0f;
+    float burnDuration = 0.0f;
+};
+
+// Shots in flight and burns in progress, pooled as structure-of-arrays. Each
+// update moves every shot in one pass over the arrays, then sweeps it from
+// where it was to where it is through the spatial index and stops it at the
+// first enemy on the way, so fast shots can't skip through a unit. Spent shots
+// are compacted out; the arrays only ever grow to the largest volley, so firing
+// doesn't allocate once a fight has warmed up.
+class Projectiles {
+public:
+    // Damage owed to one entity
+    struct Hit {
+        std::shared_ptr<Entity> target;
+        float damage;
+    };
+
+    void setSpatialIndex(std::shared_ptr<const SpatialIndex> index);
+
+    // Fires from `from` towards `to` at speed; the shot flies no further than
+    // `to` and only hits entities hostile to faction
+    void spawn(Vector2 from, Vector2 to, float speed, Faction faction, const DamageProfile& profile);
+
+    // Lands a shot on target at once, as a hitscan weapon does
+    void strike(const std::shared_ptr<Entity>& target, Vector2 point, Faction faction, const DamageProfile& profile);
+
+    // Moves every shot and ticks every burn, adding the damage they do to the hits
+    void update(float deltaTime);
+
+    // Damage from strikes and updates since clearHits(), in the order it was dealt
+    const std::vector<Hit>& getHits() const { return hits; }
+    void clearHits() { hits.clear(); }
+
+    std::size_t size() const { return x.size(); }
+    std::size_t burnCount() const { return burns.size(); }
+
+    // Where shot i was before the last update and is now, for drawing
+    Vector2 getPreviousPosition(std::size_t i) const { return Vector2(previousX[i], previousY[i]); }
+    Vector2 getPosition(std::size_t i) const { return Vector2(x[i], y[i]); }
+    DamageType getType(std::size_t i) const { return profiles[i].type; }
+
+    // Every shot and burn, in pool order, for lockstep checks
+    void addToChecksum(WorldChecksum& checksum) const;
+
+private:
+    struct Burn {
+        std::shared_ptr<Entity> target;
+        float damagePerSecond;
+        float timeLeft;
+    };
+
+    std::shared_ptr<const SpatialIndex> spatialIndex;
+
+    // One entry per shot in flight
+    std::vector<float> x, y;
+    std::vector<float> previousX, previousY;
+    std::vector<float> velocityX, velocityY;
+    std::vector<float> timeLeft;  // Flight left before the shot reaches its aim point
+    std::vector<DamageProfile> profiles;
+    std::vector<Faction> factions;
+
+    std::vector<Burn> burns;
+    std::vector<Hit> hits;
+
+    void integrate(float deltaTime);
+    void collide();
+    void updateBurns(float deltaTime);
+    void impact(Vector2 point, const std::shared_ptr<Entity>& target, Faction faction, const DamageProfile& profile);
+    bool isHostile(Entity& entity, Faction faction) const;
+};
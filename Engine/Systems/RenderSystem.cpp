@@ -1,6 +1,7 @@
 #include "RenderSystem.h"
 #include "SelectionSystem.h"
 #include "ResourceSystem.h"
+#include "CombatSystem.h"
 #include "../AI/AISystem.h"
 #include <iostream>
 #include <algorithm>
@@ -41,7 +42,14 @@ static sf::ConvexShape makeArrow(float r) {
 }
 
 void RenderSystem::update(float deltaTime) {
-    lastDeltaTime = deltaTime;
+    // Runs first in the step, so this is where entities stood before it
+    for (auto& entity : entities) {
+        auto transform = entity->getComponent<TransformComponent>();
+        if (transform) transform->previousPosition = transform->position;
+    }
+
+    // Visibility only changes when units move
+    updateFog();
 }
 
 void RenderSystem::setRequiredComponents() {
@@ -62,11 +70,28 @@ void RenderSystem::setResourceSystem(std::shared_ptr<ResourceSystem> r) {
     resourceSystem = r;
 }
 
+void RenderSystem::setCombatSystem(std::shared_ptr<CombatSystem> c) {
+    combatSystem = c;
+}
+
+void RenderSystem::setWorldSize(Vector2 size) {
+    fogGrid = ChunkedGrid<FogCell>(static_cast<int>(std::ceil(size.x / CELL_SIZE)),
+                                   static_cast<int>(std::ceil(size.y / CELL_SIZE)));
+    visibleFogCells.clear();
+}
+
+sf::FloatRect RenderSystem::getViewBounds() const {
+    const sf::View& view = window->getView();
+    return sf::FloatRect(view.getCenter() - view.getSize() * 0.5f, view.getSize());
+}
+
 // ─── Fog of War ──────────────────────────────────────────────────────────────
 void RenderSystem::updateFog() {
-    for (int row = 0; row < FOG_ROWS; ++row)
-        for (int col = 0; col < FOG_COLS; ++col)
-            fogGrid[row][col].visible = false;
+    // Only last step's lit cells need clearing, however large the map
+    const int cols = fogGrid.getWidth();
+    for (int cell : visibleFogCells)
+        fogGrid.at(cell % cols, cell / cols).visible = false;
+    visibleFogCells.clear();
 
     auto revealCircle = [&](Vector2 pos, float visionPx) {
         int cr  = static_cast<int>(pos.y / CELL_SIZE);
@@ -75,10 +100,12 @@ void RenderSystem::updateFog() {
         for (int dr = -rad; dr <= rad; ++dr) {
             for (int dc = -rad; dc <= rad; ++dc) {
                 int nr = cr + dr, nc = cc + dc;
-                if (nr < 0 || nr >= FOG_ROWS || nc < 0 || nc >= FOG_COLS) continue;
+                if (!fogGrid.isInBounds(nc, nr)) continue;
                 if (std::sqrt(float(dr*dr + dc*dc)) * CELL_SIZE <= visionPx) {
-                    fogGrid[nr][nc].visible  = true;
-                    fogGrid[nr][nc].explored = true;
+                    FogCell& cell = fogGrid.at(nc, nr);
+                    if (!cell.visible) visibleFogCells.push_back(nr * cols + nc);
+                    cell.visible  = true;
+                    cell.explored = true;
                 }
             }
         }
@@ -109,27 +136,68 @@ void RenderSystem::updateFog() {
 bool RenderSystem::isCellVisible(float worldX, float worldY) const {
     int c = static_cast<int>(worldX / CELL_SIZE);
     int r = static_cast<int>(worldY / CELL_SIZE);
-    if (r < 0 || r >= FOG_ROWS || c < 0 || c >= FOG_COLS) return true;
-    return fogGrid[r][c].visible;
+    if (!fogGrid.isInBounds(c, r)) return true;
+    return fogGrid.get(c, r).visible;
 }
 
 void RenderSystem::renderFog() {
-    for (int r = 0; r < FOG_ROWS; ++r) {
-        for (int c = 0; c < FOG_COLS; ++c) {
-            const auto& cell = fogGrid[r][c];
-            sf::Uint8 alpha;
-            if      (!cell.explored)                   alpha = 215;
-            else if (!cell.visible && cell.explored)   alpha = 105;
-            else                                       continue;
-            sf::RectangleShape tile(sf::Vector2f(CELL_SIZE, CELL_SIZE));
-            tile.setPosition(static_cast<float>(c) * CELL_SIZE,
-                             static_cast<float>(r) * CELL_SIZE);
-            tile.setFillColor(sf::Color(0, 0, 0, alpha));
-            window->draw(tile);
+    auto drawShade = [&](int c, int r, int cols, int rows, sf::Uint8 alpha) {
+        sf::RectangleShape tile(sf::Vector2f(cols * CELL_SIZE, rows * CELL_SIZE));
+        tile.setPosition(static_cast<float>(c) * CELL_SIZE,
+                         static_cast<float>(r) * CELL_SIZE);
+        tile.setFillColor(sf::Color(0, 0, 0, alpha));
+        window->draw(tile);
+    };
+
+    // Cells under the camera only; a chunk nobody has seen is one dark rectangle
+    sf::FloatRect view = getViewBounds();
+    const int chunk = ChunkedGrid<FogCell>::CHUNK_SIZE;
+    int minC = std::max(0, static_cast<int>(view.left / CELL_SIZE));
+    int minR = std::max(0, static_cast<int>(view.top / CELL_SIZE));
+    int maxC = std::min(fogGrid.getWidth() - 1, static_cast<int>((view.left + view.width) / CELL_SIZE));
+    int maxR = std::min(fogGrid.getHeight() - 1, static_cast<int>((view.top + view.height) / CELL_SIZE));
+
+    for (int chunkR = minR / chunk; chunkR <= maxR / chunk; ++chunkR) {
+        for (int chunkC = minC / chunk; chunkC <= maxC / chunk; ++chunkC) {
+            int c0 = std::max(minC, chunkC * chunk), c1 = std::min(maxC, chunkC * chunk + chunk - 1);
+            int r0 = std::max(minR, chunkR * chunk), r1 = std::min(maxR, chunkR * chunk + chunk - 1);
+            if (!fogGrid.isChunkAllocated(chunkC, chunkR)) {
+                drawShade(c0, r0, c1 - c0 + 1, r1 - r0 + 1, 215);
+                continue;
+            }
+
+            for (int r = r0; r <= r1; ++r) {
+                for (int c = c0; c <= c1; ++c) {
+                    const auto& cell = fogGrid.get(c, r);
+                    if      (!cell.explored) drawShade(c, r, 1, 1, 215);
+                    else if (!cell.visible)  drawShade(c, r, 1, 1, 105);
+                }
+            }
         }
     }
 }
 
+void RenderSystem::renderProjectiles() {
+    if (!combatSystem) return;
+
+    // Every shot as a short tracer ending where it is drawn, all in one draw call
+    const Projectiles& projectiles = combatSystem->getProjectiles();
+    std::vector<sf::Vertex> tracers;
+    tracers.reserve(projectiles.size() * 2);
+    for (std::size_t i = 0; i < projectiles.size(); ++i) {
+        Vector2 previous = projectiles.getPreviousPosition(i);
+        Vector2 head = previous + (projectiles.getPosition(i) - previous) * interpolation;
+        Vector2 tail = previous + (head - previous) * 0.5f;
+
+        sf::Color col = projectiles.getType(i) == DamageType::Explosive ? sf::Color(255, 150, 40) :
+                        projectiles.getType(i) == DamageType::Fire      ? sf::Color(255,  90, 20) :
+                                                                           sf::Color(255, 240, 160);
+        tracers.push_back({ sf::Vector2f(tail.x, tail.y), sf::Color(col.r, col.g, col.b, 0) });
+        tracers.push_back({ sf::Vector2f(head.x, head.y), col });
+    }
+    if (!tracers.empty()) window->draw(tracers.data(), tracers.size(), sf::Lines);
+}
+
 // ─── Per-type drawing helpers ─────────────────────────────────────────────────
 sf::Color RenderSystem::factionTint(sf::Color base, Faction faction) const {
     if (faction == Faction::Enemy)
@@ -139,6 +207,10 @@ sf::Color RenderSystem::factionTint(sf::Color base, Faction faction) const {
     return base;
 }
 
+Vector2 RenderSystem::getDrawPosition(const TransformComponent& transform) const {
+    return transform.previousPosition + (transform.position - transform.previousPosition) * interpolation;
+}
+
 float RenderSystem::getFacingAngle(const std::shared_ptr<Entity>& e) const {
     auto transform = e->getComponent<TransformComponent>();
     auto path      = e->getComponent<PathComponent>();
@@ -297,13 +369,18 @@ void RenderSystem::drawObstacle(Vector2 pos, float r, sf::Color col) {
     window->draw(canopy);
 }
 
-void RenderSystem::render() {
+void RenderSystem::render(float frameTime, float interpolation) {
     if (!window) return;
+    lastFrameTime = frameTime;
+    this->interpolation = interpolation;
 
-    // Terrain backdrop.
+    // Terrain backdrop, only the tiles under the camera.
     const int tile = 64;
-    for (unsigned int y = 0; y < window->getSize().y; y += tile) {
-        for (unsigned int x = 0; x < window->getSize().x; x += tile) {
+    sf::FloatRect view = getViewBounds();
+    int firstX = std::max(0, static_cast<int>(view.left) / tile * tile);
+    int firstY = std::max(0, static_cast<int>(view.top) / tile * tile);
+    for (int y = firstY; y < view.top + view.height; y += tile) {
+        for (int x = firstX; x < view.left + view.width; x += tile) {
             sf::RectangleShape ground(sf::Vector2f(static_cast<float>(tile), static_cast<float>(tile)));
             ground.setPosition(static_cast<float>(x), static_cast<float>(y));
 
@@ -323,9 +400,6 @@ void RenderSystem::render() {
     waterB.setFillColor(sf::Color(35, 70, 120, 200));
     window->draw(waterB);
 
-    // Update fog visibility each frame
-    updateFog();
-
     // Sort entities by layer
     auto sortedEntities = entities;
     std::sort(sortedEntities.begin(), sortedEntities.end(),
@@ -342,7 +416,8 @@ void RenderSystem::render() {
         auto render    = entity->getComponent<RenderComponent>();
         if (!transform || !render || !render->visible) continue;
 
-        float px = transform->position.x, py = transform->position.y;
+        Vector2 drawPos = getDrawPosition(*transform);
+        float px = drawPos.x, py = drawPos.y;
         float r  = render->width * 0.5f;
 
         auto team      = entity->getComponent<TeamComponent>();
@@ -380,6 +455,8 @@ void RenderSystem::render() {
         }
     }
 
+    renderProjectiles();
+
     // ── Fog overlay (drawn on top of entities) ────────────────────────────────
     renderFog();
 
@@ -389,7 +466,8 @@ void RenderSystem::render() {
         auto render    = entity->getComponent<RenderComponent>();
         if (!transform || !render || !render->visible) continue;
 
-        float px = transform->position.x, py = transform->position.y;
+        Vector2 drawPos = getDrawPosition(*transform);
+        float px = drawPos.x, py = drawPos.y;
         float r  = render->width * 0.5f;
 
         auto team      = entity->getComponent<TeamComponent>();
@@ -443,7 +521,8 @@ void RenderSystem::render() {
         }
     }
 
-    // ── UI / HUD ──────────────────────────────────────────────────────────────
+    // ── UI / HUD (screen space) ───────────────────────────────────────────────
+    window->setView(window->getDefaultView());
     renderUI();
 }
 
@@ -582,7 +661,7 @@ void RenderSystem::renderUI() {
     }
 
     // Dev: path nodes + FPS
-    float fps = lastDeltaTime > 0.0001f ? 1.0f / lastDeltaTime : 0.0f;
+    float fps = lastFrameTime > 0.0001f ? 1.0f / lastFrameTime : 0.0f;
     std::ostringstream dev;
     dev << "Path: " << (path ? static_cast<int>(path->waypoints.size()) : 0)
         << "  FPS: " << static_cast<int>(fps);
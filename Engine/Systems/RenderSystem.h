@@ -2,12 +2,14 @@
 
 #include "../ECS/System.h"
 #include "../ECS/Component.h"
+#include "../Core/ChunkedGrid.h"
 #include <SFML/Graphics.hpp>
 #include <memory>
 
 // Forward declarations
 class SelectionSystem;
 class ResourceSystem;
+class CombatSystem;
 
 struct FogCell {
     bool explored = false;
@@ -22,34 +24,45 @@ public:
     void setRenderTarget(sf::RenderWindow* window);
     void setSelectionSystem(std::shared_ptr<SelectionSystem> selection);
     void setResourceSystem(std::shared_ptr<ResourceSystem> resources);
-    void render();
+    void setCombatSystem(std::shared_ptr<CombatSystem> combat);
+
+    // Sizes the fog grid to the world; fog is only stored for chunks units have seen
+    void setWorldSize(Vector2 size);
+
+    // Draws each entity interpolation (0..1) of the way from where it stood before the last
+    // simulation step to where it is now; frameTime drives the FPS readout
+    void render(float frameTime, float interpolation);
 
     // Legacy shape registry (kept for compatibility)
     void registerShape(const std::string& spriteId, sf::Shape* shape);
 
 private:
-    static constexpr int   FOG_COLS  = 38;
-    static constexpr int   FOG_ROWS  = 25;
     static constexpr float CELL_SIZE = 32.0f;
 
     sf::RenderWindow* window = nullptr;
     std::shared_ptr<SelectionSystem> selectionSystem;
     std::shared_ptr<ResourceSystem>  resourceSystem;
+    std::shared_ptr<CombatSystem>    combatSystem;
     std::unordered_map<std::string, sf::Shape*> shapes;
     sf::Font  font;
     bool      fontLoaded    = false;
-    float     lastDeltaTime = 0.016f;
+    float     lastFrameTime = 0.016f;
+    float     interpolation = 1.0f;
 
-    FogCell fogGrid[FOG_ROWS][FOG_COLS]{};
+    ChunkedGrid<FogCell> fogGrid;
+    std::vector<int>     visibleFogCells;  // Row-major cells lit last step
 
     void  updateFog();
+    sf::FloatRect getViewBounds() const;
     bool  isCellVisible(float worldX, float worldY) const;
     void  renderFog();
+    void  renderProjectiles();
     void  renderUI();
     void  loadDebugFont();
 
     sf::Color factionTint(sf::Color base, Faction faction) const;
     float     getFacingAngle(const std::shared_ptr<Entity>& e) const;
+    Vector2   getDrawPosition(const TransformComponent& transform) const;
 
     // Per-type drawing helpers
     void drawWorker  (Vector2 pos, float r, sf::Color col, bool selected);
@@ -1,4 +1,5 @@
 #include "ResourceSystem.h"
+#include "../Pathfinding/PathService.h"
 #include <algorithm>
 #include <limits>
 
@@ -15,7 +16,7 @@ std::shared_ptr<Entity> findEntityById(const std::vector<std::shared_ptr<Entity>
 std::shared_ptr<Entity> findNearestResourceNode(const std::vector<std::shared_ptr<Entity>>& entities,
                                                 const Vector2& from) {
     std::shared_ptr<Entity> best = nullptr;
-    float bestDistance = std::numeric_limits<float>::max();
+    float bestDistanceSq = std::numeric_limits<float>::max();
 
     for (const auto& candidate : entities) {
         if (!candidate || !candidate->isActive() || candidate->isDestroyed()) {
@@ -28,9 +29,9 @@ std::shared_ptr<Entity> findNearestResourceNode(const std::vector<std::shared_pt
             continue;
         }
 
-        float d = transform->position.distance(from);
-        if (d < bestDistance) {
-            bestDistance = d;
+        float d = transform->position.distanceSquared(from);
+        if (d < bestDistanceSq) {
+            bestDistanceSq = d;
             best = candidate;
         }
     }
@@ -42,7 +43,7 @@ std::shared_ptr<Entity> findNearestBase(const std::vector<std::shared_ptr<Entity
                                         const Vector2& from,
                                         Faction faction) {
     std::shared_ptr<Entity> best = nullptr;
-    float bestDistance = std::numeric_limits<float>::max();
+    float bestDistanceSq = std::numeric_limits<float>::max();
 
     for (const auto& candidate : entities) {
         if (!candidate || !candidate->isActive() || candidate->isDestroyed()) {
@@ -56,15 +57,24 @@ std::shared_ptr<Entity> findNearestBase(const std::vector<std::shared_ptr<Entity
             continue;
         }
 
-        float d = transform->position.distance(from);
-        if (d < bestDistance) {
-            bestDistance = d;
+        float d = transform->position.distanceSquared(from);
+        if (d < bestDistanceSq) {
+            bestDistanceSq = d;
             best = candidate;
         }
     }
 
     return best;
 }
+
+void moveTowards(PathService* pathService, const std::shared_ptr<Entity>& entity,
+                 MovementComponent& movement, Vector2 goal) {
+    if (pathService) {
+        pathService->requestMove(entity, goal);
+    } else {
+        movement.setTarget(goal);
+    }
+}
 }  // namespace
 
 void ResourceSystem::update(float deltaTime) {
@@ -118,9 +128,8 @@ void ResourceSystem::update(float deltaTime) {
                 continue;
             }
 
-            float distance = transform->position.distance(nodeTransform->position);
-            if (distance > collector->gatherRange) {
-                movement->setTarget(nodeTransform->position);
+            if (!transform->position.isWithin(nodeTransform->position, collector->gatherRange)) {
+                moveTowards(pathService.get(), entity, *movement, nodeTransform->position);
                 continue;
             }
 
@@ -167,9 +176,8 @@ void ResourceSystem::update(float deltaTime) {
                 continue;
             }
 
-            float distance = transform->position.distance(baseTransform->position);
-            if (distance > collector->dropOffRange) {
-                movement->setTarget(baseTransform->position);
+            if (!transform->position.isWithin(baseTransform->position, collector->dropOffRange)) {
+                moveTowards(pathService.get(), entity, *movement, baseTransform->position);
                 continue;
             }
 
@@ -189,6 +197,10 @@ void ResourceSystem::setRequiredComponents() {
     // Keep empty to let this system inspect workers, bases, and resource nodes together.
 }
 
+void ResourceSystem::setPathService(std::shared_ptr<PathService> service) {
+    pathService = std::move(service);
+}
+
 void ResourceSystem::addResource(const std::string& resourceType, float amount) {
     if (globalResources.find(resourceType) == globalResources.end()) {
         globalResources[resourceType] = amount;
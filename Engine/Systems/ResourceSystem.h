@@ -4,10 +4,15 @@
 #include "../ECS/Component.h"
 #include <unordered_map>
 
+class PathService;
+
 class ResourceSystem : public System {
 public:
     void update(float deltaTime) override;
     void setRequiredComponents() override;
+
+    // Workers route their gather/return trips through the path service when set
+    void setPathService(std::shared_ptr<PathService> service);
     
     // Global resource pool
     void addResource(const std::string& resourceType, float amount);
@@ -25,6 +30,7 @@ public:
                                  const std::string& resourceType, float amount);
 
 private:
+    std::shared_ptr<PathService> pathService;
     std::unordered_map<std::string, float> globalResources;  // Shared pool
     std::unordered_map<int, std::unordered_map<std::string, float>> teamResources;
 };
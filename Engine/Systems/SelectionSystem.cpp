@@ -2,6 +2,16 @@
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <limits>
+
+namespace {
+// Click radius for entities without a RenderComponent
+const float PICK_RADIUS = 16.0f;
+// Farthest a clicked entity's centre can be; covers the largest sprites
+const float PICK_REACH = 56.0f;
+// Distance an entity may have moved since the spatial index was built
+const float PICK_SLACK = 8.0f;
+}  // namespace
 
 void SelectionSystem::update(float deltaTime) {
     // SelectionSystem is mostly event-driven, no per-frame updates needed
@@ -19,35 +29,46 @@ void SelectionSystem::handleSelection(Vector2 mousePos, bool leftClick, bool add
         clearSelection();
     }
     
-    // Find entity under mouse
-    for (auto& entity : entities) {
+    // Find the entity under the mouse closest to it
+    std::shared_ptr<Entity> picked;
+    float bestDistanceSq = std::numeric_limits<float>::max();
+    auto consider = [&](const std::shared_ptr<Entity>& entity) {
+        if (entity->isDestroyed()) return;
+
         auto transform = entity->getComponent<TransformComponent>();
         auto selection = entity->getComponent<SelectionComponent>();
         auto render = entity->getComponent<RenderComponent>();
         
-        if (!selection || !selection->isSelectable) continue;
+        if (!transform || !selection || !selection->isSelectable) return;
         
         // Calculate distance from mouse to entity center
-        float dx = mousePos.x - transform->position.x;
-        float dy = mousePos.y - transform->position.y;
-        float distance = std::sqrt(dx * dx + dy * dy);
+        float distanceSq = transform->position.distanceSquared(mousePos);
         
         // Check if click is within entity bounds (use render size or default radius)
-        float clickRadius = render ? render->width / 2.0f : 16.0f;
+        float clickRadius = render ? render->width / 2.0f : PICK_RADIUS;
         
-        if (distance <= clickRadius) {
-            selection->isSelected = true;
-            currentSelection = entity;
-            bool alreadySelected = std::any_of(selectedEntities.begin(), selectedEntities.end(),
-                [&entity](const std::shared_ptr<Entity>& existing) {
-                    return existing && existing->getId() == entity->getId();
-                });
-            if (!alreadySelected) {
-                selectedEntities.push_back(entity);
-            }
-            return;  // Select first matching entity
+        if (distanceSq <= clickRadius * clickRadius && distanceSq < bestDistanceSq) {
+            picked = entity;
+            bestDistanceSq = distanceSq;
+        }
+    };
+
+    if (spatialIndex) {
+        // Indexed positions are from the last physics step; the slack covers movement since
+        float reach = std::max(PICK_REACH, spatialIndex->getMaxRadius()) + PICK_SLACK;
+        spatialIndex->forEachInRadius(mousePos, reach, [&](std::size_t item) {
+            consider(spatialIndex->getEntity(item));
+        });
+    } else {
+        for (auto& entity : entities) {
+            consider(entity);
         }
     }
+
+    if (picked) {
+        select(picked);
+        currentSelection = picked;
+    }
 }
 
 void SelectionSystem::handleBoxSelection(Vector2 start, Vector2 end, bool additive) {
@@ -60,33 +81,39 @@ void SelectionSystem::handleBoxSelection(Vector2 start, Vector2 end, bool additi
         clearSelection();
     }
 
-    for (auto& entity : entities) {
+    auto consider = [&](const std::shared_ptr<Entity>& entity) {
+        if (entity->isDestroyed()) return;
+
         auto transform = entity->getComponent<TransformComponent>();
         auto selection = entity->getComponent<SelectionComponent>();
         auto role = entity->getComponent<RoleComponent>();
         auto team = entity->getComponent<TeamComponent>();
         if (!transform || !selection || !selection->isSelectable || !team || !role) {
-            continue;
+            return;
         }
 
         if (team->faction != Faction::Player) {
-            continue;
+            return;
         }
 
         if (role->role == EntityRole::Base || role->role == EntityRole::Turret || role->role == EntityRole::ResourceMine) {
-            continue;
+            return;
         }
 
         const Vector2& pos = transform->position;
         if (pos.x >= minX && pos.x <= maxX && pos.y >= minY && pos.y <= maxY) {
-            selection->isSelected = true;
-            bool alreadySelected = std::any_of(selectedEntities.begin(), selectedEntities.end(),
-                [&entity](const std::shared_ptr<Entity>& existing) {
-                    return existing && existing->getId() == entity->getId();
-                });
-            if (!alreadySelected) {
-                selectedEntities.push_back(entity);
-            }
+            select(entity);
+        }
+    };
+
+    if (spatialIndex) {
+        Vector2 slack(PICK_SLACK, PICK_SLACK);
+        spatialIndex->forEachInBox(Vector2(minX, minY) - slack, Vector2(maxX, maxY) + slack, [&](std::size_t item) {
+            consider(spatialIndex->getEntity(item));
+        });
+    } else {
+        for (auto& entity : entities) {
+            consider(entity);
         }
     }
 
@@ -95,6 +122,21 @@ void SelectionSystem::handleBoxSelection(Vector2 start, Vector2 end, bool additi
     }
 }
 
+void SelectionSystem::select(const std::shared_ptr<Entity>& entity) {
+    entity->getComponent<SelectionComponent>()->isSelected = true;
+    bool alreadySelected = std::any_of(selectedEntities.begin(), selectedEntities.end(),
+        [&entity](const std::shared_ptr<Entity>& existing) {
+            return existing && existing->getId() == entity->getId();
+        });
+    if (!alreadySelected) {
+        selectedEntities.push_back(entity);
+    }
+}
+
+void SelectionSystem::setSpatialIndex(std::shared_ptr<SpatialIndex> index) {
+    spatialIndex = std::move(index);
+}
+
 std::shared_ptr<Entity> SelectionSystem::getSelectedEntity() const {
     return currentSelection;
 }
@@ -113,3 +155,12 @@ void SelectionSystem::clearSelection() {
     currentSelection = nullptr;
     selectedEntities.clear();
 }
+
+void SelectionSystem::removeDestroyed() {
+    selectedEntities.erase(std::remove_if(selectedEntities.begin(), selectedEntities.end(),
+        [](const std::shared_ptr<Entity>& entity) { return !entity || entity->isDestroyed(); }),
+        selectedEntities.end());
+    if (currentSelection && currentSelection->isDestroyed()) {
+        currentSelection = selectedEntities.empty() ? nullptr : selectedEntities.front();
+    }
+}
@@ -3,6 +3,7 @@
 #include "../ECS/System.h"
 #include "../ECS/Component.h"
 #include "../Math/Vector2.h"
+#include "SpatialIndex.h"
 #include <SFML/Window.hpp>
 
 class SelectionSystem : public System {
@@ -21,7 +22,16 @@ public:
     // Clear all selections
     void clearSelection();
 
+    // Drops destroyed entities from the selection
+    void removeDestroyed();
+
+    // Picking and box selection look entities up here instead of scanning them all
+    void setSpatialIndex(std::shared_ptr<SpatialIndex> index);
+
 private:
+    void select(const std::shared_ptr<Entity>& entity);
+
+    std::shared_ptr<SpatialIndex> spatialIndex;
     std::shared_ptr<Entity> currentSelection;
     std::vector<std::shared_ptr<Entity>> selectedEntities;
 };
@@ -8,6 +8,7 @@ SoundSystem::SoundSystem() {
         addSound("attack",  200.0f, 0.14f, 0.28f);
         addSound("produce", 440.0f, 0.22f, 0.22f);
         addSound("gather",  550.0f, 0.08f, 0.15f);
+        addSound("death",   120.0f, 0.25f, 0.25f);
         audioReady = true;
     } catch (...) {
         // Audio not available in this environment — sounds silently disabled.
@@ -59,3 +60,13 @@ void SoundSystem::playMove()    { play("move");    }
 void SoundSystem::playAttack()  { play("attack");  }
 void SoundSystem::playProduce() { play("produce"); }
 void SoundSystem::playGather()  { play("gather");  }
+void SoundSystem::playDeath()   { play("death");   }
+
+void SoundSystem::listen(EventSystem& events) {
+    // Only units and buildings have a death sound
+    EventFilter unitsAndBuildings;
+    unitsAndBuildings.any = EventTags::UNIT | EventTags::BUILDING;
+    events.subscribe<EntityDestroyedEvent>([this](const EventView<EntityDestroyedEvent>&) {
+        playDeath();
+    }, unitsAndBuildings);
+}
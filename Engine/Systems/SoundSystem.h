@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <cmath>
+#include "EventSystem.h"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -20,6 +21,11 @@ public:
     void playAttack();   // attack order
     void playProduce();  // unit produced
     void playGather();   // gather order / resource collected
+    void playDeath();    // units or buildings destroyed
+
+    // Plays the game events it has a sound for, once per batch however many
+    // arrive; it is only handed the ones it wants
+    void listen(EventSystem& events);
 
 private:
     static std::vector<sf::Int16> generateTone(float freqHz, float durationSec,
@@ -0,0 +1,148 @@
+#include "SpatialIndex.h"
+
+namespace {
+// Smallest hash table; keeps bucket lookups cheap for tiny worlds
+const int MIN_BUCKET_BITS = 6;
+}  // namespace
+
+SpatialIndex::SpatialIndex(float cellSize)
+    : cellSize(cellSize), inverseCellSize(1.0f / cellSize) {}
+
+void SpatialIndex::clear() {
+    pendingDynamic.clear();
+}
+
+void SpatialIndex::add(const std::shared_ptr<Entity>& entity, Vector2 position, float radius,
+                       std::uint32_t itemFlags, Vector2 velocity) {
+    pendingDynamic.add(entity, position, radius, itemFlags, velocity);
+}
+
+void SpatialIndex::clearStatic() {
+    pendingStatic.clear();
+    staticChanged = true;
+}
+
+void SpatialIndex::addStatic(const std::shared_ptr<Entity>& entity, Vector2 position, float radius,
+                             std::uint32_t itemFlags) {
+    pendingStatic.add(entity, position, radius, itemFlags, Vector2());
+}
+
+void SpatialIndex::build() {
+    // The static layer keeps its items and buckets unless it was replaced
+    if (staticChanged) {
+        sortLayer(pendingStatic, 0, staticLayer);
+        pendingStatic.clear();
+        staticChanged = false;
+    }
+    sortLayer(pendingDynamic, staticLayer.end, dynamicLayer);
+    pendingDynamic.clear();
+}
+
+void SpatialIndex::sortLayer(Pending& pending, std::uint32_t begin, Layer& layer) {
+    const std::size_t count = pending.entities.size();
+
+    // About two buckets per item keeps collisions between cells rare
+    int bucketBits = MIN_BUCKET_BITS;
+    while ((std::size_t(1) << bucketBits) < count * 2) {
+        ++bucketBits;
+    }
+    layer.bucketShift = 64 - bucketBits;
+    const std::size_t bucketCount = std::size_t(1) << bucketBits;
+
+    // Counting sort: histogram, prefix sum, scatter
+    layer.bucketStart.assign(bucketCount + 1, 0);
+    pendingBucket.resize(count);
+    layer.maxRadius = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t bucket = layer.bucketOf(cellKey(cellCoord(pending.x[i]), cellCoord(pending.y[i])));
+        pendingBucket[i] = static_cast<std::uint32_t>(bucket);
+        ++layer.bucketStart[bucket];
+        layer.maxRadius = std::max(layer.maxRadius, pending.radii[i]);
+    }
+    layer.bucketStart[0] += begin;
+    for (std::size_t bucket = 1; bucket <= bucketCount; ++bucket) {
+        layer.bucketStart[bucket] += layer.bucketStart[bucket - 1];
+    }
+    layer.begin = begin;
+    layer.end = begin + static_cast<std::uint32_t>(count);
+
+    // The moving layer comes last, so its sort sets the item count; a static
+    // sort only has to make room
+    const std::size_t total = layer.end;
+    if (&layer == &dynamicLayer || entities.size() < total) {
+        entities.resize(total);
+        positionX.resize(total);
+        positionY.resize(total);
+        radii.resize(total);
+        flags.resize(total);
+        velocityX.resize(total);
+        velocityY.resize(total);
+        cellX.resize(total);
+        cellY.resize(total);
+        sourceIndex.resize(total);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        // Each entry holds its bucket's end and counts down to its start as items land
+        std::uint32_t item = --layer.bucketStart[pendingBucket[i]];
+        entities[item] = std::move(pending.entities[i]);
+        positionX[item] = pending.x[i];
+        positionY[item] = pending.y[i];
+        radii[item] = pending.radii[i];
+        flags[item] = pending.flags[i];
+        velocityX[item] = pending.velocities[i].x;
+        velocityY[item] = pending.velocities[i].y;
+        cellX[item] = cellCoord(pending.x[i]);
+        cellY[item] = cellCoord(pending.y[i]);
+        sourceIndex[item] = static_cast<std::uint32_t>(i);
+    }
+}
+
+void SpatialIndex::Pending::clear() {
+    entities.clear();
+    x.clear();
+    y.clear();
+    radii.clear();
+    flags.clear();
+    velocities.clear();
+}
+
+void SpatialIndex::Pending::add(const std::shared_ptr<Entity>& entity, Vector2 position, float radius,
+                                std::uint32_t itemFlags, Vector2 velocity) {
+    entities.push_back(entity);
+    x.push_back(position.x);
+    y.push_back(position.y);
+    radii.push_back(radius);
+    flags.push_back(itemFlags);
+    velocities.push_back(velocity);
+}
+
+void SpatialIndex::queryRadius(Vector2 center, float radius, std::vector<std::size_t>& out) const {
+    out.clear();
+    forEachInRadius(center, radius, [&out](std::size_t item) { out.push_back(item); });
+}
+
+void SpatialIndex::queryBox(Vector2 min, Vector2 max, std::vector<std::size_t>& out) const {
+    out.clear();
+    forEachInBox(min, max, [&out](std::size_t item) { out.push_back(item); });
+}
+
+void SpatialIndex::cellsWithin(Vector2 center, float radius, std::vector<Cell>& out) const {
+    out.clear();
+    const int minCellX = cellCoord(center.x - radius);
+    const int minCellY = cellCoord(center.y - radius);
+    const int maxCellX = cellCoord(center.x + radius);
+    const int maxCellY = cellCoord(center.y + radius);
+    const float radiusSq = radius * radius;
+    for (int y = minCellY; y <= maxCellY; ++y) {
+        for (int x = minCellX; x <= maxCellX; ++x) {
+            // Nearest point of the cell to the centre
+            float nearestX = std::max(x * cellSize, std::min(center.x, (x + 1) * cellSize));
+            float nearestY = std::max(y * cellSize, std::min(center.y, (y + 1) * cellSize));
+            float dx = nearestX - center.x;
+            float dy = nearestY - center.y;
+            if (dx * dx + dy * dy <= radiusSq) {
+                out.push_back(Cell{x, y});
+            }
+        }
+    }
+}
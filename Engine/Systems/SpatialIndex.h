@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "../ECS/Entity.h"
+#include "../Math/Vector2.h"
+
+// Uniform-grid broadphase over every collider in the world. Items are counting-
+// sorted into hashed cells, so a rebuild is O(n) however large the world is and
+// each cell's items sit next to each other in memory. Queries only read, so any
+// number of threads may run them between rebuilds. Item indices handed to the
+// callbacks stay valid until the next rebuild.
+//
+// Items that hold still can go in a static layer with its own grid, which is
+// kept across rebuilds, so a rebuild only costs the items that move. Queries
+// see both layers as one; static items come first in item order.
+class SpatialIndex {
+public:
+    static constexpr float DEFAULT_CELL_SIZE = 64.0f;
+
+    // Item flags set by PhysicsSystem
+    static constexpr std::uint32_t SOLID = 1u << 0;   // Takes part in collision response
+    static constexpr std::uint32_t MOBILE = 1u << 1;  // Has a PhysicsComponent and can move
+    static constexpr std::uint32_t SLEEPING = 1u << 2;  // Mobile but asleep, so holding still
+
+    // One square of the grid, in cell coordinates
+    struct Cell {
+        int x;
+        int y;
+
+        bool operator==(const Cell& other) const { return x == other.x && y == other.y; }
+    };
+
+    explicit SpatialIndex(float cellSize = DEFAULT_CELL_SIZE);
+
+    // Rebuild: clear(), add() every item, then build() before querying
+    void clear();
+    void add(const std::shared_ptr<Entity>& entity, Vector2 position, float radius,
+             std::uint32_t flags = 0, Vector2 velocity = Vector2());
+    void build();
+
+    // Replace the static layer: clearStatic(), addStatic() every item, and the
+    // next build() sorts them in. Until then the old layer stays in place.
+    void clearStatic();
+    void addStatic(const std::shared_ptr<Entity>& entity, Vector2 position, float radius, std::uint32_t flags = 0);
+
+    std::size_t size() const { return entities.size(); }
+    std::size_t staticSize() const { return staticLayer.end; }
+    bool isStatic(std::size_t item) const { return item < staticLayer.end; }
+    float getCellSize() const { return cellSize; }
+    float getMaxRadius() const { return std::max(staticLayer.maxRadius, dynamicLayer.maxRadius); }
+
+    const std::shared_ptr<Entity>& getEntity(std::size_t item) const { return entities[item]; }
+    Vector2 getPosition(std::size_t item) const { return Vector2(positionX[item], positionY[item]); }
+    float getRadius(std::size_t item) const { return radii[item]; }
+    std::uint32_t getFlags(std::size_t item) const { return flags[item]; }
+    Vector2 getVelocity(std::size_t item) const { return Vector2(velocityX[item], velocityY[item]); }
+
+    // Position of the item in the add() sequence, or the addStatic() one for a
+    // static item, for callers keeping parallel data
+    std::size_t getSourceIndex(std::size_t item) const { return sourceIndex[item]; }
+
+    // Items whose centre lies within radius of center
+    template <typename Fn>
+    void forEachInRadius(Vector2 center, float radius, Fn&& fn) const {
+        const float radiusSq = radius * radius;
+        forEachInCells(center.x - radius, center.y - radius, center.x + radius, center.y + radius,
+            [&](std::size_t item) {
+                float dx = positionX[item] - center.x;
+                float dy = positionY[item] - center.y;
+                if (dx * dx + dy * dy <= radiusSq) {
+                    fn(item);
+                }
+            });
+    }
+
+    // Items whose collider overlaps the circle
+    template <typename Fn>
+    void forEachOverlapping(Vector2 center, float radius, Fn&& fn) const {
+        const float reach = radius + getMaxRadius();
+        forEachInCells(center.x - reach, center.y - reach, center.x + reach, center.y + reach,
+            [&](std::size_t item) {
+                float dx = positionX[item] - center.x;
+                float dy = positionY[item] - center.y;
+                float limit = radius + radii[item];
+                if (dx * dx + dy * dy <= limit * limit) {
+                    fn(item);
+                }
+            });
+    }
+
+    // Items whose centre lies inside the box
+    template <typename Fn>
+    void forEachInBox(Vector2 min, Vector2 max, Fn&& fn) const {
+        forEachInCells(min.x, min.y, max.x, max.y, [&](std::size_t item) {
+            if (positionX[item] >= min.x && positionX[item] <= max.x &&
+                positionY[item] >= min.y && positionY[item] <= max.y) {
+                fn(item);
+            }
+        });
+    }
+
+    // Items whose collider a circle of the given radius touches on its way from
+    // `from` to `to`; fn also gets the fraction of the way to the closest approach
+    template <typename Fn>
+    void forEachAlongSegment(Vector2 from, Vector2 to, float radius, Fn&& fn) const {
+        const float reach = radius + getMaxRadius();
+        const float sx = to.x - from.x;
+        const float sy = to.y - from.y;
+        const float lengthSq = sx * sx + sy * sy;
+        forEachInCells(std::min(from.x, to.x) - reach, std::min(from.y, to.y) - reach,
+                       std::max(from.x, to.x) + reach, std::max(from.y, to.y) + reach,
+            [&](std::size_t item) {
+                float t = 0.0f;
+                if (lengthSq > 0.0f) {
+                    t = ((positionX[item] - from.x) * sx + (positionY[item] - from.y) * sy) / lengthSq;
+                    t = std::max(0.0f, std::min(1.0f, t));
+                }
+                float dx = from.x + sx * t - positionX[item];
+                float dy = from.y + sy * t - positionY[item];
+                float limit = radius + radii[item];
+                if (dx * dx + dy * dy <= limit * limit) {
+                    fn(item, t);
+                }
+            });
+    }
+
+    // Every pair of overlapping colliders once, lower item first, leaving out
+    // pairs of static items. Walks occupied moving cells and pairs each with
+    // itself and the forward half of its neighbours, so no pair is seen twice
+    // and each cell is hashed once rather than per item; then looks up the
+    // static items around each moving one.
+    template <typename Fn>
+    void forEachOverlappingPair(Fn&& fn) const {
+        if (dynamicLayer.empty()) {
+            return;
+        }
+
+        auto test = [&](std::size_t a, std::size_t b) {
+            float dx = positionX[b] - positionX[a];
+            float dy = positionY[b] - positionY[a];
+            float limit = radii[a] + radii[b];
+            if (dx * dx + dy * dy < limit * limit) {
+                fn(std::min(a, b), std::max(a, b));
+            }
+        };
+
+        // Furthest apart, in cells, two of the largest moving colliders can touch
+        const Layer& layer = dynamicLayer;
+        const int span = std::max(1, static_cast<int>(std::ceil(2.0f * layer.maxRadius * inverseCellSize)));
+        const std::size_t bucketCount = layer.bucketStart.size() - 1;
+        for (std::size_t bucket = 0; bucket < bucketCount; ++bucket) {
+            const std::uint32_t begin = layer.bucketStart[bucket];
+            const std::uint32_t end = layer.bucketStart[bucket + 1];
+            for (std::uint32_t first = begin; first < end; ++first) {
+                const int x = cellX[first];
+                const int y = cellY[first];
+                if (!isFirstOfCell(begin, first)) continue;
+
+                for (std::uint32_t a = first; a < end; ++a) {
+                    if (cellX[a] != x || cellY[a] != y) continue;
+                    for (std::uint32_t b = a + 1; b < end; ++b) {
+                        if (cellX[b] == x && cellY[b] == y) {
+                            test(a, b);
+                        }
+                    }
+                }
+
+                for (int dy = 0; dy <= span; ++dy) {
+                    for (int dx = -span; dx <= span; ++dx) {
+                        if (dy == 0 && dx <= 0) continue;
+
+                        const int nx = x + dx;
+                        const int ny = y + dy;
+                        const std::size_t neighborBucket = layer.bucketOf(cellKey(nx, ny));
+                        for (std::uint32_t b = layer.bucketStart[neighborBucket];
+                             b < layer.bucketStart[neighborBucket + 1]; ++b) {
+                            if (cellX[b] != nx || cellY[b] != ny) continue;
+                            for (std::uint32_t a = first; a < end; ++a) {
+                                if (cellX[a] == x && cellY[a] == y) {
+                                    test(a, b);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        if (staticLayer.empty()) {
+            return;
+        }
+        for (std::size_t a = dynamicLayer.begin; a < dynamicLayer.end; ++a) {
+            const float reach = radii[a] + staticLayer.maxRadius;
+            forEachInLayerCells(staticLayer, positionX[a] - reach, positionY[a] - reach,
+                                positionX[a] + reach, positionY[a] + reach,
+                                [&](std::size_t b) { test(a, b); });
+        }
+    }
+
+    // The cell an item centred at position is stored in
+    Cell cellAt(Vector2 position) const { return Cell{cellCoord(position.x), cellCoord(position.y)}; }
+
+    // Cells that hold points within radius of center, so an item centred in
+    // range is always stored in one of them. Only depends on the cell size, so
+    // callers that don't move can work it out once and keep it.
+    void cellsWithin(Vector2 center, float radius, std::vector<Cell>& out) const;
+
+    // Items stored in the cell
+    template <typename Fn>
+    void forEachInCell(Cell cell, Fn&& fn) const {
+        for (const Layer* layer : {&staticLayer, &dynamicLayer}) {
+            if (layer->empty()) continue;
+            const std::size_t bucket = layer->bucketOf(cellKey(cell.x, cell.y));
+            for (std::uint32_t item = layer->bucketStart[bucket]; item < layer->bucketStart[bucket + 1]; ++item) {
+                if (cellX[item] == cell.x && cellY[item] == cell.y) {
+                    fn(static_cast<std::size_t>(item));
+                }
+            }
+        }
+    }
+
+    // Collecting forms of the queries above
+    void queryRadius(Vector2 center, float radius, std::vector<std::size_t>& out) const;
+    void queryBox(Vector2 min, Vector2 max, std::vector<std::size_t>& out) const;
+
+private:
+    // Keeps cell coordinates well inside int range for far-off or garbage positions
+    static constexpr float MAX_CELL_COORD = 1 << 30;
+
+    int cellCoord(float value) const {
+        return static_cast<int>(std::max(-MAX_CELL_COORD, std::min(MAX_CELL_COORD, std::floor(value * inverseCellSize))));
+    }
+
+    static std::uint64_t cellKey(int x, int y) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+    }
+
+    // One layer's items, [begin, end) in item order, hashed into its own buckets
+    struct Layer {
+        std::uint32_t begin = 0;
+        std::uint32_t end = 0;
+        int bucketShift = 64;
+        std::vector<std::uint32_t> bucketStart;  // Bucket b holds items [bucketStart[b], bucketStart[b + 1])
+        float maxRadius = 0.0f;
+
+        bool empty() const { return begin == end; }
+        std::size_t bucketOf(std::uint64_t key) const {
+            return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ull) >> bucketShift);
+        }
+    };
+
+    // Items added for one layer, before sorting
+    struct Pending {
+        std::vector<std::shared_ptr<Entity>> entities;
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> radii;
+        std::vector<std::uint32_t> flags;
+        std::vector<Vector2> velocities;
+
+        void clear();
+        void add(const std::shared_ptr<Entity>& entity, Vector2 position, float radius,
+                 std::uint32_t itemFlags, Vector2 velocity);
+    };
+
+    // Counting-sorts pending items into items [begin, begin + count) and the layer's buckets
+    void sortLayer(Pending& pending, std::uint32_t begin, Layer& layer);
+
+    // Whether no earlier item of the bucket shares this item's cell
+    bool isFirstOfCell(std::uint32_t bucketBegin, std::uint32_t item) const {
+        for (std::uint32_t other = bucketBegin; other < item; ++other) {
+            if (cellX[other] == cellX[item] && cellY[other] == cellY[item]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Every item stored in the cells overlapping the rectangle, in both layers
+    template <typename Fn>
+    void forEachInCells(float minX, float minY, float maxX, float maxY, Fn&& fn) const {
+        forEachInLayerCells(staticLayer, minX, minY, maxX, maxY, fn);
+        forEachInLayerCells(dynamicLayer, minX, minY, maxX, maxY, fn);
+    }
+
+    // Distinct cells can share a bucket, so items are matched on their own cell key as well
+    template <typename Fn>
+    void forEachInLayerCells(const Layer& layer, float minX, float minY, float maxX, float maxY, Fn&& fn) const {
+        if (layer.empty()) {
+            return;
+        }
+
+        const int minCellX = cellCoord(minX);
+        const int minCellY = cellCoord(minY);
+        const int maxCellX = cellCoord(maxX);
+        const int maxCellY = cellCoord(maxY);
+        const std::int64_t cellCount = (static_cast<std::int64_t>(maxCellX) - minCellX + 1) *
+                                       (static_cast<std::int64_t>(maxCellY) - minCellY + 1);
+        if (cellCount > static_cast<std::int64_t>(layer.bucketStart.size() - 1)) {
+            // Wider than the table: walking every item is cheaper than every cell
+            for (std::size_t item = layer.begin; item < layer.end; ++item) {
+                if (cellX[item] >= minCellX && cellX[item] <= maxCellX &&
+                    cellY[item] >= minCellY && cellY[item] <= maxCellY) {
+                    fn(item);
+                }
+            }
+            return;
+        }
+
+        for (int y = minCellY; y <= maxCellY; ++y) {
+            for (int x = minCellX; x <= maxCellX; ++x) {
+                const std::size_t bucket = layer.bucketOf(cellKey(x, y));
+                for (std::uint32_t item = layer.bucketStart[bucket]; item < layer.bucketStart[bucket + 1]; ++item) {
+                    if (cellX[item] == x && cellY[item] == y) {
+                        fn(static_cast<std::size_t>(item));
+                    }
+                }
+            }
+        }
+    }
+
+    float cellSize;
+    float inverseCellSize;
+    Layer staticLayer;   // Items [0, staticLayer.end)
+    Layer dynamicLayer;  // The rest
+
+    // Items in layer and bucket order, structure-of-arrays
+    std::vector<std::shared_ptr<Entity>> entities;
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> radii;
+    std::vector<std::uint32_t> flags;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<int> cellX;
+    std::vector<int> cellY;
+    std::vector<std::uint32_t> sourceIndex;
+
+    // Items added since clear() and clearStatic(), before sorting
+    Pending pendingDynamic;
+    Pending pendingStatic;
+    bool staticChanged = false;  // clearStatic() since the last build()
+    std::vector<std::uint32_t> pendingBucket;
+};
@@ -16,5 +16,6 @@ void Turret::setupComponents(Vector2 position) {
     combat->attackDamage = 20.0f;
     combat->attackRange = 150.0f;
     combat->attackCooldown = 1.0f;
+    combat->projectileSpeed = 450.0f;
     entity->addComponent(combat);
 }
@@ -9,9 +9,40 @@
 #include "Buildings/ResourceMine.h"
 #include "Buildings/Turret.h"
 
-GameManager::GameManager() {
-    // Create engine (800x600 window)
-    engine = std::make_shared<Engine>(1200, 800, "AI Strategy Game");
+namespace {
+
+// Gold price of each unit a base can produce, zero for anything else
+float productionCost(EntityRole role) {
+    switch (role) {
+        case EntityRole::Worker:  return 75.0f;
+        case EntityRole::Soldier: return 120.0f;
+        case EntityRole::Tank:    return 220.0f;
+        case EntityRole::Scout:   return 140.0f;
+        default:                  return 0.0f;
+    }
+}
+
+}
+
+GameManager::GameManager() : GameManager(EngineConfig()) {}
+
+GameManager::GameManager(const EngineConfig& config) {
+    engine = std::make_shared<Engine>(config);
+    // Nobody is at the keyboard of a headless game
+    playerAIControlled = config.headless;
+    // Production and building are queued as commands so they can be recorded
+    engine->setCommandHandler([this](const PlayerCommand& command) { applyCommand(command); });
+}
+
+void GameManager::playReplay(const Replay& replay) {
+    playerAIControlled = replay.getHeader().playerAIControlled;
+    engine->startPlayback(replay);
+}
+
+bool GameManager::startRecording(const std::string& path) {
+    ReplayHeader header;
+    header.playerAIControlled = playerAIControlled;
+    return engine->startRecording(path, header);
 }
 
 GameManager::~GameManager() {
@@ -27,14 +58,17 @@ void GameManager::shutdown() {
     // Clean up handled by smart pointers
 }
 
-void GameManager::update(float deltaTime) {
+void GameManager::pollEvents() {
     engine->pollEvents();
+}
+
+void GameManager::update(float deltaTime) {
     handlePlayerActions(deltaTime);
     engine->update(deltaTime);
 }
 
-void GameManager::render() {
-    engine->render();
+void GameManager::render(float frameTime, float interpolation) {
+    engine->render(frameTime, interpolation);
 }
 
 bool GameManager::isRunning() {
@@ -106,7 +140,7 @@ std::shared_ptr<Entity> GameManager::spawnObstacle(Vector2 position, Vector2 siz
 
 void GameManager::setupLevel() {
     // Spawn player base
-    spawnBase(Vector2(130.0f, 120.0f), Faction::Player, false);
+    spawnBase(Vector2(130.0f, 120.0f), Faction::Player, playerAIControlled);
     
     // Spawn enemy base
     spawnBase(Vector2(1060.0f, 680.0f), Faction::Enemy, true);
@@ -123,12 +157,17 @@ void GameManager::setupLevel() {
     spawnObstacle(Vector2(640.0f, 360.0f), Vector2(56.0f, 56.0f));
     spawnObstacle(Vector2(700.0f, 500.0f), Vector2(56.0f, 56.0f));
     spawnObstacle(Vector2(740.0f, 540.0f), Vector2(56.0f, 56.0f));
+
+    // Shallow water drawn by the renderer is mud for pathing: slow for infantry, impassable for tanks
+    auto pathfinder = engine->getPathfinder();
+    pathfinder->setTerrain(Vector2(420.0f, 120.0f), Vector2(670.0f, 220.0f), TerrainType::Mud);
+    pathfinder->setTerrain(Vector2(760.0f, 470.0f), Vector2(940.0f, 560.0f), TerrainType::Mud);
     
     // Spawn initial units
-    spawnWorker(Vector2(200.0f, 150.0f), Faction::Player, false);
-    spawnWorker(Vector2(250.0f, 150.0f), Faction::Player, false);
-    spawnSoldier(Vector2(290.0f, 180.0f), Faction::Player, false);
-    spawnScout(Vector2(240.0f, 220.0f), Faction::Player, false);
+    spawnWorker(Vector2(200.0f, 150.0f), Faction::Player, playerAIControlled);
+    spawnWorker(Vector2(250.0f, 150.0f), Faction::Player, playerAIControlled);
+    spawnSoldier(Vector2(290.0f, 180.0f), Faction::Player, playerAIControlled);
+    spawnScout(Vector2(240.0f, 220.0f), Faction::Player, playerAIControlled);
 
     spawnWorker(Vector2(980.0f, 640.0f), Faction::Enemy, true);
     spawnSoldier(Vector2(940.0f, 620.0f), Faction::Enemy, true);
@@ -137,7 +176,7 @@ void GameManager::setupLevel() {
     spawnScout(Vector2(960.0f, 560.0f), Faction::Enemy, true);
 
     spawnTurret(Vector2(980.0f, 720.0f), Faction::Enemy, true);
-    spawnTurret(Vector2(270.0f, 90.0f), Faction::Player, false);
+    spawnTurret(Vector2(270.0f, 90.0f), Faction::Player, playerAIControlled);
 
     // Initial faction resource banks.
     engine->getResourceSystem()->addResource(Faction::Player, "Gold", 450.0f);
@@ -152,41 +191,55 @@ void GameManager::handlePlayerActions(float deltaTime) {
     actionCooldown = std::max(0.0f, actionCooldown - deltaTime);
     enemyProductionTimer += deltaTime;
 
-    handleProduction();
-    handleBuildingPlacement();
+    // Headless games have no keyboard or mouse to read
+    if (!engine->isHeadless()) {
+        handleProduction();
+        handleBuildingPlacement();
+    }
 
     if (enemyProductionTimer >= 12.0f) {
         enemyProductionTimer = 0.0f;
-
-        std::shared_ptr<Entity> enemyBase = nullptr;
-        for (const auto& [id, entity] : engine->getRegistry()->getEntities()) {
-            if (!entity || !entity->isActive() || entity->isDestroyed()) {
-                continue;
-            }
-            auto role = entity->getComponent<RoleComponent>();
-            auto team = entity->getComponent<TeamComponent>();
-            if (role && team && role->role == EntityRole::Base && team->faction == Faction::Enemy) {
-                enemyBase = entity;
-                break;
-            }
+        reinforce(Faction::Enemy);
+        if (playerAIControlled) {
+            reinforce(Faction::Player);
         }
+    }
+}
 
-        if (enemyBase) {
-            auto transform = enemyBase->getComponent<TransformComponent>();
-            if (transform) {
-                Vector2 spawnA(transform->position.x - 70.0f, transform->position.y - 40.0f);
-                Vector2 spawnB(transform->position.x - 95.0f, transform->position.y + 20.0f);
-                auto resourceSystem = engine->getResourceSystem();
-
-                if (resourceSystem->spendResource(Faction::Enemy, "Gold", 120.0f)) {
-                    spawnSoldier(spawnA, Faction::Enemy, true);
-                }
-                if (resourceSystem->spendResource(Faction::Enemy, "Gold", 140.0f)) {
-                    spawnScout(spawnB, Faction::Enemy, true);
-                }
-            }
+void GameManager::reinforce(Faction faction) {
+    std::shared_ptr<Entity> base = nullptr;
+    for (const auto& [id, entity] : engine->getRegistry()->getEntities()) {
+        if (!entity || !entity->isActive() || entity->isDestroyed()) {
+            continue;
+        }
+        auto role = entity->getComponent<RoleComponent>();
+        auto team = entity->getComponent<TeamComponent>();
+        if (role && team && role->role == EntityRole::Base && team->faction == faction) {
+            base = entity;
+            break;
         }
     }
+
+    if (!base) {
+        return;
+    }
+    auto transform = base->getComponent<TransformComponent>();
+    if (!transform) {
+        return;
+    }
+
+    // Reinforcements form up on the side of the base facing the other army
+    float side = faction == Faction::Enemy ? -1.0f : 1.0f;
+    Vector2 spawnA(transform->position.x + side * 70.0f, transform->position.y + side * 40.0f);
+    Vector2 spawnB(transform->position.x + side * 95.0f, transform->position.y - side * 20.0f);
+    auto resourceSystem = engine->getResourceSystem();
+
+    if (resourceSystem->spendResource(faction, "Gold", 120.0f)) {
+        spawnSoldier(spawnA, faction, true);
+    }
+    if (resourceSystem->spendResource(faction, "Gold", 140.0f)) {
+        spawnScout(spawnB, faction, true);
+    }
 }
 
 void GameManager::handleProduction() {
@@ -194,8 +247,9 @@ void GameManager::handleProduction() {
         return;
     }
 
+    // A base destroyed this step may still be selected until the deaths are dispatched
     auto selected = engine->getSelectionSystem()->getSelectedEntity();
-    if (!selected) {
+    if (!selected || selected->isDestroyed()) {
         return;
     }
 
@@ -206,34 +260,30 @@ void GameManager::handleProduction() {
         return;
     }
 
-    auto resourceSystem = engine->getResourceSystem();
-    Vector2 spawnPoint(transform->position.x + 80.0f, transform->position.y + 60.0f);
+    PlayerCommand produce;
+    produce.kind = PlayerCommand::Kind::Produce;
+    produce.position = Vector2(transform->position.x + 80.0f, transform->position.y + 60.0f);
 
     if (engine->getInputSystem()->isKeyPressed(sf::Keyboard::Num1)) {
-        if (resourceSystem->spendResource(Faction::Player, "Gold", 75.0f)) {
-            spawnWorker(spawnPoint, Faction::Player, false);
-            actionCooldown = 0.18f;
-            if (engine->getSoundSystem()) engine->getSoundSystem()->playProduce();
-        }
+        produce.role = EntityRole::Worker;
     } else if (engine->getInputSystem()->isKeyPressed(sf::Keyboard::Num2)) {
-        if (resourceSystem->spendResource(Faction::Player, "Gold", 120.0f)) {
-            spawnSoldier(spawnPoint, Faction::Player, false);
-            actionCooldown = 0.18f;
-            if (engine->getSoundSystem()) engine->getSoundSystem()->playProduce();
-        }
+        produce.role = EntityRole::Soldier;
     } else if (engine->getInputSystem()->isKeyPressed(sf::Keyboard::Num3)) {
-        if (resourceSystem->spendResource(Faction::Player, "Gold", 220.0f)) {
-            spawnTank(spawnPoint, Faction::Player, false);
-            actionCooldown = 0.20f;
-            if (engine->getSoundSystem()) engine->getSoundSystem()->playProduce();
-        }
+        produce.role = EntityRole::Tank;
     } else if (engine->getInputSystem()->isKeyPressed(sf::Keyboard::Num4)) {
-        if (resourceSystem->spendResource(Faction::Player, "Gold", 140.0f)) {
-            spawnScout(spawnPoint, Faction::Player, false);
-            actionCooldown = 0.18f;
-            if (engine->getSoundSystem()) engine->getSoundSystem()->playProduce();
-        }
+        produce.role = EntityRole::Scout;
+    } else {
+        return;
     }
+
+    // The purchase itself is settled when the command lands; a key press the
+    // bank can't cover does nothing, as before, and starts no cooldown
+    if (engine->getResourceSystem()->getResource(Faction::Player, "Gold") < productionCost(produce.role)) {
+        return;
+    }
+
+    engine->submitCommand(produce);
+    actionCooldown = produce.role == EntityRole::Tank ? 0.20f : 0.18f;
 }
 
 void GameManager::handleBuildingPlacement() {
@@ -255,7 +305,7 @@ void GameManager::handleBuildingPlacement() {
         return;
     }
 
-    Vector2 placePos = engine->getInputSystem()->getMousePosition();
+    Vector2 placePos = engine->screenToWorld(engine->getInputSystem()->getMousePosition());
 
     auto isBlocked = [&]() {
         for (const auto& [id, entity] : engine->getRegistry()->getEntities()) {
@@ -269,7 +319,8 @@ void GameManager::handleBuildingPlacement() {
                 continue;
             }
 
-            if (transform->position.distance(placePos) < collider->radius + 48.0f) {
+            float clearance = collider->radius + 48.0f;
+            if (transform->position.distanceSquared(placePos) < clearance * clearance) {
                 return true;
             }
         }
@@ -282,17 +333,42 @@ void GameManager::handleBuildingPlacement() {
         return;
     }
 
+    PlayerCommand build;
+    build.kind = PlayerCommand::Kind::Build;
+    build.role = buildMode == BuildMode::Turret ? EntityRole::Turret : EntityRole::Base;
+    build.position = placePos;
+    engine->submitCommand(build);
+
+    buildMode = BuildMode::None;
+    actionCooldown = 0.18f;
+}
+
+void GameManager::applyCommand(const PlayerCommand& command) {
+    // Gold is only spent here, on the tick the command lands, so a replay
+    // spends it the same way
     auto resourceSystem = engine->getResourceSystem();
-    if (buildMode == BuildMode::Turret) {
-        if (resourceSystem->spendResource(Faction::Player, "Gold", 180.0f)) {
-            spawnTurret(placePos, Faction::Player, false);
+    if (command.kind == PlayerCommand::Kind::Produce) {
+        float cost = productionCost(command.role);
+        if (cost <= 0.0f || !resourceSystem->spendResource(Faction::Player, "Gold", cost)) {
+            return;
         }
-    } else if (buildMode == BuildMode::Base) {
-        if (resourceSystem->spendResource(Faction::Player, "Gold", 320.0f)) {
-            spawnBase(placePos, Faction::Player, false);
+
+        switch (command.role) {
+            case EntityRole::Worker:  spawnWorker(command.position, Faction::Player, playerAIControlled); break;
+            case EntityRole::Soldier: spawnSoldier(command.position, Faction::Player, playerAIControlled); break;
+            case EntityRole::Tank:    spawnTank(command.position, Faction::Player, playerAIControlled); break;
+            default:                  spawnScout(command.position, Faction::Player, playerAIControlled); break;
+        }
+        if (engine->getSoundSystem()) engine->getSoundSystem()->playProduce();
+    } else if (command.kind == PlayerCommand::Kind::Build) {
+        if (command.role == EntityRole::Turret) {
+            if (resourceSystem->spendResource(Faction::Player, "Gold", 180.0f)) {
+                spawnTurret(command.position, Faction::Player, playerAIControlled);
+            }
+        } else if (command.role == EntityRole::Base) {
+            if (resourceSystem->spendResource(Faction::Player, "Gold", 320.0f)) {
+                spawnBase(command.position, Faction::Player, playerAIControlled);
+            }
         }
     }
-
-    buildMode = BuildMode::None;
-    actionCooldown = 0.18f;
 }
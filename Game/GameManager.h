@@ -1,24 +1,32 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include "../Engine/Core/Engine.h"
 #include "../Engine/ECS/Entity.h"
 
 class GameManager {
 public:
     GameManager();
+    // A headless game puts both factions under AI control
+    explicit GameManager(const EngineConfig& config);
     ~GameManager();
     
     // Engine access
     std::shared_ptr<Engine> getEngine() { return engine; }
     
-    // Game initialization
+    // Game initialization. Both recording and playback need a deterministic
+    // engine; load a replay before initialize() so the level is set up the way
+    // the recorded session had it, record after it.
+    void playReplay(const Replay& replay);
+    bool startRecording(const std::string& path);
     void initialize();
     void shutdown();
     
     // Game loop
+    void pollEvents();
     void update(float deltaTime);
-    void render();
+    void render(float frameTime, float interpolation);
     bool isRunning();
     
     // Unit spawning
@@ -44,6 +52,7 @@ private:
     BuildMode buildMode = BuildMode::None;
     float actionCooldown = 0.0f;
     float enemyProductionTimer = 0.0f;
+    bool playerAIControlled = false;
     
     // Game state
     void setupLevel();
@@ -51,4 +60,6 @@ private:
     void handlePlayerActions(float deltaTime);
     void handleProduction();
     void handleBuildingPlacement();
+    void reinforce(Faction faction);
+    void applyCommand(const PlayerCommand& command);
 };
@@ -0,0 +1,218 @@
+// Headless AI-vs-AI match: the level from the game with both factions under AI
+// control, stepped at the game's fixed rate as fast as the machine allows, with
+// no window, audio or input. Stops after the given number of ticks or when one
+// side has no units or buildings left, then prints one line describing the
+// match so batches of runs can be collected and compared.
+//
+// The engine runs deterministic, so the final checksum identifies the match:
+// the same build gives the same checksum every run. --verify plays the match
+// a second time and reports the first tick whose checksum differs, if any.
+//
+// --replay plays a session recorded with AIStrategyGame --record instead: its
+// orders go in on the ticks they were given, at the recording's tick length
+// but as fast as the machine allows, and the world is checked against the
+// recording's checksums along the way. It runs for the whole recording unless
+// --ticks says otherwise.
+//
+//   AIStrategySim [--ticks N] [--format json|csv] [--verify] [--replay FILE]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "GameManager.h"
+
+namespace {
+// Same step as the windowed game, so a sim tick is a game tick
+const float SIMULATION_STEP = 1.0f / 30.0f;
+
+struct Options {
+    std::string format = "json";
+    long ticks = 9000;  // Five minutes of game time
+    bool ticksGiven = false;
+    bool verify = false;
+    std::string replayPath;
+};
+
+struct Side {
+    int units = 0;
+    int buildings = 0;
+    float gold = 0.0f;
+
+    bool alive() const { return units + buildings > 0; }
+};
+
+Side count(Engine& engine, Faction faction) {
+    Side side;
+    for (const auto& [id, entity] : engine.getRegistry()->getEntities()) {
+        if (!entity || !entity->isActive() || entity->isDestroyed()) {
+            continue;
+        }
+        auto team = entity->getComponent<TeamComponent>();
+        auto role = entity->getComponent<RoleComponent>();
+        if (!team || !role || team->faction != faction) {
+            continue;
+        }
+        switch (role->role) {
+            case EntityRole::Worker:
+            case EntityRole::Soldier:
+            case EntityRole::Tank:
+            case EntityRole::Scout:
+                ++side.units;
+                break;
+            case EntityRole::Base:
+            case EntityRole::Turret:
+                ++side.buildings;
+                break;
+            default:
+                break;
+        }
+    }
+    side.gold = engine.getResourceSystem()->getResource(faction, "Gold");
+    return side;
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--ticks" && hasValue) {
+            options.ticks = std::max(1L, std::atol(argv[++i]));
+            options.ticksGiven = true;
+        } else if (arg == "--format" && hasValue) {
+            options.format = argv[++i];
+        } else if (arg == "--verify") {
+            options.verify = true;
+        } else if (arg == "--replay" && hasValue) {
+            options.replayPath = argv[++i];
+        } else {
+            std::cerr << "usage: AIStrategySim [--ticks N] [--format json|csv] [--verify] [--replay FILE]" << std::endl;
+            return false;
+        }
+    }
+    return options.format == "json" || options.format == "csv";
+}
+
+struct Match {
+    long ticks = 0;
+    float step = SIMULATION_STEP;
+    double seconds = 0.0;
+    Side player, enemy;
+    std::vector<std::uint64_t> checksums;  // After each tick
+    long replayMismatch = 0;  // First checkpoint that disagreed with the recording
+};
+
+Match play(const Options& options, const Replay* replay) {
+    // A replay plays at the rate it was recorded; GameManager's timers count
+    // in the step it is given, so that has to match the engine's tick
+    Match match;
+    match.step = replay ? replay->getHeader().tickLength : SIMULATION_STEP;
+
+    EngineConfig config;
+    config.headless = true;
+    config.deterministic = true;
+    config.tickLength = match.step;
+    GameManager gameManager(config);
+    if (replay) {
+        gameManager.playReplay(*replay);
+    }
+    gameManager.initialize();
+    Engine& engine = *gameManager.getEngine();
+
+    match.checksums.reserve(static_cast<std::size_t>(options.ticks));
+    auto start = std::chrono::steady_clock::now();
+    while (match.ticks < options.ticks) {
+        gameManager.update(match.step);
+        match.checksums.push_back(engine.getChecksum());
+        ++match.ticks;
+
+        // Counting walks every entity, so only check for a result once a game
+        // second; a replay runs on to the end of the recording regardless
+        if (match.ticks % 30 == 0 || match.ticks == options.ticks) {
+            match.player = count(engine, Faction::Player);
+            match.enemy = count(engine, Faction::Enemy);
+            if (!replay && (!match.player.alive() || !match.enemy.alive())) {
+                break;
+            }
+        }
+    }
+    match.replayMismatch = static_cast<long>(engine.getPlaybackMismatchTick());
+    match.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return match;
+}
+
+// First tick (from 1) where the two matches differ, or 0 when they agree throughout
+long firstDivergence(const Match& a, const Match& b) {
+    std::size_t shared = std::min(a.checksums.size(), b.checksums.size());
+    for (std::size_t i = 0; i < shared; ++i) {
+        if (a.checksums[i] != b.checksums[i]) {
+            return static_cast<long>(i) + 1;
+        }
+    }
+    return a.checksums.size() == b.checksums.size() ? 0 : static_cast<long>(shared) + 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    Replay replay;
+    if (!options.replayPath.empty()) {
+        if (!replay.load(options.replayPath)) {
+            return 1;
+        }
+        if (!options.ticksGiven) {
+            options.ticks = std::max(1L, static_cast<long>(replay.getLength()));
+        }
+    }
+    const Replay* replaying = options.replayPath.empty() ? nullptr : &replay;
+
+    try {
+        Match match = play(options, replaying);
+        long divergence = options.verify ? firstDivergence(match, play(options, replaying)) : 0;
+        if (divergence == 0) {
+            divergence = match.replayMismatch;
+        }
+
+        const Side& player = match.player;
+        const Side& enemy = match.enemy;
+        const char* winner = "none";
+        if (player.alive() != enemy.alive()) {
+            winner = player.alive() ? "player" : "enemy";
+        }
+        double ticksPerSecond = match.ticks / std::max(match.seconds, 1e-9);
+        unsigned long long checksum = match.checksums.empty() ? 0 : match.checksums.back();
+        bool checked = options.verify || replaying;
+        long diverged = checked ? divergence : -1;  // -1 when not checked
+
+        if (options.format == "csv") {
+            std::printf("ticks,game_seconds,wall_seconds,ticks_per_second,player_units,player_buildings,player_gold,"
+                        "enemy_units,enemy_buildings,enemy_gold,winner,checksum,diverged_at\n");
+            std::printf("%ld,%.3f,%.6f,%.1f,%d,%d,%.1f,%d,%d,%.1f,%s,%016llx,%ld\n",
+                        match.ticks, match.ticks * match.step, match.seconds, ticksPerSecond,
+                        player.units, player.buildings, player.gold,
+                        enemy.units, enemy.buildings, enemy.gold, winner, checksum, diverged);
+        } else {
+            std::printf("{\"ticks\":%ld,\"game_seconds\":%.3f,\"wall_seconds\":%.6f,\"ticks_per_second\":%.1f,"
+                        "\"player\":{\"units\":%d,\"buildings\":%d,\"gold\":%.1f},"
+                        "\"enemy\":{\"units\":%d,\"buildings\":%d,\"gold\":%.1f},\"winner\":\"%s\","
+                        "\"checksum\":\"%016llx\",\"diverged_at\":%ld}\n",
+                        match.ticks, match.ticks * match.step, match.seconds, ticksPerSecond,
+                        player.units, player.buildings, player.gold,
+                        enemy.units, enemy.buildings, enemy.gold, winner, checksum, diverged);
+        }
+        return divergence == 0 ? 0 : 2;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -16,6 +16,11 @@ void Scout::setupComponents(Vector2 position) {
         combat->attackDamage = getAttackDamage();
         combat->attackRange = getAttackRange();
     }
+
+    auto movement = entity->getComponent<MovementComponent>();
+    if (movement) {
+        movement->movementClass = MovementClass::Light;
+    }
 }
 
 void Scout::setupAI() {
@@ -18,6 +18,10 @@ void Tank::setupComponents(Vector2 position) {
         combat->attackDamage = getAttackDamage();
         combat->attackRange = getAttackRange();
         combat->attackCooldown = 2.0f;
+        // Shells burst over a small area
+        combat->damageType = DamageType::Explosive;
+        combat->projectileSpeed = 300.0f;
+        combat->splashRadius = 40.0f;
     }
     
     // Tank size collider
@@ -25,6 +29,12 @@ void Tank::setupComponents(Vector2 position) {
     if (collider) {
         collider->radius = 24.0f;
     }
+
+    // Tanks need wide corridors and can't cross mud
+    auto movement = entity->getComponent<MovementComponent>();
+    if (movement) {
+        movement->movementClass = MovementClass::Heavy;
+    }
 }
 
 void Tank::setupAI() {
@@ -1,30 +1,66 @@
 #include <iostream>
 #include <chrono>
+#include <string>
 #include "GameManager.h"
 
-int main() {
+namespace {
+// The simulation always advances in steps of this length, however fast frames come
+const float SIMULATION_STEP = 1.0f / 30.0f;
+
+// Longest frame the simulation catches up on; beyond it the game slows down
+// instead of spending ever longer frames on ever more steps
+const float MAX_FRAME_TIME = 0.25f;
+}  // namespace
+
+// AIStrategyGame [--record FILE]
+//
+// --record runs the simulation deterministically and writes every order to
+// FILE, which AIStrategySim --replay plays back headless.
+int main(int argc, char** argv) {
+    std::string recordPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        } else {
+            std::cerr << "usage: AIStrategyGame [--record FILE]" << std::endl;
+            return 1;
+        }
+    }
+
     try {
         // Create game manager
-        GameManager gameManager;
+        EngineConfig config;
+        config.deterministic = !recordPath.empty();
+        config.tickLength = SIMULATION_STEP;
+        GameManager gameManager(config);
         gameManager.initialize();
+        if (!recordPath.empty() && !gameManager.startRecording(recordPath)) {
+            return 1;
+        }
         
         // Game loop
         auto lastTime = std::chrono::high_resolution_clock::now();
+        float accumulator = 0.0f;
         
         while (gameManager.isRunning()) {
-            // Calculate delta time
+            // Calculate frame time
             auto currentTime = std::chrono::high_resolution_clock::now();
-            float deltaTime = std::chrono::duration<float>(currentTime - lastTime).count();
+            float frameTime = std::chrono::duration<float>(currentTime - lastTime).count();
             lastTime = currentTime;
+            if (frameTime > MAX_FRAME_TIME) frameTime = MAX_FRAME_TIME;
+
+            gameManager.pollEvents();
             
-            // Cap delta time to prevent large jumps
-            if (deltaTime > 0.033f) deltaTime = 0.033f;
-            
-            // Update
-            gameManager.update(deltaTime);
+            // Update in fixed steps for the time that has passed
+            accumulator += frameTime;
+            while (accumulator >= SIMULATION_STEP) {
+                gameManager.update(SIMULATION_STEP);
+                accumulator -= SIMULATION_STEP;
+            }
             
-            // Render
-            gameManager.render();
+            // Render the leftover part of a step as interpolation
+            gameManager.render(frameTime, accumulator / SIMULATION_STEP);
         }
         
         gameManager.shutdown();